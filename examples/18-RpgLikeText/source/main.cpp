@@ -30,33 +30,38 @@ public:
 	
 	void startTextFading()
 	{
-		// Get the number of characters.
+		_elapsed = 0.0f;
+		
+		// Hide every character, the glyphs are drawn by the text
+		// itself so we change their opacity through it
+		const Uint32 len = _text->getString().length();
+		
+		for(Uint32 i = 0; i < len; ++i)
+		{
+			_text->setCharacterOpacity(i, 0);
+		}
+	}
+	
+	void update(float dt) override
+	{
+		_elapsed += dt;
+		
 		const Uint32 len = _text->getString().length();
 		
 		// For every character in the text
 		for(Uint32 i = 0; i < len; ++i)
 		{
-			// Using the getCharacter method we get the
-			// character sprite
-			auto characterSprite = _text->getCharacter(i);
-			
-			// Special characters don't have a sprite
-			if(characterSprite)
-			{
-				characterSprite->setOpacity(0);
-				
-				auto sequence = Sequence::create({
-					DelayTime::create(Time::seconds(0.3f * i)),
-					FadeIn::create(1.0f)
-				});
+			// Every character starts fading in 0.3 seconds after the
+			// previous one and takes 1 second to become opaque
+			float fade = util::clamp((_elapsed - 0.3f * i) / 1.0f, 0.0f, 1.0f);
 			
-				characterSprite->runAction(sequence);
-			}
+			_text->setCharacterOpacity(i, byte(fade * Color::OPAQUE));
 		}
 	}
 	
 private:
 	std::shared_ptr<Text> _text;
+	float _elapsed;
 };
 
 //=============================================================================
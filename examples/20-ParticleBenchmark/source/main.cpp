@@ -0,0 +1,151 @@
+// This is the unique header you have to include
+#include <Kairy/Kairy.h>
+
+USING_NS_KAIRY;
+
+//=============================================================================
+
+// How the emitter stored and updated its particles before using arrays
+struct AosParticle
+{
+	Color color;
+	float scale;
+	Vec2 position;
+	Vec2 velocity;
+	float rotation;
+	float rotationSpeed;
+	int textureIndex;
+	Time curLife;
+	Time life;
+};
+
+static void resetAos(AosParticle& particle)
+{
+	auto random = Random::getInstance();
+	auto randomSign = [random]() {
+		return random->nextFloat() * (random->nextBoolean() ? 1.0f : -1.0f);
+	};
+
+	particle = AosParticle();
+	particle.life = Time::seconds(1.0f + 0.5f * randomSign());
+	particle.position = Vec2(200, 120) + Vec2(10, 10) * randomSign();
+	particle.rotation = 0.0f + 180.0f * randomSign();
+	particle.rotationSpeed = 90.0f + 45.0f * randomSign();
+	particle.scale = 1.0f + 0.5f * randomSign();
+	particle.textureIndex = int(0 * randomSign());
+	particle.velocity = Vec2(0, -60) + Vec2(20, 20) * randomSign();
+}
+
+static void updateAos(std::vector<AosParticle>& particles, float dt)
+{
+	for (auto& particle : particles)
+	{
+		if (particle.curLife >= particle.life)
+		{
+			resetAos(particle);
+		}
+		else
+		{
+			float delta = particle.curLife.asSeconds() / particle.life.asSeconds();
+
+			particle.position += particle.velocity * dt;
+			particle.curLife = particle.curLife + Time::seconds(dt);
+			particle.rotation += particle.rotationSpeed * dt;
+			particle.color = Color::Yellow.mix(Color::Red, delta);
+		}
+	}
+}
+
+//=============================================================================
+
+int main(int argc, char* argv[])
+{
+	// Get device singleton instance.
+	auto device = RenderDevice::getInstance();
+	
+	device->init();
+	
+	device->setQuitOnStart(true);
+	
+	const int counts[] = { 10000, 25000, 50000, 100000 };
+	const int steps = 60;
+	const float dt = 1.0f / 60.0f;
+	
+	std::string results = "Particle update, ms per frame\n\n";
+	
+	for (int count : counts)
+	{
+		// The old array of structures
+		std::vector<AosParticle> particles(count);
+		
+		StopWatch watch;
+		watch.start();
+		
+		for (int i = 0; i < steps; ++i)
+		{
+			updateAos(particles, dt);
+		}
+		
+		float aos = watch.reset().asMicroseconds() / 1000.0f / steps;
+		
+		// The emitter, storing the particles as arrays
+		Emitter emitter;
+		emitter.setNumParticles(count);
+		emitter.setPosition(200, 120);
+		emitter.setPositionVar(10, 10);
+		emitter.setLifeTime(Time::seconds(1.0f));
+		emitter.setLifeTimeVar(Time::seconds(0.5f));
+		emitter.setSpeed(Vec2(0, -60));
+		emitter.setSpeedVar(20.0f);
+		emitter.setRotationVar(180.0f);
+		emitter.setRotationSpeed(90.0f);
+		emitter.setRotationSpeedVar(45.0f);
+		emitter.setScaleVar(0.5f);
+		emitter.setStartColor(Color::Yellow);
+		emitter.setEndColor(Color::Red);
+		
+		watch.start();
+		
+		for (int i = 0; i < steps; ++i)
+		{
+			emitter.update(dt);
+		}
+		
+		float soa = watch.reset().asMicroseconds() / 1000.0f / steps;
+		
+		std::string line = util::string_format("%6i: AoS %7.3f  SoA %7.3f  x%.1f\n",
+			count, aos, soa, soa > 0.0f ? aos / soa : 0.0f);
+		
+		std::cout << line;
+		results += line;
+	}
+	
+	Text text(14.0f);
+	text.setLineWidth(TOP_SCREEN_WIDTH - 20);
+	text.setPosition(10, 10);
+	text.setString(results);
+	
+	// Main loop
+	while(device->isRunning())
+	{
+		device->setTargetScreen(Screen::Top);
+		device->clear(Color::Black);
+		device->startFrame();
+		text.draw();
+		device->endFrame();
+		
+		device->setTargetScreen(Screen::Bottom);
+		device->clear(Color::Black);
+		device->startFrame();
+		device->endFrame();
+		
+		device->swapBuffers();
+	}
+	
+	// DON'T FORGET TO CALL THIS OR THE 3DS WILL CRASH AT EXIT
+	device->destroy();
+	
+	return 0;
+}
+
+//=============================================================================
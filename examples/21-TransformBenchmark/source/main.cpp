@@ -0,0 +1,121 @@
+// This is the unique header you have to include
+#include <Kairy/Kairy.h>
+
+USING_NS_KAIRY;
+
+//=============================================================================
+
+int main(int argc, char* argv[])
+{
+	// Get device singleton instance.
+	auto device = RenderDevice::getInstance();
+	
+	device->init();
+	
+	device->setQuitOnStart(true);
+	
+	const int count = 100000;
+	auto random = Random::getInstance();
+	
+	// Random transforms and points, the same for both classes
+	std::vector<Affine2D> affines(count);
+	std::vector<Transform> transforms(count);
+	std::vector<Vec2> points(count);
+	std::vector<Vec2> transformed(count);
+	
+	for (int i = 0; i < count; ++i)
+	{
+		affines[i] = Affine2D::createTranslation(random->nextFloat() * 400.0f, random->nextFloat() * 240.0f) *
+			Affine2D::createRotation(random->nextFloat() * 6.28f) *
+			Affine2D::createScale(0.5f + random->nextFloat());
+		transforms[i] = affines[i].toTransform();
+		points[i] = Vec2(random->nextFloat() * 64.0f, random->nextFloat() * 64.0f);
+	}
+	
+	StopWatch watch;
+	std::string results = "Transform benchmark, 100000 elements\n\n";
+	
+	// Matrix compose, like a parent transform applied to every child
+	float checksum = 0.0f;
+	
+	watch.start();
+	
+	Transform parent = transforms[0];
+	
+	for (int i = 0; i < count; ++i)
+	{
+		Transform combined = parent * transforms[i];
+		checksum += combined.getValue(3, 0);
+	}
+	
+	float transformCompose = watch.reset().asMicroseconds() / 1000.0f;
+	
+	watch.start();
+	
+	Affine2D affineParent = affines[0];
+	
+	for (int i = 0; i < count; ++i)
+	{
+		Affine2D combined = affineParent * affines[i];
+		checksum += combined.getValue(2, 0);
+	}
+	
+	float affineCompose = watch.reset().asMicroseconds() / 1000.0f;
+	
+	// Vertex transform, like the sprite batch corners
+	watch.start();
+	
+	for (int i = 0; i < count; ++i)
+	{
+		transformed[i] = parent.transformVec2(points[i]);
+	}
+	
+	float transformPoints = watch.reset().asMicroseconds() / 1000.0f;
+	checksum += transformed[count - 1].x;
+	
+	watch.start();
+	
+	affineParent.transformPoints(points.data(), transformed.data(), count);
+	
+	float affinePoints = watch.reset().asMicroseconds() / 1000.0f;
+	checksum += transformed[count - 1].x;
+	
+	results += util::string_format("Compose   Transform %7.3f ms  Affine2D %7.3f ms  x%.1f\n",
+		transformCompose, affineCompose,
+		affineCompose > 0.0f ? transformCompose / affineCompose : 0.0f);
+	results += util::string_format("Points    Transform %7.3f ms  Affine2D %7.3f ms  x%.1f\n",
+		transformPoints, affinePoints,
+		affinePoints > 0.0f ? transformPoints / affinePoints : 0.0f);
+	results += util::string_format("\n(checksum %f)\n", checksum);
+	
+	std::cout << results;
+	
+	Text text(14.0f);
+	text.setLineWidth(TOP_SCREEN_WIDTH - 20);
+	text.setPosition(10, 10);
+	text.setString(results);
+	
+	// Main loop
+	while(device->isRunning())
+	{
+		device->setTargetScreen(Screen::Top);
+		device->clear(Color::Black);
+		device->startFrame();
+		text.draw();
+		device->endFrame();
+		
+		device->setTargetScreen(Screen::Bottom);
+		device->clear(Color::Black);
+		device->startFrame();
+		device->endFrame();
+		
+		device->swapBuffers();
+	}
+	
+	// DON'T FORGET TO CALL THIS OR THE 3DS WILL CRASH AT EXIT
+	device->destroy();
+	
+	return 0;
+}
+
+//=============================================================================
@@ -0,0 +1,105 @@
+// This is the unique header you have to include
+#include <Kairy/Kairy.h>
+
+USING_NS_KAIRY;
+
+//=============================================================================
+
+int main(int argc, char* argv[])
+{
+	// Get device singleton instance.
+	auto device = RenderDevice::getInstance();
+	
+	device->init();
+	
+	device->setQuitOnStart(true);
+	
+	auto random = Random::getInstance();
+	auto atlas = std::make_shared<TextureAtlas>();
+	
+	// Many small images with transparent borders, as exported by an editor
+	const int count = 64;
+	
+	for (int i = 0; i < count; ++i)
+	{
+		int size = 12 + random->nextInt(0, 40);
+		Image image(size + 8, size + 8);
+		image.fillCircle(size / 2 + 4, size / 2 + 4, size / 2,
+			Color(random->nextInt(64, 255), random->nextInt(64, 255), random->nextInt(64, 255)));
+		
+		atlas->addImage(util::string_format("ball%d", i), image);
+	}
+	
+	atlas->setPadding(1);
+	atlas->setTrimEnabled(true);
+	
+	StopWatch watch;
+	watch.start();
+	
+	atlas->pack();
+	
+	float packTime = watch.reset().asMicroseconds() / 1000.0f;
+	
+	std::string results = util::string_format("Texture atlas, %d images\n\n", count);
+	results += util::string_format("Pages       %d (%dx%d)\n", atlas->getPagesCount(),
+		atlas->getPagesCount() > 0 ? atlas->getPage(0)->getWidth() : 0,
+		atlas->getPagesCount() > 0 ? atlas->getPage(0)->getHeight() : 0);
+	results += util::string_format("Efficiency  %.1f %%\n", atlas->getEfficiency() * 100.0f);
+	results += util::string_format("Memory      %u bytes\n", atlas->getMemoryUsage());
+	results += util::string_format("Saved       %d bytes\n", atlas->getMemorySaved());
+	results += util::string_format("Pack time   %.3f ms\n", packTime);
+	
+	std::cout << results;
+	
+	Text text(14.0f);
+	text.setLineWidth(TOP_SCREEN_WIDTH - 20);
+	text.setPosition(10, 10);
+	text.setString(results);
+	
+	// All the sprites share the page texture and batch in one draw call
+	std::vector<std::shared_ptr<AtlasSprite>> sprites;
+	
+	for (int i = 0; i < count; ++i)
+	{
+		auto sprite = AtlasSprite::create(atlas, util::string_format("ball%d", i));
+		
+		if (sprite)
+		{
+			sprite->setPosition((float)((i % 8) * 40), (float)((i / 8) * 30));
+			sprites.push_back(sprite);
+		}
+	}
+	
+	// Main loop
+	while(device->isRunning())
+	{
+		device->setTargetScreen(Screen::Top);
+		device->clear(Color::Black);
+		device->startFrame();
+		text.draw();
+		device->endFrame();
+		
+		device->setTargetScreen(Screen::Bottom);
+		device->clear(Color::Black);
+		device->startFrame();
+		
+		for (auto& sprite : sprites)
+		{
+			sprite->draw();
+		}
+		
+		device->endFrame();
+		
+		device->swapBuffers();
+	}
+	
+	sprites.clear();
+	atlas.reset();
+	
+	// DON'T FORGET TO CALL THIS OR THE 3DS WILL CRASH AT EXIT
+	device->destroy();
+	
+	return 0;
+}
+
+//=============================================================================
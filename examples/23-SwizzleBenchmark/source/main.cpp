@@ -0,0 +1,127 @@
+// This is the unique header you have to include
+#include <Kairy/Kairy.h>
+
+USING_NS_KAIRY;
+
+//=============================================================================
+
+// The per pixel conversion textures used before TextureSwizzle
+static inline Uint32 gpuTextureIndex(Uint32 x, Uint32 y, Uint32 w, Uint32 h)
+{
+	return (((y >> 3) * (w >> 3) + (x >> 3)) << 6) + ((x & 1) |
+		((y & 1) << 1) | ((x & 2) << 1) | ((y & 2) << 2) |
+		((x & 4) << 2) | ((y & 4) << 3));
+}
+
+static void tilePerPixel(const byte* pixels, byte* texels, int width, int height)
+{
+	for (int x = 0; x < width; ++x)
+	{
+		for (int y = 0; y < height; ++y)
+		{
+			Uint32 dst = gpuTextureIndex(x, y, width, height);
+			Uint32 src = x + y * width;
+
+			texels[dst * 4 + 3] = pixels[src * 4 + 0];
+			texels[dst * 4 + 2] = pixels[src * 4 + 1];
+			texels[dst * 4 + 1] = pixels[src * 4 + 2];
+			texels[dst * 4 + 0] = pixels[src * 4 + 3];
+		}
+	}
+}
+
+//=============================================================================
+
+int main(int argc, char* argv[])
+{
+	// Get device singleton instance.
+	auto device = RenderDevice::getInstance();
+	
+	device->init();
+	
+	device->setQuitOnStart(true);
+	
+	const int size = 512;
+	const int runs = 10;
+	auto random = Random::getInstance();
+	
+	std::vector<byte> pixels(size * size * 4);
+	std::vector<byte> reference(size * size * 4);
+	std::vector<Uint32> texels(size * size);
+	std::vector<byte> untiled(size * size * 4);
+	
+	for (auto& pixel : pixels)
+	{
+		pixel = (byte)random->nextInt(0, 255);
+	}
+	
+	StopWatch watch;
+	std::string results = "Swizzle benchmark, 512x512 RGBA8\n\n";
+	
+	watch.start();
+	
+	for (int i = 0; i < runs; ++i)
+	{
+		tilePerPixel(pixels.data(), reference.data(), size, size);
+	}
+	
+	float perPixel = watch.reset().asMicroseconds() / 1000.0f / runs;
+	
+	watch.start();
+	
+	for (int i = 0; i < runs; ++i)
+	{
+		TextureSwizzle::tile(pixels.data(), size, size, texels.data(), size, size);
+	}
+	
+	float blocks = watch.reset().asMicroseconds() / 1000.0f / runs;
+	
+	watch.start();
+	
+	for (int i = 0; i < runs; ++i)
+	{
+		TextureSwizzle::untile(texels.data(), size, size, untiled.data(), size, size);
+	}
+	
+	float untile = watch.reset().asMicroseconds() / 1000.0f / runs;
+	
+	bool matches = std::memcmp(reference.data(), texels.data(), reference.size()) == 0 &&
+		untiled == pixels;
+	
+	results += util::string_format("Tile per pixel  %7.3f ms\n", perPixel);
+	results += util::string_format("Tile blocks     %7.3f ms  x%.1f\n", blocks,
+		blocks > 0.0f ? perPixel / blocks : 0.0f);
+	results += util::string_format("Untile blocks   %7.3f ms\n", untile);
+	results += util::string_format("\nResults %s\n", matches ? "match" : "DIFFER");
+	
+	std::cout << results;
+	
+	Text text(14.0f);
+	text.setLineWidth(TOP_SCREEN_WIDTH - 20);
+	text.setPosition(10, 10);
+	text.setString(results);
+	
+	// Main loop
+	while(device->isRunning())
+	{
+		device->setTargetScreen(Screen::Top);
+		device->clear(Color::Black);
+		device->startFrame();
+		text.draw();
+		device->endFrame();
+		
+		device->setTargetScreen(Screen::Bottom);
+		device->clear(Color::Black);
+		device->startFrame();
+		device->endFrame();
+		
+		device->swapBuffers();
+	}
+	
+	// DON'T FORGET TO CALL THIS OR THE 3DS WILL CRASH AT EXIT
+	device->destroy();
+	
+	return 0;
+}
+
+//=============================================================================
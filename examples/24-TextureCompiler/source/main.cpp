@@ -0,0 +1,129 @@
+// This is the unique header you have to include
+#include <Kairy/Kairy.h>
+
+USING_NS_KAIRY;
+
+//=============================================================================
+
+// Builds a .ktex next to an image, laid out for the platform running this
+static bool compile(const std::string& filename, Texture::Format format, std::string& outFilename)
+{
+	int width = 0;
+	int height = 0;
+	byte* pixels = ImageLoader::LoadFromFile(filename, width, height, PixelFormat::RGBA8);
+
+	if (!pixels)
+	{
+		return false;
+	}
+
+#ifdef _3DS
+	bool tiled = true;
+#else
+	bool tiled = false;
+#endif // _3DS
+
+	outFilename = filename.substr(0, filename.find_last_of('.')) + ".ktex";
+
+	bool ret = TextureContainer::save(outFilename, pixels, width, height, format, tiled);
+	ImageLoader::FreeImage(pixels);
+
+	return ret;
+}
+
+//=============================================================================
+
+int main(int argc, char* argv[])
+{
+	// Get device singleton instance.
+	auto device = RenderDevice::getInstance();
+
+	device->init();
+
+	device->setQuitOnStart(true);
+
+	std::vector<std::string> files;
+
+	// Compile the images given on the command line, or a generated one
+	for (int i = 1; i < argc; ++i)
+	{
+		files.push_back(argv[i]);
+	}
+
+	if (files.empty())
+	{
+		const int size = 512;
+		std::vector<Color> pixels(size * size);
+
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				pixels[x + y * size] = Color((byte)x, (byte)y, (byte)(x ^ y));
+			}
+		}
+
+		Texture texture((const byte*)&pixels.front(), size, size);
+		texture.save("ktex_sample.png");
+		files.push_back("ktex_sample.png");
+	}
+
+	StopWatch watch;
+	std::string results = "Texture compiler\n\n";
+
+	for (auto& filename : files)
+	{
+		std::string ktexFilename;
+
+		if (!compile(filename, Texture::Format::RGBA8, ktexFilename))
+		{
+			results += util::string_format("%s  FAILED\n", filename.c_str());
+			continue;
+		}
+
+		Texture texture;
+
+		watch.start();
+		texture.load(filename);
+		float imageTime = watch.reset().asMicroseconds() / 1000.0f;
+		texture.unload();
+
+		watch.start();
+		texture.load(ktexFilename);
+		float ktexTime = watch.reset().asMicroseconds() / 1000.0f;
+
+		results += util::string_format("%s\n  image %7.3f ms  ktex %7.3f ms\n",
+			filename.c_str(), imageTime, ktexTime);
+	}
+
+	std::cout << results;
+
+	Text text(14.0f);
+	text.setLineWidth(TOP_SCREEN_WIDTH - 20);
+	text.setPosition(10, 10);
+	text.setString(results);
+
+	// Main loop
+	while(device->isRunning())
+	{
+		device->setTargetScreen(Screen::Top);
+		device->clear(Color::Black);
+		device->startFrame();
+		text.draw();
+		device->endFrame();
+
+		device->setTargetScreen(Screen::Bottom);
+		device->clear(Color::Black);
+		device->startFrame();
+		device->endFrame();
+
+		device->swapBuffers();
+	}
+
+	// DON'T FORGET TO CALL THIS OR THE 3DS WILL CRASH AT EXIT
+	device->destroy();
+
+	return 0;
+}
+
+//=============================================================================
@@ -0,0 +1,87 @@
+// This is the unique header you have to include
+#include <Kairy/Kairy.h>
+
+USING_NS_KAIRY;
+
+//=============================================================================
+
+int main(int argc, char* argv[])
+{
+	// Get device singleton instance.
+	auto device = RenderDevice::getInstance();
+
+	device->init();
+
+	device->setQuitOnStart(true);
+
+	auto loader = AssetLoader::getInstance();
+
+	// The assets are empty until their loads are over
+	auto texture = std::make_shared<Texture>();
+	auto map = std::make_shared<TmxMap>();
+
+	Sprite sprite;
+	TmxMapRenderer mapRenderer;
+
+	// Callbacks run on the main thread, so they can create GPU resources
+	loader->loadTexture(texture, "assets/Pikachu.png", [&](bool loaded)
+	{
+		if (loaded)
+		{
+			sprite.setTexture(*texture);
+			sprite.setPosition(BOTTOM_SCREEN_WIDTH / 2.0f, BOTTOM_SCREEN_HEIGHT / 2.0f);
+		}
+	});
+
+	auto mapRequest = loader->loadTmxMap(map, "assets/map.tmx", [&](bool loaded)
+	{
+		if (loaded)
+		{
+			mapRenderer.setMap(*map);
+		}
+	});
+
+	Text text(14.0f);
+	text.setPosition(10, 10);
+
+	// Main loop
+	while(device->isRunning())
+	{
+		// The loader runs its finishers from swapBuffers
+		text.setString(util::string_format("Loading %d%%",
+			(int)(loader->getProgress() * 100.0f)));
+
+		device->setTargetScreen(Screen::Top);
+		device->clear(Color::Cyan);
+		device->startFrame();
+
+		if (mapRequest->isLoaded())
+		{
+			mapRenderer.draw();
+		}
+		else
+		{
+			text.draw();
+		}
+
+		device->endFrame();
+
+		device->setTargetScreen(Screen::Bottom);
+		device->clear(Color::Black);
+		device->startFrame();
+		sprite.draw();
+		device->endFrame();
+
+		device->swapBuffers();
+	}
+
+	// Don't leave a worker writing into the assets
+	loader->waitAll();
+
+	// DON'T FORGET TO CALL THIS OR THE 3DS WILL CRASH AT EXIT
+	device->destroy();
+
+	return 0;
+}
+
+//=============================================================================
@@ -0,0 +1,179 @@
+// This is the unique header you have to include
+#include <Kairy/Kairy.h>
+
+USING_NS_KAIRY;
+
+//=============================================================================
+
+// The per pixel kernels Image used before ImageOps
+static void scalePerPixel(const std::vector<Color>& pixels, int width, int height,
+	std::vector<Color>& outPixels, int newWidth, int newHeight)
+{
+	float xRatio = (float)(width - 1) / newWidth;
+	float yRatio = (float)(height - 1) / newHeight;
+
+	for (int i = 0; i < newWidth; ++i)
+	{
+		for (int j = 0; j < newHeight; ++j)
+		{
+			int x = (int)(xRatio * i);
+			int y = (int)(yRatio * j);
+
+			float w = (xRatio * i) - x;
+			float h = (yRatio * j) - y;
+
+			const Color& a = pixels[x + y * width];
+			const Color& b = pixels[x + 1 + y * width];
+			const Color& c = pixels[x + (y + 1) * width];
+			const Color& d = pixels[x + 1 + (y + 1) * width];
+
+			outPixels[i + j * newWidth] = Color(
+				(byte)(a.r * (1 - w) * (1 - h) + b.r * w * (1 - h) + c.r * h * (1 - w) + d.r * w * h),
+				(byte)(a.g * (1 - w) * (1 - h) + b.g * w * (1 - h) + c.g * h * (1 - w) + d.g * w * h),
+				(byte)(a.b * (1 - w) * (1 - h) + b.b * w * (1 - h) + c.b * h * (1 - w) + d.b * w * h));
+		}
+	}
+}
+
+static void flipPerPixel(std::vector<Color>& pixels, int width, int height)
+{
+	for (int x = 0; x < width; ++x)
+	{
+		for (int y = 0; y < height / 2; ++y)
+		{
+			std::swap(pixels[x + y * width], pixels[x + (height - y - 1) * width]);
+		}
+	}
+}
+
+static void invertPerPixel(std::vector<Color>& pixels)
+{
+	for (auto& pixel : pixels)
+	{
+		pixel = Color(255 - pixel.r, 255 - pixel.g, 255 - pixel.b, pixel.a);
+	}
+}
+
+static void blendPerPixel(const std::vector<Color>& pixels, std::vector<Color>& outPixels)
+{
+	for (size_t i = 0; i < pixels.size(); ++i)
+	{
+		outPixels[i] = pixels[i].blend(outPixels[i]);
+	}
+}
+
+//=============================================================================
+
+int main(int argc, char* argv[])
+{
+	// Get device singleton instance.
+	auto device = RenderDevice::getInstance();
+
+	device->init();
+
+	device->setQuitOnStart(true);
+
+	const int size = 512;
+	const int scaled = 400;
+	const int runs = 5;
+	auto random = Random::getInstance();
+
+	std::vector<Color> pixels(size * size);
+	std::vector<Color> work(size * size);
+	std::vector<Color> out(scaled * scaled);
+
+	for (auto& pixel : pixels)
+	{
+		pixel = Color((byte)random->nextInt(0, 255), (byte)random->nextInt(0, 255),
+			(byte)random->nextInt(0, 255), (byte)random->nextInt(0, 255));
+	}
+
+	StopWatch watch;
+
+	auto measure = [&](const std::function<void()>& func)
+	{
+		work = pixels;
+		watch.start();
+
+		for (int i = 0; i < runs; ++i)
+		{
+			func();
+		}
+
+		return watch.reset().asMicroseconds() / 1000.0f / runs;
+	};
+
+	std::string results = "Image benchmark, 512x512 RGBA8\n\n";
+	results += "              per pixel  ImageOps\n";
+
+	auto report = [&](const char* name, float before, float after)
+	{
+		results += util::string_format("%-12s  %7.3f ms %7.3f ms  x%.1f\n", name, before,
+			after, after > 0.0f ? before / after : 0.0f);
+	};
+
+	std::vector<int> threadsCounts = { 1 };
+
+#ifndef _3DS
+	// The 3DS application core runs the bands alone anyway
+	if (std::thread::hardware_concurrency() > 1)
+	{
+		threadsCounts.push_back((int)std::thread::hardware_concurrency());
+	}
+#endif // _3DS
+
+	for (int threads : threadsCounts)
+	{
+		ImageOps::setThreadsCount(threads);
+		results += util::string_format("%d thread(s)\n", threads);
+
+		report("Bilinear",
+			measure([&] { scalePerPixel(work, size, size, out, scaled, scaled); }),
+			measure([&] { ImageOps::scaleBilinear(work.data(), size, size, out.data(), scaled, scaled); }));
+
+		report("Flip",
+			measure([&] { flipPerPixel(work, size, size); }),
+			measure([&] { ImageOps::flipRows(work.data(), size, size); }));
+
+		report("Invert",
+			measure([&] { invertPerPixel(work); }),
+			measure([&] { ImageOps::invertColors(work.data(), work.size()); }));
+
+		report("Blend",
+			measure([&] { blendPerPixel(pixels, work); }),
+			measure([&] { ImageOps::blend(pixels.data(), size, work.data(), size, size, size); }));
+	}
+
+	ImageOps::setThreadsCount(1);
+
+	std::cout << results;
+
+	Text text(14.0f);
+	text.setLineWidth(TOP_SCREEN_WIDTH - 20);
+	text.setPosition(10, 10);
+	text.setString(results);
+
+	// Main loop
+	while(device->isRunning())
+	{
+		device->setTargetScreen(Screen::Top);
+		device->clear(Color::Black);
+		device->startFrame();
+		text.draw();
+		device->endFrame();
+
+		device->setTargetScreen(Screen::Bottom);
+		device->clear(Color::Black);
+		device->startFrame();
+		device->endFrame();
+
+		device->swapBuffers();
+	}
+
+	// DON'T FORGET TO CALL THIS OR THE 3DS WILL CRASH AT EXIT
+	device->destroy();
+
+	return 0;
+}
+
+//=============================================================================
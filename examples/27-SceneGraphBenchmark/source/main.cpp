@@ -0,0 +1,172 @@
+// This is the unique header you have to include
+#include <Kairy/Kairy.h>
+
+USING_NS_KAIRY;
+
+//=============================================================================
+
+static std::vector<std::shared_ptr<Node>> makeNodes(int count)
+{
+	std::vector<std::shared_ptr<Node>> nodes;
+	nodes.reserve(count);
+
+	for (int i = 0; i < count; ++i)
+	{
+		nodes.push_back(std::make_shared<Node>());
+		nodes.back()->setTag(i % 2);
+	}
+
+	return nodes;
+}
+
+//=============================================================================
+
+int main(int argc, char* argv[])
+{
+	// Get device singleton instance.
+	auto device = RenderDevice::getInstance();
+
+	device->init();
+
+	device->setQuitOnStart(true);
+
+	// The previous addChild() sorted every child at every insertion,
+	// it is timed on fewer nodes or it would take minutes on a 3DS
+	const int count = 10000;
+	const int sortedCount = 1000;
+	auto random = Random::getInstance();
+
+	StopWatch watch;
+
+	auto measure = [&](const std::function<void()>& func)
+	{
+		watch.start();
+		func();
+		return watch.reset().asMicroseconds() / 1000.0f;
+	};
+
+	std::string results = util::string_format("Scene graph benchmark, %d nodes\n\n", count);
+
+	auto report = [&](const char* name, float time)
+	{
+		results += util::string_format("%-26s %9.3f ms\n", name, time);
+	};
+
+	auto nodes = makeNodes(count);
+
+	{
+		std::vector<std::shared_ptr<Node>> children;
+
+		report(util::string_format("push and sort, %d", sortedCount).c_str(), measure([&]
+		{
+			for (int i = 0; i < sortedCount; ++i)
+			{
+				children.push_back(nodes[i]);
+				children.back()->setZOrder(random->nextInt(0, 1000));
+
+				std::sort(children.begin(), children.end(),
+					[](const std::shared_ptr<Node>& a, const std::shared_ptr<Node>& b)
+				{
+					return a->getZOrder() < b->getZOrder();
+				});
+			}
+		}));
+	}
+
+	{
+		Node root;
+
+		report("addChild", measure([&]
+		{
+			for (auto& node : nodes)
+			{
+				root.addChild(node);
+			}
+		}));
+
+		report("clearChildren", measure([&] { root.clearChildren(); }));
+	}
+
+	{
+		Node root;
+
+		report("addChild, random z", measure([&]
+		{
+			for (auto& node : nodes)
+			{
+				root.addChild(node, random->nextInt(0, 1000));
+			}
+		}));
+
+		report("setZOrder all, sort", measure([&]
+		{
+			for (auto& node : nodes)
+			{
+				node->setZOrder(random->nextInt(0, 1000));
+			}
+
+			root.sortChildren();
+		}));
+
+		report("getChildByTag", measure([&]
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				root.getChildByTag(i % 2);
+			}
+		}));
+
+		report("removeChildByTag, half", measure([&] { root.removeChildByTag(0); }));
+
+		report("removeChildrenIf, rest", measure([&]
+		{
+			root.removeChildrenIf([](Node* node) { return true; });
+		}));
+	}
+
+	{
+		Node root;
+
+		report("addChildren", measure([&] { root.addChildren(nodes); }));
+		report("removeFromParent, 1000", measure([&]
+		{
+			for (int i = 0; i < 1000; ++i)
+			{
+				nodes[count - 1 - i]->removeFromParent();
+			}
+		}));
+	}
+
+	report("destroy", measure([&] { nodes.clear(); }));
+
+	std::cout << results;
+
+	Text text(14.0f);
+	text.setLineWidth(TOP_SCREEN_WIDTH - 20);
+	text.setPosition(10, 10);
+	text.setString(results);
+
+	// Main loop
+	while(device->isRunning())
+	{
+		device->setTargetScreen(Screen::Top);
+		device->clear(Color::Black);
+		device->startFrame();
+		text.draw();
+		device->endFrame();
+
+		device->setTargetScreen(Screen::Bottom);
+		device->clear(Color::Black);
+		device->startFrame();
+		device->endFrame();
+
+		device->swapBuffers();
+	}
+
+	// DON'T FORGET TO CALL THIS OR THE 3DS WILL CRASH AT EXIT
+	device->destroy();
+
+	return 0;
+}
+
+//=============================================================================
@@ -113,6 +113,14 @@ enum class PixelFormat
 	RGBA8
 };
 
+enum class BlendMode
+{
+	Alpha,
+	Additive,
+	Multiply,
+	None
+};
+
 enum class TouchType
 {
 	Down,
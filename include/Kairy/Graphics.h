@@ -30,9 +30,19 @@
 #include "Graphics/RenderDevice.h"
 #include "Graphics/ImageLoader.h"
 #include "Graphics/Texture.h"
+#include "Graphics/TextureSwizzle.h"
+#include "Graphics/TextureConverter.h"
+#include "Graphics/TextureContainer.h"
+#include "Graphics/TextureResidency.h"
 #include "Graphics/RenderTexture.h"
 #include "Graphics/Image.h"
+#include "Graphics/ImageOps.h"
 #include "Graphics/Sprite.h"
+#include "Graphics/TextureAtlas.h"
+#include "Graphics/AtlasSprite.h"
+#include "Graphics/SpriteBatch.h"
+#include "Graphics/RenderQueue.h"
+#include "Graphics/RenderState.h"
 #include "Graphics/Font.h"
 #include "Graphics/Text.h"
 #include "Graphics/Animation.h"
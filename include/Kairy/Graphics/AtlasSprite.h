@@ -0,0 +1,89 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef KAIRY_GRAPHICS_ATLAS_SPRITE_H_INCLUDED
+#define KAIRY_GRAPHICS_ATLAS_SPRITE_H_INCLUDED
+
+#include "Sprite.h"
+#include "TextureAtlas.h"
+
+NS_KAIRY_BEGIN
+
+/**
+ * @class AtlasSprite
+ * @brief A sprite showing a named frame of a TextureAtlas.
+ *
+ * The size of the sprite is the untrimmed size of the frame, the
+ * trimmed pixels are drawn at their original offset. Calling
+ * setTextureRect directly (e.g. from Animate) drops the trim offset,
+ * so animated frames should be packed untrimmed.
+ */
+class AtlasSprite : public Sprite
+{
+public:
+	static std::shared_ptr<AtlasSprite>
+		create(void);
+
+	static std::shared_ptr<AtlasSprite>
+		create(const std::shared_ptr<TextureAtlas>& atlas, const std::string& frame);
+
+	AtlasSprite(void);
+
+	AtlasSprite(const std::shared_ptr<TextureAtlas>& atlas, const std::string& frame);
+
+	virtual ~AtlasSprite();
+
+	/**
+	 * @brief Set the atlas holding the frames, the current frame
+	 * is loaded again from it when it has a frame with that name.
+	 */
+	void setAtlas(const std::shared_ptr<TextureAtlas>& atlas);
+
+	inline const std::shared_ptr<TextureAtlas>& getAtlas() const { return _atlas; }
+
+	/**
+	 * @brief Show a frame of the atlas.
+	 * @param name The name of the frame.
+	 * @return false if the atlas has no such frame.
+	 */
+	bool setFrame(const std::string& name);
+
+	inline const std::string& getFrameName() const { return _frameName; }
+
+	/**
+	 * Draws the sprite.
+	 */
+	virtual void draw() override;
+
+protected:
+	std::shared_ptr<TextureAtlas> _atlas; ///< The atlas holding the frames
+	std::string _frameName;               ///< The current frame
+	int _framePage;                       ///< The page bound to the texture
+	Rect _frameRect;                      ///< The trimmed pixels in the page
+	Vec2 _frameOffset;                    ///< Offset of the trimmed pixels
+	Vec2 _frameSourceSize;                ///< Size of the untrimmed frame
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_ATLAS_SPRITE_H_INCLUDED
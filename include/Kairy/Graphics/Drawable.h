@@ -56,10 +56,25 @@ public:
 	
 	inline virtual void hide();
 
+	inline void setBlendMode(BlendMode blendMode);
+
+	inline BlendMode getBlendMode() const;
+
+	inline void setLayer(int layer);
+
+	inline int getLayer() const;
+
+	inline void setGlobalZOrder(int globalZOrder);
+
+	inline int getGlobalZOrder() const;
+
 protected:
 	RenderDevice* _device;
 	Color _color;
 	bool _visible;
+	BlendMode _blendMode;
+	int _layer;
+	int _globalZOrder;
 };
 
 #include "Drawable.inl"
@@ -89,3 +89,45 @@ inline void Drawable::hide()
 }
 
 //=============================================================================
+
+inline void Drawable::setBlendMode(BlendMode blendMode)
+{
+	_blendMode = blendMode;
+}
+
+//=============================================================================
+
+inline BlendMode Drawable::getBlendMode() const
+{
+	return _blendMode;
+}
+
+//=============================================================================
+
+inline void Drawable::setLayer(int layer)
+{
+	_layer = layer;
+}
+
+//=============================================================================
+
+inline int Drawable::getLayer() const
+{
+	return _layer;
+}
+
+//=============================================================================
+
+inline void Drawable::setGlobalZOrder(int globalZOrder)
+{
+	_globalZOrder = globalZOrder;
+}
+
+//=============================================================================
+
+inline int Drawable::getGlobalZOrder() const
+{
+	return _globalZOrder;
+}
+
+//=============================================================================
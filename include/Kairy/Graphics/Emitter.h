@@ -28,7 +28,7 @@
 #include <Kairy/Updatable.h>
 #include "Sprite.h"
 #include "Particle.h"
-#include "CircleShape.h"
+#include "SpriteBatch.h"
 
 NS_KAIRY_BEGIN
 
@@ -151,6 +151,11 @@ public:
 	void addTexture(const byte* pixels, int width, int height,
 		Texture::Location location = Texture::Location::Default);
 
+	/**
+	 * @brief Get the number of quads written for the last draw.
+	 */
+	inline Uint32 getDrawnParticles() const { return _drawnParticles; }
+
 	inline void clearTextures();
 
 	void update(float dt) override;
@@ -158,11 +163,41 @@ public:
 	void draw() override;
 
 private:
-	void resetParticle(Particle& particle);
-	void drawParticle(const Particle& particle);
-	void updateParticle(Particle& particle, float dt);
-
-	std::vector<Particle> _particles;
+	/**
+	 * @brief The particles stored as a structure of arrays, so that
+	 * they can be updated several at a time.
+	 */
+	struct ParticleArrays
+	{
+		ParticleArrays(void) : count(0) {}
+
+		void resize(Uint32 newCount);
+
+		Uint32 count;
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> velocityX;
+		std::vector<float> velocityY;
+		std::vector<float> life;
+		std::vector<float> currentLife;
+		std::vector<float> rotation;
+		std::vector<float> rotationSpeed;
+		std::vector<float> scale;
+		std::vector<float> colorR;
+		std::vector<float> colorG;
+		std::vector<float> colorB;
+		std::vector<float> colorA;
+		std::vector<int> textureIndex;
+	};
+
+	void integrateParticles(float dt);
+	void respawnParticles();
+	bool createCircleTexture();
+	Uint32 buildQuads(int textureIndex, const Rect& textureRect);
+
+	ParticleArrays _particles;
+	std::vector<Uint32> _respawned;             ///< The particles to respawn
+	std::vector<float> _randoms;                ///< Random values for the respawns
 	float _duration;
 	Vec2 _position;
 	Vec2 _positionVar;
@@ -186,7 +221,9 @@ private:
 	int _textureIndex;
 	int _textureIndexVar;
 	std::vector<std::unique_ptr<Sprite>> _textures;
-	CircleShape _circleShape;
+	Texture _circleTexture;                     ///< Drawn when there are no textures
+	std::vector<SpriteBatch::Vertex> _vertices; ///< The quads of the particles
+	Uint32 _drawnParticles;
 };
 
 #include "Emitter.inl"
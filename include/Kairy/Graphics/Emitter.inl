@@ -26,14 +26,14 @@
 
 inline void Emitter::setNumParticles(int particles)
 {
-	_particles.resize(particles);
+	_particles.resize(particles < 0 ? 0 : Uint32(particles));
 }
 
 //=============================================================================
 
 inline int Emitter::getNumParticles() const
 {
-	return (int)_particles.size();
+	return (int)_particles.count;
 }
 
 //=============================================================================
@@ -29,6 +29,8 @@
 
 NS_KAIRY_BEGIN
 
+class Image;
+
 class Font
 {
 public:
@@ -69,8 +71,29 @@ public:
 	
 	inline int getLineHeight() const { return _lineHeight; }
 
+	/**
+	 * @brief Rasterize a TTF font into page images.
+	 * It doesn't create nor release any texture, so it can run off the
+	 * main thread. Unload the font on the main thread first.
+	 * @param buffer The TTF file buffer.
+	 * @param size The font size.
+	 * @param outPages The page images, to pass to loadPages().
+	 * @return false if an error occurred.
+	 */
+	bool bakeTtf(const byte* buffer, float size, std::vector<Image>& outPages);
+
+	/**
+	 * @brief Create the page textures of a baked font.
+	 * @param pages The page images returned by bakeTtf().
+	 * @param location Where the textures will be allocated.
+	 */
+	void loadPages(const std::vector<Image>& pages,
+		Texture::Location location = Texture::Location::Default);
+
 public:
 	bool loadStb(void* stb, float size, Texture::Location location);
+
+	bool bakeStb(void* stb, float size, std::vector<Image>& outPages);
 	
 	
     friend class Text;
@@ -0,0 +1,114 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef KAIRY_GRAPHICS_IMAGE_OPS_H_INCLUDED
+#define KAIRY_GRAPHICS_IMAGE_OPS_H_INCLUDED
+
+#include "Color.h"
+
+NS_KAIRY_BEGIN
+
+/**
+ * @class ImageOps
+ * @brief Processing kernels on buffers of RGBA8 pixels, used by Image.
+ *
+ * The kernels walk the pixels row by row, resolve the source coordinates
+ * once per row or column instead of once per pixel, and blend with SSE2 or
+ * NEON where available (integer scalar code elsewhere, like on the 3DS).
+ * With more than one thread, the destination rows are split in bands
+ * processed in parallel. They don't touch the GPU, so they can be tested
+ * and timed on any host.
+ */
+class ImageOps
+{
+public:
+	/**
+	 * @brief Set how many threads process the bands of rows.
+	 * The calling thread is one of them, 1 disables the threading.
+	 * The 3DS runs the threads of the application one at a time,
+	 * keep 1 there.
+	 */
+	static void setThreadsCount(int count);
+
+	inline static int getThreadsCount() { return s_threadsCount; }
+
+	/**
+	 * @brief Scale the pixels, picking the closest one.
+	 * @param outPixels The scaled pixels, newWidth * newHeight of them.
+	 */
+	static void scaleNearest(const Color* pixels, int width, int height,
+		Color* outPixels, int newWidth, int newHeight);
+
+	/**
+	 * @brief Scale the pixels, interpolating the 4 closest ones.
+	 * The alpha channel is interpolated like the colors.
+	 * @param outPixels The scaled pixels, newWidth * newHeight of them.
+	 */
+	static void scaleBilinear(const Color* pixels, int width, int height,
+		Color* outPixels, int newWidth, int newHeight);
+
+	/**
+	 * @brief Swap the top and bottom rows.
+	 */
+	static void flipRows(Color* pixels, int width, int height);
+
+	/**
+	 * @brief Swap the left and right columns.
+	 */
+	static void flipColumns(Color* pixels, int width, int height);
+
+	/**
+	 * @brief Rotate the pixels, the destination pixels are mapped back to
+	 * the source ones. The pixels outside the source are transparent.
+	 * @param cosine The cosine of the angle.
+	 * @param sine The sine of the angle.
+	 * @param originX The source x of the destination origin, rotated.
+	 * @param originY The source y of the destination origin, rotated.
+	 * @param outPixels The rotated pixels, newWidth * newHeight of them.
+	 */
+	static void rotate(const Color* pixels, int width, int height,
+		float cosine, float sine, float originX, float originY,
+		Color* outPixels, int newWidth, int newHeight);
+
+	/**
+	 * @brief Invert the colors, the alpha is kept.
+	 */
+	static void invertColors(Color* pixels, Uint32 count);
+
+	/**
+	 * @brief Blend pixels over other ones, like Color::blend().
+	 * @param pixels The pixels to draw.
+	 * @param pitch The pixels between two rows of the pixels to draw.
+	 * @param outPixels The pixels drawn over.
+	 * @param outPitch The pixels between two rows of the pixels drawn over.
+	 */
+	static void blend(const Color* pixels, int pitch, Color* outPixels, int outPitch,
+		int width, int height);
+
+private:
+	static int s_threadsCount;
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_IMAGE_OPS_H_INCLUDED
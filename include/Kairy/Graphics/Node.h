@@ -25,15 +25,26 @@
 #ifndef KAIRY_GRAPHICS_NODE_H_INCLUDED
 #define KAIRY_GRAPHICS_NODE_H_INCLUDED
 
-#include <Kairy/Math/Transform.h>
+#include <Kairy/Math/Affine2D.h>
 #include <Kairy/Util/Radians.h>
 #include <Kairy/Actions/Action.h>
 #include "Drawable.h"
+#include <unordered_map>
 
 NS_KAIRY_BEGIN
 
 class Scene;
 
+/**
+ * @brief The nodes visited by the culling passes of a frame.
+ */
+struct CullingStats
+{
+	Uint32 drawn;          ///< The nodes drawn
+	Uint32 culled;         ///< The nodes outside the view, their children were still visited
+	Uint32 culledSubtrees; ///< The subtrees skipped through their bounds
+};
+
 class Node : public Updatable, public Drawable
 {
 public:
@@ -68,13 +79,18 @@ public:
 
 	inline Rect getBoundingBox() const;
 
-	inline Transform getParentTransform() const;
+	inline Affine2D getParentTransform() const;
 
-	inline Transform getTransform() const;
+	inline Affine2D getTransform() const;
 
-	inline Transform getCombinedTransform() const;
+	/**
+	 * @brief Get the transform from node space to world space.
+	 * It is cached and computed again only after this node
+	 * or one of its parents changed.
+	 */
+	inline const Affine2D& getCombinedTransform() const;
 
-	inline void setTransform(const Transform& transform);
+	inline void setTransform(const Affine2D& transform);
 
 	inline virtual void setScaleX(float scaleX);
 
@@ -144,6 +160,9 @@ public:
 
 	inline int getTag() const;
 
+	/**
+	 * @brief Set the tag of the node, the untagged nodes have the tag -1.
+	 */
 	inline void setTag(int tag);
 
 	inline void* getUserdata() const;
@@ -169,10 +188,24 @@ public:
 	virtual void addChild(const std::shared_ptr<Node>& child, int zOrder,
 		const std::string& name);
 
+	/**
+	 * @brief Add several children at once, in the order of the list
+	 * and after the current children, like calling addChild() on each.
+	 */
+	virtual void addChildren(const std::vector<std::shared_ptr<Node>>& children);
+
 	inline std::vector<std::shared_ptr<Node>>& getChildren();
 
+	/**
+	 * @brief Get a child by name through a hash table, among
+	 * namesakes the first one in drawing order is returned.
+	 */
 	virtual Node* getChildByName(const std::string& name) const;
 
+	/**
+	 * @brief Get a child by tag through a hash table, among
+	 * children sharing the tag the first one in drawing order is returned.
+	 */
 	virtual Node* getChildByTag(int tag) const;
 
 	inline Uint32 getChildrenCount() const;
@@ -185,10 +218,68 @@ public:
 
 	virtual void removeChild(Node* child);
 
+	/**
+	 * @brief Remove the children matching a predicate in a single pass.
+	 * The predicate must not add or remove children.
+	 */
+	virtual void removeChildrenIf(const std::function<bool(Node*)>& predicate);
+
+	/**
+	 * @brief Sort the children if a z-order changed since the last sort.
+	 * The children with the same z-order keep their adding order.
+	 */
+	virtual void sortChildren();
+
 	void removeFromParent();
 
 	virtual void draw(void) override;
 
+	/**
+	 * @brief Draw the node unless it is outside the culling rect.
+	 * A culled node still visits its children, unless its subtree
+	 * bounds are outside too.
+	 */
+	void visit();
+
+	/**
+	 * @brief Set if the node can be skipped when its bounding box
+	 * is outside the culling rect. Enabled by default, only the nodes
+	 * drawing inside their bounding box are culled.
+	 */
+	inline void setCullingEnabled(bool enabled) { _cullingEnabled = enabled; }
+
+	inline bool isCullingEnabled() const { return _cullingEnabled; }
+
+	/**
+	 * @brief Set a rect in node space holding the node and all its
+	 * descendants, the whole subtree is skipped when it is outside
+	 * the culling rect.
+	 */
+	void setSubtreeBounds(const Rect& bounds);
+
+	void clearSubtreeBounds();
+
+	inline bool hasSubtreeBounds() const { return _hasSubtreeBounds; }
+
+	inline const Rect& getSubtreeBounds() const { return _subtreeBounds; }
+
+	/**
+	 * @brief Start culling the visited nodes against a rect in world space.
+	 */
+	static void beginCulling(const Rect& view);
+
+	/**
+	 * @brief Stop culling, the visited nodes are all drawn.
+	 */
+	static void endCulling();
+
+	/**
+	 * @brief Get the nodes visited since the last resetCullingStats().
+	 */
+	inline static const CullingStats& getCullingStats() { return s_cullingStats; }
+
+	static void resetCullingStats();
+
 	virtual void update(float dt) override;
 
 	inline bool isTouchEnabled() const { return _touchEnabled; }
@@ -221,11 +312,71 @@ public:
 
 protected:
 	friend class Scene;
+	friend class SpatialIndex;
 
 	void sortByZOrder();
 
-	Transform _transform;
+	/**
+	 * @brief Set the parent of a child and insert it in a list
+	 * after the children with a lower or equal z-order.
+	 */
+	void attachChild(std::vector<std::shared_ptr<Node>>& children,
+		const std::shared_ptr<Node>& child);
+
+	/**
+	 * @brief Append children to a list with increasing z-orders
+	 * from a counter, then merge them into place.
+	 */
+	void attachChildren(std::vector<std::shared_ptr<Node>>& children,
+		const std::vector<std::shared_ptr<Node>>& added, int& addCounter);
+
+	/**
+	 * @brief Remove the children matching a predicate from a list,
+	 * moving the others down in order. The tables are left to
+	 * reindexChildren().
+	 */
+	void compactChildren(std::vector<std::shared_ptr<Node>>& children,
+		const std::function<bool(Node*)>& predicate);
+
+	/**
+	 * @brief Add a child to the name and tag tables, the unnamed
+	 * and untagged children are left out.
+	 */
+	void indexChild(Node* child);
+
+	void unindexChild(Node* child);
+
+	/**
+	 * @brief Build the name and tag tables again, faster than
+	 * unindexing many children sharing a name or a tag.
+	 */
+	virtual void reindexChildren();
+
+	/**
+	 * @brief Compose the local transform in closed form, scaling,
+	 * rotating and flipping around the given pivot in pixels.
+	 */
+	Affine2D composeTransform(const Vec2& pivot) const;
+
+	/**
+	 * @brief Mark the local and the world transforms as changed.
+	 */
+	inline void invalidateTransform();
+
+	/**
+	 * @brief Mark the world transform of this node and of all
+	 * its children as changed.
+	 */
+	inline void invalidateWorldTransform();
+
+	void invalidateSubtree();
+
+	inline void setParent(Node* parent);
+
+	Affine2D _transform;
 	bool _transformUpdated;
+	mutable Affine2D _worldTransform;
+	mutable bool _worldTransformDirty;
 	
 	Vec2 _position;
 	Vec2 _size;
@@ -243,21 +394,29 @@ protected:
 	
 	int _zOrder;
 	int _addCounter;
+	bool _childrenOrderDirty; ///< A child z-order changed, see sortChildren()
 	
 	Node* _parent;
 	Scene* _scene;
 	
 	std::vector<std::shared_ptr<Node>> _children;
+	std::unordered_multimap<std::string, Node*> _childrenByName;
+	std::unordered_multimap<int, Node*> _childrenByTag;
 	std::vector<std::shared_ptr<Action>> _actions;
 	std::vector<Uint32> _actionsDone;
 
 	bool _touchEnabled;
 	TouchCallback _touchCallback;
 
-#ifndef _3DS
-	GLuint _vao;
-	GLuint _vbo;
-#endif // _3DS
+	bool _cullable;          ///< Set by the nodes drawing inside their bounding box
+	bool _cullingEnabled;
+	bool _hasSubtreeBounds;
+	Rect _subtreeBounds;
+	Uint32 _boundsStamp;     ///< Changed with the world transform or the subtree bounds
+
+	static bool s_culling;
+	static Rect s_cullRect;
+	static CullingStats s_cullingStats;
 };
 
 #include "Node.inl"
@@ -28,7 +28,7 @@ inline void Node::setPosition(float x, float y)
 {
 	_position.x = x;
 	_position.y = y;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -36,7 +36,7 @@ inline void Node::setPosition(float x, float y)
 inline void Node::setPosition(const Vec2 & position)
 {
 	_position = position;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -44,7 +44,7 @@ inline void Node::setPosition(const Vec2 & position)
 inline void Node::setPositionX(float x)
 {
 	_position.x = x;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -52,7 +52,7 @@ inline void Node::setPositionX(float x)
 inline void Node::setPositionY(float y)
 {
 	_position.y = y;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -60,7 +60,7 @@ inline void Node::setPositionY(float y)
 inline void Node::offsetPosition(const Vec2 & position)
 {
 	_position += position;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -69,7 +69,7 @@ inline void Node::offsetPosition(float x, float y)
 {
 	_position.x += x;
 	_position.y += y;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -77,7 +77,7 @@ inline void Node::offsetPosition(float x, float y)
 inline void Node::offsetPositionX(float amount)
 {
 	_position.x += amount;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -85,7 +85,7 @@ inline void Node::offsetPositionX(float amount)
 inline void Node::offsetPositionY(float amount)
 {
 	_position.y += amount;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -118,35 +118,73 @@ inline Rect Node::getBoundingBox() const
 
 //=============================================================================
 
-inline Transform Node::getParentTransform() const
+inline Affine2D Node::getParentTransform() const
 {
 	if(_parent)
 	{
 		return _parent->getCombinedTransform();
 	}
 	
-	return Transform();
+	return Affine2D();
 }
 
 //=============================================================================
 
-inline Transform Node::getTransform() const
+inline Affine2D Node::getTransform() const
 {
 	return _transform;
 }
 
 //=============================================================================
 
-inline Transform Node::getCombinedTransform() const
+inline const Affine2D& Node::getCombinedTransform() const
 {
-	return getParentTransform() * getTransform();
+	if (_worldTransformDirty)
+	{
+		if (_parent)
+			_worldTransform = _parent->getCombinedTransform() * _transform;
+		else
+			_worldTransform = _transform;
+
+		_worldTransformDirty = false;
+	}
+
+	return _worldTransform;
 }
 
 //=============================================================================
 
-inline void Node::setTransform(const Transform& transform)
+inline void Node::setTransform(const Affine2D& transform)
 {
 	_transform = transform;
+	invalidateWorldTransform();
+}
+
+//=============================================================================
+
+inline void Node::invalidateTransform()
+{
+	_transformUpdated = true;
+	invalidateWorldTransform();
+}
+
+//=============================================================================
+
+inline void Node::invalidateWorldTransform()
+{
+	// A dirty node always has a dirty subtree, see getCombinedTransform()
+	if (!_worldTransformDirty)
+	{
+		invalidateSubtree();
+	}
+}
+
+//=============================================================================
+
+inline void Node::setParent(Node* parent)
+{
+	_parent = parent;
+	invalidateWorldTransform();
 }
 
 //=============================================================================
@@ -154,7 +192,7 @@ inline void Node::setTransform(const Transform& transform)
 inline void Node::setScaleX(float scaleX)
 {
 	_scaleX = scaleX;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -162,7 +200,7 @@ inline void Node::setScaleX(float scaleX)
 inline void Node::setScaleY(float scaleY)
 {
 	_scaleY = scaleY;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -171,7 +209,7 @@ inline void Node::setScale(float scale)
 {
 	_scaleX = scale;
 	_scaleY = scale;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -201,7 +239,7 @@ inline void Node::setCenter(float x, float y)
 {
 	_center.x = x;
 	_center.y = y;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -209,7 +247,7 @@ inline void Node::setCenter(float x, float y)
 inline void Node::setCenter(const Vec2 & center)
 {
 	_center = center;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -224,7 +262,7 @@ inline Vec2 Node::getCenter() const
 inline void Node::setAngle(float angle)
 {
 	_angle = angle;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -232,7 +270,7 @@ inline void Node::setAngle(float angle)
 inline void Node::setAngleRad(float radians)
 {
 	_angle = util::rad_to_deg(radians);
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -255,7 +293,7 @@ inline void Node::setSkew(float skewX, float skewY)
 {
 	_skewX = skewX;
 	_skewY = skewY;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -263,7 +301,7 @@ inline void Node::setSkew(float skewX, float skewY)
 inline void Node::setSkewX(float skew)
 {
 	_skewX = skew;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -271,7 +309,7 @@ inline void Node::setSkewX(float skew)
 inline void Node::setSkewXRadians(float radians)
 {
 	_skewX = util::rad_to_deg(radians);
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -279,7 +317,7 @@ inline void Node::setSkewXRadians(float radians)
 inline void Node::setSkewY(float skew)
 {
 	_skewY = skew;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -287,7 +325,7 @@ inline void Node::setSkewY(float skew)
 inline void Node::setSkewYRadians(float radians)
 {
 	_skewY = util::rad_to_deg(radians);
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -365,7 +403,7 @@ inline bool Node::isFlipY() const
 inline void Node::setSize(const Vec2& size)
 {
 	_size = size;
-	_transformUpdated = true;
+	invalidateTransform();
 }
 
 //=============================================================================
@@ -393,7 +431,14 @@ inline std::string Node::getName() const
 
 inline void Node::setName(const std::string& name)
 {
+	// The parent finds its children by name
+	if (_parent)
+		_parent->unindexChild(this);
+
 	_name = name;
+
+	if (_parent)
+		_parent->indexChild(this);
 }
 
 //=============================================================================
@@ -407,7 +452,13 @@ inline int Node::getTag() const
 
 inline void Node::setTag(int tag)
 {
+	if (_parent)
+		_parent->unindexChild(this);
+
 	_tag = tag;
+
+	if (_parent)
+		_parent->indexChild(this);
 }
 
 //=============================================================================
@@ -437,8 +488,9 @@ inline void Node::setZOrder(int zOrder)
 {
 	_zOrder = zOrder;
 
+	// Sorted once before the next draw, whatever the changes until then
 	if (_parent)
-		_parent->sortByZOrder();
+		_parent->_childrenOrderDirty = true;
 }
 
 //=============================================================================
@@ -459,6 +511,7 @@ inline Node* Node::getParent()
 
 inline std::vector<std::shared_ptr<Node>>& Node::getChildren()
 {
+	sortChildren();
 	return _children;
 }
 
@@ -480,6 +533,7 @@ inline void Node::clearChildren()
 	
 	_children.clear();
 	_addCounter = 0;
+	reindexChildren();
 }
 
 //=============================================================================
@@ -27,6 +27,9 @@
 
 #include "Color.h"
 #include "ShaderProgram.h"
+#include "SpriteBatch.h"
+#include "RenderQueue.h"
+#include "RenderState.h"
 #include <Kairy/Math/Transform.h>
 
 NS_KAIRY_BEGIN
@@ -36,7 +39,8 @@ class RenderDevice
 public:
     enum
     {
-        CMD_SIZE_DEFAULT = 0x80000
+        CMD_SIZE_DEFAULT = 0x80000,
+        VERTEX_POOL_SIZE_DEFAULT = 0x80000
     };
 
 	/**
@@ -52,9 +56,12 @@ public:
     /**
      * @brief Initialize the render device.
      * @param cmd_size The gpu command buffer size.
+     * @param vertex_pool_size The size of the ring buffer holding the
+     * vertices streamed to the gpu.
      * @return false if an error occurred.
      */
-    bool init(Uint32 cmd_size = CMD_SIZE_DEFAULT);
+    bool init(Uint32 cmd_size = CMD_SIZE_DEFAULT,
+            Uint32 vertex_pool_size = VERTEX_POOL_SIZE_DEFAULT);
 
     /**
      * @brief Destroy the render device releasing all the resources.
@@ -140,6 +147,66 @@ public:
 	 */
 	ShaderProgram* getDefaultShaderProgram();
 
+	/**
+	 * @brief Get the sprite batch used for drawing textured quads.
+	 */
+	inline SpriteBatch* getSpriteBatch() { return _spriteBatch.get(); }
+
+	/**
+	 * @brief Get the queue collecting the submitted render commands.
+	 */
+	inline RenderQueue* getRenderQueue() { return _renderQueue.get(); }
+
+	/**
+	 * @brief Submit a textured quad for drawing. If the render queue
+	 * is enabled the quad is drawn when the queue is flushed, otherwise
+	 * it goes straight to the sprite batch.
+	 * @param command The quad to draw.
+	 */
+	void submit(const RenderCommand& command);
+
+	/**
+	 * @brief Execute the queued render commands and draw all the quads
+	 * waiting in the sprite batch.
+	 * Call it before issuing draw calls that don't go through the batch.
+	 */
+	void flush();
+
+	/**
+	 * @brief Set if the submitted commands should be queued and sorted
+	 * before being drawn. Enabled by default.
+	 */
+	void setRenderQueueEnabled(bool enable);
+
+	inline bool isRenderQueueEnabled() const { return _renderQueueEnabled; }
+
+	/**
+	 * @brief Set the blending used by the next draw calls.
+	 */
+	void setBlendMode(BlendMode mode);
+
+	inline BlendMode getBlendMode() const { return _blendMode; }
+
+	/**
+	 * @brief Get the gpu state tracked for filtering redundant calls.
+	 */
+	inline RenderState& getRenderState() { return _renderState; }
+
+	/**
+	 * @brief Get the bytes of vertex memory used by the last frame.
+	 */
+	Uint32 getVertexPoolUsage() const;
+
+	/**
+	 * @brief Get the most bytes of vertex memory used by a single frame.
+	 */
+	Uint32 getVertexPoolHighWaterMark() const;
+
+	/**
+	 * @brief Get the size of the vertex memory ring buffer.
+	 */
+	Uint32 getVertexPoolCapacity() const;
+
     /**
      * @brief Set if the 3d should be enabled.
      * @param enable Set it to true if you want to enable 3d.
@@ -243,6 +310,11 @@ private:
     Transform _botProjection;       ///< The bottom screen projection matrix
     Transform _defaultModelview;    ///< The default modelview matrix
 	std::unique_ptr<ShaderProgram> _defaultProgram; ///< The default shader program
+	std::unique_ptr<SpriteBatch> _spriteBatch; ///< The batch used for drawing sprites
+	std::unique_ptr<RenderQueue> _renderQueue; ///< The queue sorting the submitted commands
+	bool _renderQueueEnabled;       ///< Whether the submitted commands are queued
+	BlendMode _blendMode;           ///< The current blending
+	RenderState _renderState;       ///< The gpu state set by the draw calls
 #ifdef _3DS
     u32* _frameBuffer;              ///< The gpu framebuffer
     u32* _depthBuffer;              ///< The gpu depth buffer
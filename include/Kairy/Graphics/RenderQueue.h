@@ -0,0 +1,163 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef KAIRY_GRAPHICS_RENDER_QUEUE_H_INCLUDED
+#define KAIRY_GRAPHICS_RENDER_QUEUE_H_INCLUDED
+
+#include "Color.h"
+#include <Kairy/Math/Affine2D.h>
+
+NS_KAIRY_BEGIN
+
+class Texture;
+class ShaderProgram;
+class RenderDevice;
+
+/**
+ * @brief A textured quad submitted for drawing.
+ */
+struct RenderCommand
+{
+	RenderCommand(void)
+		: texture(nullptr)
+		, program(nullptr)
+		, color(Color::White)
+		, blendMode(BlendMode::Alpha)
+		, layer(0)
+		, zOrder(0)
+	{}
+
+	Texture* texture;       ///< The texture of the quad
+	ShaderProgram* program; ///< The program in use when it was submitted
+	Affine2D transform;     ///< The transform from quad space to screen space
+	Vec2 size;              ///< The size of the quad
+	Rect textureRect;       ///< The texture source rect in pixels
+	Color color;            ///< The color to blend the quad with
+	BlendMode blendMode;    ///< The blending of the quad
+	int layer;              ///< The layer, drawn in ascending order
+	int zOrder;             ///< The order inside the layer
+};
+
+/**
+ * @class RenderQueue
+ * @brief Defers the drawing of the submitted commands until it's flushed,
+ * then sorts them by layer and z-order. Inside the same layer and z-order
+ * the commands keep their submission order, the sprite batch merges the
+ * adjacent ones sharing a texture.
+ * Sorting them by shader program, blending and texture as well saves
+ * state changes, but reorders overlapping sprites, so it is opt-in.
+ * Drawables that don't submit commands act as barriers: the queue is
+ * flushed before they draw, so the sorting never crosses them.
+ */
+class RenderQueue
+{
+public:
+	/**
+	 * @brief Default constructor.
+	 */
+	RenderQueue(void);
+
+	/**
+	 * @brief Destructor.
+	 */
+	virtual ~RenderQueue();
+
+	/**
+	 * @brief Start a new frame, resetting the statistics.
+	 */
+	void begin();
+
+	/**
+	 * @brief Add a command to the queue.
+	 * @param command The command to add. The texture it points to
+	 * must stay alive until the queue is flushed.
+	 */
+	void submit(const RenderCommand& command);
+
+	/**
+	 * @brief Sort and execute all the queued commands.
+	 * @param device The device to draw with.
+	 */
+	void flush(RenderDevice& device);
+
+	/**
+	 * @brief Set if the commands sharing a layer and a z-order are sorted
+	 * by shader program, blending and texture. Disabled by default, only
+	 * enable it when those commands don't overlap, or the later ones may
+	 * be drawn under the earlier ones.
+	 */
+	inline void setStateSortingEnabled(bool enabled) { _stateSorting = enabled; }
+
+	inline bool isStateSortingEnabled() const { return _stateSorting; }
+
+	/**
+	 * @brief Get the number of commands waiting to be executed.
+	 */
+	inline Uint32 getPendingCommands() const { return (Uint32)_commands.size(); }
+
+	/**
+	 * @brief Get the number of commands executed since begin().
+	 */
+	inline Uint32 getExecutedCommands() const { return _executedCommands; }
+
+	/**
+	 * @brief Get the number of shader, blending and texture switches
+	 * issued since begin().
+	 */
+	inline Uint32 getStateChanges() const { return _stateChanges; }
+
+	/**
+	 * @brief Get the number of shader, blending and texture switches
+	 * saved by sorting since begin(), compared to drawing the
+	 * commands in submission order.
+	 */
+	inline Uint32 getStateChangesAvoided() const { return _stateChangesAvoided; }
+
+	RenderQueue(const RenderQueue&) = delete;
+	RenderQueue& operator=(const RenderQueue&) = delete;
+
+private:
+	struct SortItem
+	{
+		Uint64 key;
+		Uint32 index;
+	};
+
+	Uint32 getStateId(const void* state);
+	Uint64 createKey(const RenderCommand& command);
+	Uint32 countStateChanges(bool sorted) const;
+
+	std::vector<RenderCommand> _commands;   ///< The queued commands
+	std::vector<SortItem> _sortItems;       ///< The keys of the queued commands
+	std::vector<const void*> _states;       ///< Programs and textures seen in this flush
+	Uint32 _executedCommands;               ///< Commands executed since begin()
+	Uint32 _stateChanges;                   ///< State switches issued since begin()
+	Uint32 _stateChangesAvoided;            ///< State switches saved since begin()
+	bool _flushing;                         ///< Guards against recursive flushes
+	bool _stateSorting;                     ///< Sort by state inside a layer and z-order
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_RENDER_QUEUE_H_INCLUDED
@@ -0,0 +1,162 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef KAIRY_GRAPHICS_RENDER_STATE_H_INCLUDED
+#define KAIRY_GRAPHICS_RENDER_STATE_H_INCLUDED
+
+#include "Color.h"
+
+NS_KAIRY_BEGIN
+
+/** @class RenderState
+    @brief Tracks the gpu state set by the draw calls and
+    filters the calls that wouldn't change it.
+    The RenderDevice owns it and invalidates it at every startFrame().
+*/
+class RenderState
+{
+public:
+	static const int TEXTURE_UNITS = 3;
+
+	RenderState(void);
+
+	/**
+	 * @brief Forget the tracked state, the next calls are all issued.
+	 * Call it after changing the gpu state without the RenderState.
+	 */
+	void invalidate();
+
+	/**
+	 * @brief Set the blending factors of a blend mode.
+	 */
+	void setBlendMode(BlendMode mode);
+
+	/**
+	 * @brief Set the first combiner stage to modulate
+	 * the texture by the vertex color.
+	 */
+	void setTextureCombiner();
+
+	/**
+	 * @brief Set the first combiner stage to output a color,
+	 * ignoring the texture.
+	 * @param color The color, only used by the 3DS, the PC
+	 * uses the vertex color.
+	 */
+	void setColorCombiner(const Color& color);
+
+#ifdef _3DS
+	/**
+	 * @brief Bind tiled texels to a unit and enable only that unit.
+	 * @param levels The number of mipmap levels stored after the texels.
+	 */
+	void setTexture(int unit, const void* texels, Uint32 width, Uint32 height,
+		Uint32 params, GPU_TEXCOLOR format, int levels);
+
+	void useProgram(shaderProgram_s* program);
+
+	/**
+	 * @brief Forget a program, call it when a program is loaded.
+	 */
+	void forgetProgram(shaderProgram_s* program);
+#else
+	/**
+	 * @brief Bind a texture to a unit, making the unit active.
+	 */
+	void bindTexture(int unit, GLuint id);
+
+	/**
+	 * @brief Set the sampling parameters of a texture.
+	 * The texture must be bound to the active unit.
+	 */
+	void setTextureParams(GLuint id, GLint minFilter, GLint magFilter, GLint wrap);
+
+	/**
+	 * @brief Forget a texture name, call it when the name is
+	 * generated since the name of a deleted texture can be reused.
+	 */
+	void forgetTexture(GLuint id);
+
+	void bindVertexArray(GLuint vao);
+
+	void bindArrayBuffer(GLuint buffer);
+
+	void useProgram(GLuint program);
+
+	/**
+	 * @brief Forget a program name, call it when the name is created.
+	 */
+	void forgetProgram(GLuint program);
+#endif // _3DS
+
+private:
+	enum class Combiner
+	{
+		Unknown,
+		Texture,
+		Color
+	};
+
+	bool _blendKnown;        ///< False if the blending must be set again
+	BlendMode _blendMode;    ///< The blending set
+	Combiner _combiner;      ///< The first combiner stage set
+	Color _combinerColor;    ///< The color of the color combiner
+
+#ifdef _3DS
+	/** @brief The texture a unit samples. */
+	struct TextureUnit
+	{
+		const void* texels;
+		Uint32 width;
+		Uint32 height;
+		Uint32 params;
+		GPU_TEXCOLOR format;
+		int levels;
+	};
+
+	TextureUnit _units[TEXTURE_UNITS];
+	int _enabledUnits;       ///< The enabled units mask, -1 if unknown
+	shaderProgram_s* _program;
+#else
+	GLuint _units[TEXTURE_UNITS];
+	int _activeUnit;         ///< The active unit, -1 if unknown
+	GLuint _vertexArray;
+	GLuint _arrayBuffer;
+	GLuint _program;
+
+	/** @brief The sampling parameters of a texture. */
+	struct TextureParams
+	{
+		GLint minFilter;
+		GLint magFilter;
+		GLint wrap;
+	};
+
+	std::map<GLuint, TextureParams> _textureParams;
+#endif // _3DS
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_RENDER_STATE_H_INCLUDED
@@ -31,6 +31,30 @@ NS_KAIRY_BEGIN
 
 class RenderDevice;
 class Transform;
+class Affine2D;
+
+/** @class UniformHandle
+    @brief A uniform name resolved once, usable with every shader program.
+    Get one with ShaderProgram::getUniformHandle().
+*/
+class UniformHandle
+{
+public:
+    constexpr UniformHandle(void) : _id(-1) {}
+
+    explicit constexpr UniformHandle(int id) : _id(id) {}
+
+    inline bool isValid() const { return _id >= 0; }
+
+    inline int getId() const { return _id; }
+
+    static const UniformHandle Projection;      ///< UNIFORM_PROJECTION_NAME
+    static const UniformHandle Modelview;       ///< UNIFORM_MODELVIEW_NAME
+    static const UniformHandle TextureEnabled;  ///< "textureEnabled"
+
+private:
+    int _id;
+};
 
 /** @class ShaderProgram
     @brief Manages PICA200 shader programs.
@@ -84,20 +108,80 @@ public:
      */
     int getUniformLocation(const std::string& name) const;
 
+    /**
+     * @brief Get the handle of a uniform name.
+     * The loaded programs resolve it once, setting a uniform
+     * through a handle is only an index in the program.
+     * @param name The uniform name.
+     * @return The handle of the name.
+     */
+    static UniformHandle getUniformHandle(const std::string& name);
+
     void use();
 
+    /**
+     * @brief Get how many uniform uploads the last frame issued.
+     */
+    inline static Uint32 getUniformUploads() { return s_lastUploads; }
+
+    /**
+     * @brief Get how many uniform uploads the last frame skipped
+     * because the program already held the values.
+     */
+    inline static Uint32 getSkippedUniformUploads() { return s_lastSkippedUploads; }
+
+    /**
+     * @brief Start counting the uniform uploads of a new frame.
+     * Called by RenderDevice::swapBuffers().
+     */
+    static void resetUniformCounters();
+
     // Functions for setting uniforms values to the program in use
+    static void setUniform(UniformHandle handle, bool value);
+    static void setUniform(UniformHandle handle, float value);
+    static void setUniform(UniformHandle handle, float x, float y, float z);
+    static void setUniform(UniformHandle handle, float x, float y, float z, float w);
+    static void setUniform(UniformHandle handle, const Vec4& v4);
+    static void setUniform(UniformHandle handle, const Vec3& v3);
+    static void setUniform(UniformHandle handle, const Transform& t);
+    static void setUniform(UniformHandle handle, const Affine2D& t);
+
     static void setUniform(const std::string& name, float value);
     static void setUniform(const std::string& name, float x, float y, float z);
     static void setUniform(const std::string& name, float x, float y, float z, float w);
 	static void setUniform(const std::string& name, const Vec4& v4);
     static void setUniform(const std::string& name, const Vec3& v3);
     static void setUniform(const std::string& name, const Transform& t);
+    static void setUniform(const std::string& name, const Affine2D& t);
 
 private:
+    /** @brief The location of a uniform and the values it holds. */
+    struct UniformSlot
+    {
+        int    location;    ///< The location, negative if the program lacks it
+        Uint32 size;        ///< The number of held values (the uniform components), 0 if unknown
+        float  values[16];  ///< The last values uploaded
+    };
+
+    // Resolves the handles registered since the last call
+    void resolveUniforms();
+
+    UniformSlot* getUniformSlot(UniformHandle handle);
+
+    // Return the slot to upload the values to, or null if the upload is skipped
+    static UniformSlot* prepareUniform(UniformHandle handle, const float* values, Uint32 size);
+
+    // Uploads a float, vec3 or vec4 uniform of the given number of components
+    static void setFloatUniform(UniformHandle handle, const float* values, Uint32 count);
+
     static ShaderProgram* s_currentProgram;
+    static Uint32 s_uploads;
+    static Uint32 s_skippedUploads;
+    static Uint32 s_lastUploads;
+    static Uint32 s_lastSkippedUploads;
 	
 	mutable std::map<std::string, int> _locationsMap;
+	std::vector<UniformSlot> _uniforms;
 
 #ifdef _3DS
     DVLB_s*         _vertexShader;
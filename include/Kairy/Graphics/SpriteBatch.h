@@ -0,0 +1,193 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef KAIRY_GRAPHICS_SPRITE_BATCH_H_INCLUDED
+#define KAIRY_GRAPHICS_SPRITE_BATCH_H_INCLUDED
+
+#include "Color.h"
+#include <Kairy/Math/Affine2D.h>
+#include <Kairy/Math/Vec3.h>
+#include <Kairy/Math/Vec4.h>
+
+NS_KAIRY_BEGIN
+
+class Texture;
+class ShaderProgram;
+
+/**
+ * @class SpriteBatch
+ * @brief Collects textured quads transformed on the CPU into a shared
+ * vertex stream and draws every run of quads using the same texture
+ * and shader program with a single draw call.
+ */
+class SpriteBatch
+{
+public:
+	enum
+	{
+		MAX_QUADS = 1024,
+		VERTICES_PER_QUAD = 6
+	};
+
+	/**
+	 * @brief The vertex layout of the batched quads.
+	 */
+	struct Vertex
+	{
+#ifdef _3DS
+		Vec2 position;
+		Vec2 texcoord;
+		Vec4 color;
+#else
+		Vec3 position;
+		Vec4 color;
+		Vec2 texcoord;
+#endif // _3DS
+	};
+
+	/**
+	 * @brief Default constructor.
+	 */
+	SpriteBatch(void);
+
+	/**
+	 * @brief Destructor.
+	 */
+	virtual ~SpriteBatch();
+
+	/**
+	 * @brief Create the GPU resources used by the batch.
+	 * @return false if an error occurred.
+	 */
+	bool init();
+
+	/**
+	 * @brief Release the GPU resources used by the batch.
+	 */
+	void destroy();
+
+	/**
+	 * @brief Start batching a new frame, resetting the statistics.
+	 */
+	void begin();
+
+	/**
+	 * @brief Add a quad to the batch.
+	 * The pending quads are flushed first if the texture or the
+	 * shader program differ from the ones of the current run.
+	 * @param texture The texture of the quad.
+	 * @param transform The transform from quad space to screen space.
+	 * @param size The size of the quad.
+	 * @param textureRect The texture source rect in pixels.
+	 * @param color The color to blend the quad with.
+	 */
+	void draw(Texture& texture, const Affine2D& transform,
+		const Vec2& size, const Rect& textureRect, const Color& color);
+
+	/**
+	 * @brief Draw all the pending quads.
+	 */
+	void flush();
+
+	/**
+	 * @brief Draw a stream of quads built by the caller with a single
+	 * draw call, after flushing the pending quads.
+	 * @param texture The texture of the quads.
+	 * @param vertices The vertices, VERTICES_PER_QUAD for each quad.
+	 * @param quads The number of quads.
+	 */
+	void drawQuads(Texture& texture, const Vertex* vertices, Uint32 quads);
+
+	/**
+	 * @brief Draw a stream of quads built by the caller in their own
+	 * space with a single draw call, after flushing the pending quads.
+	 * @param texture The texture of the quads.
+	 * @param vertices The vertices, VERTICES_PER_QUAD for each quad.
+	 * @param quads The number of quads.
+	 * @param modelview The transform from quad space to screen space.
+	 */
+	void drawQuads(Texture& texture, const Vertex* vertices, Uint32 quads,
+		const Affine2D& modelview);
+
+	/**
+	 * @brief Write the vertices of a quad.
+	 * @param vertices Where to write the VERTICES_PER_QUAD vertices.
+	 * @param p0 The top left corner.
+	 * @param p1 The top right corner.
+	 * @param p2 The bottom left corner.
+	 * @param p3 The bottom right corner.
+	 * @param texcoords The texture coordinates, see getTexCoords().
+	 * @param color The color to blend the quad with.
+	 */
+	static void setQuad(Vertex* vertices, const Vec2& p0, const Vec2& p1,
+		const Vec2& p2, const Vec2& p3, const Rect& texcoords, const Vec4& color);
+
+	/**
+	 * @brief Rewrite only the texture coordinates of a quad
+	 * written with setQuad().
+	 */
+	static void setQuadTexCoords(Vertex* vertices, const Rect& texcoords);
+
+	/**
+	 * @brief Convert a texture source rect in pixels to
+	 * texture coordinates.
+	 */
+	static Rect getTexCoords(const Texture& texture, const Rect& textureRect);
+
+	/**
+	 * @brief Get the number of quads waiting to be drawn.
+	 */
+	inline Uint32 getPendingQuads() const { return _quadsCount; }
+
+	/**
+	 * @brief Get the number of draw calls issued since begin().
+	 */
+	inline Uint32 getDrawCalls() const { return _drawCalls; }
+
+	/**
+	 * @brief Get the number of quads drawn since begin().
+	 */
+	inline Uint32 getQuadsDrawn() const { return _quadsDrawn; }
+
+	SpriteBatch(const SpriteBatch&) = delete;
+	SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+private:
+	bool isSameRun(const Texture& texture) const;
+	void drawVertices(const Vertex* vertices, Uint32 count);
+
+	std::vector<Vertex> _vertices;  ///< The CPU side vertex stream
+	Uint32 _quadsCount;             ///< The number of pending quads
+	Uint32 _drawCalls;              ///< Draw calls issued since begin()
+	Uint32 _quadsDrawn;             ///< Quads drawn since begin()
+	const byte* _runPixels;         ///< The pixels of the current run texture
+	bool _runAaEnabled;             ///< The filtering of the current run texture
+	bool _runRepeated;              ///< The wrapping of the current run texture
+	ShaderProgram* _runProgram;     ///< The shader program of the current run
+	Affine2D _identity;             ///< Modelview used for flushing
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_SPRITE_BATCH_H_INCLUDED
@@ -27,6 +27,7 @@
 
 #include "Font.h"
 #include "Node.h"
+#include "SpriteBatch.h"
 
 NS_KAIRY_BEGIN
 
@@ -75,8 +76,6 @@ public:
 	
 	bool loadFont(float size);
 	
-	inline void setColor(const Color& color) override;
-
     inline Text& setString(const std::string& str);
 
     inline std::string getString(void) const;
@@ -93,7 +92,26 @@ public:
 
     inline bool getUseKerning() const;
 
-	inline std::shared_ptr<Sprite> getCharacter(Uint32 index);
+	/**
+	 * @brief Set the color a character is blended with, on top of
+	 * the color of the text.
+	 * @param index The index of the character in the string.
+	 * @param color The color of the character.
+	 */
+	void setCharacterColor(Uint32 index, const Color& color);
+
+	/**
+	 * @brief Get the color a character is blended with.
+	 * @param index The index of the character in the string.
+	 */
+	Color getCharacterColor(Uint32 index);
+
+	/**
+	 * @brief Set the opacity of a character.
+	 * @param index The index of the character in the string.
+	 * @param opacity The opacity of the character.
+	 */
+	inline void setCharacterOpacity(Uint32 index, byte opacity);
 
     Vec2 measureString(const std::string& str);
 
@@ -104,15 +122,25 @@ public:
     inline void draw(const std::string& str);
 
 protected:
+	struct Glyph
+	{
+		int page;       ///< The font page, -1 if the character has no glyph
+		Uint32 quad;    ///< The quad of the glyph in the page vertices
+		Color color;    ///< The color the glyph is blended with
+	};
+
     void incrementX(float& x, float& y, float amount);
 
-	void updateCharacters();
+	void updateGlyphs();
+
+	void updateGlyphColor(const Glyph& glyph);
 
-	std::vector<std::shared_ptr<Sprite>> _characters;
+	std::vector<Glyph> _glyphs;     ///< The glyph of every character of the string
+	std::vector<std::vector<SpriteBatch::Vertex>> _pageVertices; ///< The quads of every font page
+	Color _verticesColor;           ///< The text color the vertices were built with
+	bool _glyphsDirty;              ///< Whether the layout must be built again
 
     std::string _str;
-    Vec2 _position;
-    float _scale;
     int _lineWidth;
     bool _useKerning;
     Font _font;
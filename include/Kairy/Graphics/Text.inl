@@ -24,25 +24,13 @@
 
 //=============================================================================
 
-inline void Text::setColor(const Color& color)
-{
-	Node::setColor(color);
-	
-	for(auto& c : _characters)
-	{
-		c->setColor(color);
-	}
-}
-
-//=============================================================================
-
 inline Text& Text::setString(const std::string& str)
 {
 	if (str != _str)
 	{
 		_str = str;
 		setSize(measureString(str));
-		updateCharacters();
+		_glyphsDirty = true;
 	}
 
     return *this;
@@ -59,8 +47,12 @@ inline std::string Text::getString() const
 
 inline Text& Text::setLineWidth(int width)
 {
-    _lineWidth = width;
-	updateCharacters();
+	if (width != _lineWidth)
+	{
+		_lineWidth = width;
+		_glyphsDirty = true;
+	}
+
     return *this;
 }
 
@@ -89,7 +81,12 @@ inline int Text::getLineHeight() const
 
 inline Text& Text::setUseKerning(bool useKerning)
 {
-    _useKerning = useKerning;
+	if (useKerning != _useKerning)
+	{
+		_useKerning = useKerning;
+		_glyphsDirty = true;
+	}
+
     return *this;
 }
 
@@ -102,12 +99,9 @@ inline bool Text::getUseKerning() const
 
 //=============================================================================
 
-inline std::shared_ptr<Sprite> Text::getCharacter(Uint32 index)
+inline void Text::setCharacterOpacity(Uint32 index, byte opacity)
 {
-	if (index < _characters.size())
-		return _characters[index];
-
-	return nullptr;
+	setCharacterColor(index, Color(getCharacterColor(index), opacity));
 }
 
 //=============================================================================
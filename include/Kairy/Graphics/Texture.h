@@ -32,6 +32,9 @@ NS_KAIRY_BEGIN
 template<typename T>
 class ResourceManager;
 
+struct ResourceStats;
+enum class MemoryPool;
+
 class Rect;
 
 class Texture
@@ -55,6 +58,22 @@ public:
 		Default = Ram // Change this if needed
 	};
 
+	/**
+	 * @brief The format of the texels in memory.
+	 */
+	enum class Format
+	{
+		RGBA8,  ///< 32 bits, 8 bits per channel
+		RGB5A1, ///< 16 bits, 5 bits per color and 1 bit of alpha
+		RGB565, ///< 16 bits, opaque
+		RGBA4,  ///< 16 bits, 4 bits per channel
+		L8,     ///< 8 bits of luminance, opaque
+		A8,     ///< 8 bits of alpha, white
+		ETC1,   ///< 4 bits, compressed, opaque
+
+		Default = RGBA8
+	};
+
 	/**
 	 * @brief Return a pointer to the currently binded texture.
 	 */
@@ -72,6 +91,60 @@ public:
 	 */
 	inline static void setAaEnabledByDefault(bool enabled) { s_defaultAaEnabled = enabled; }
 
+	/**
+	 * @brief Get the format used by the new textures.
+	 */
+	inline static Format getDefaultFormat() { return s_defaultFormat; }
+
+	/**
+	 * @brief Set the format used by the new textures.
+	 * @param format The format of the textures loaded from now on.
+	 */
+	inline static void setDefaultFormat(Format format) { s_defaultFormat = format; }
+
+	/**
+	 * @brief Check if the conversions to 16 bits formats are dithered.
+	 */
+	inline static bool isDitheringEnabled() { return s_ditheringEnabled; }
+
+	/**
+	 * @brief Set if the conversions to 16 bits formats should be dithered.
+	 * @param enabled If the dithering should be enabled or not.
+	 */
+	inline static void setDitheringEnabled(bool enabled) { s_ditheringEnabled = enabled; }
+
+	/**
+	 * @brief Set how much memory the released textures can keep.
+	 * A texture loaded from a file stays cached after its last unload,
+	 * until the budget of its location is exceeded.
+	 * The cache is disabled by default. Only the texture allocations evict
+	 * the cached textures, so the budget must leave room for the vertex
+	 * pools, the sounds and the render textures.
+	 * @param location The memory the budget applies to.
+	 * @param bytes The budget, 0 disables the cache.
+	 */
+	static void setCacheBudget(Location location, Uint32 bytes);
+
+	/**
+	 * @brief Get the cache budget of a location.
+	 */
+	static Uint32 getCacheBudget(Location location);
+
+	/**
+	 * @brief Get the memory kept by the released textures of a location.
+	 */
+	static Uint32 getCachedMemory(Location location);
+
+	/**
+	 * @brief Get the hits, misses and evictions of the texture cache.
+	 */
+	static const ResourceStats& getCacheStats();
+
+	/**
+	 * @brief Destroy all the released textures.
+	 */
+	static void clearCache();
+
 	/**
 	 * @brief Preload a texture.
 	 * @param filename The texture file to load.
@@ -80,7 +153,8 @@ public:
 	static bool preload(const std::string& filename, Location location = Location::Default);
 
 	/**
-	 * @brief Unload a previously preloaded texture.
+	 * @brief Unload a previously preloaded texture, whatever
+	 * the default format it was preloaded with.
 	 * @param filename The texture file to unload.
 	 * @param location Where the texture was loaded.
 	 */
@@ -146,6 +220,7 @@ public:
 
 	/**
 	 * @brief Load the texture from a file.
+	 * A texture container (.ktex) is read as it is, keeping its format.
 	 * @param filename The texture file.
 	 * @param location Where the texture will be allocated.
 	 * @return false if an error occurred.
@@ -177,6 +252,20 @@ public:
 		PixelFormat format = PixelFormat::RGBA8,
 		Location location = Location::Default);
 
+	/**
+	 * @brief Load the texture from texels already in a texture format.
+	 * The texels are copied as they are, laid out like the GPU reads
+	 * them (see TextureConverter).
+	 * @param texels The texels, the size of a power of two texture.
+	 * @param width The texture width.
+	 * @param height The texture height.
+	 * @param format The format of the texels.
+	 * @param location Where the texture will be allocated.
+	 * @return false if an error occurred.
+	 */
+	bool loadTexels(const byte* texels, int width, int height, Format format,
+		Location location = Location::Default);
+
 	/**
 	 * @brief Create a rectangular texture with the specified dimensions
 	 * and fill it with the given color.
@@ -261,6 +350,22 @@ public:
 	 */
 	void clear(const Color& color = Color::Transparent);
 
+	/**
+	 * @brief Write a block of pixels, faster than setting them one by one.
+	 * On the PC only the modified regions are uploaded again.
+	 * @param region The pixels to write, clipped to the texture.
+	 * @param pixels The new pixels, region.width * region.height of them,
+	 * row by row.
+	 */
+	void writePixels(const Rect& region, const Color* pixels);
+
+	/**
+	 * @brief Fill a region of the texture with the given color.
+	 * @param region The pixels to fill, clipped to the texture.
+	 * @param color The color to use to fill the region.
+	 */
+	void fill(const Rect& region, const Color& color);
+
 	bool scaleHq2x(void);
 
 	bool scaleHq3x(void);
@@ -297,6 +402,43 @@ public:
 	 */
 	inline Location getLocation() const { return _location; }
 
+	/**
+	 * @brief Get the format of the texels.
+	 * @return The texture format.
+	 */
+	inline Format getFormat() const { return _format; }
+
+	/**
+	 * @brief Convert the texture to another format.
+	 * On an empty texture it sets the format of the next load.
+	 * @param format The new format of the texels.
+	 * @return false if an error occurred.
+	 */
+	bool setFormat(Format format);
+
+	/**
+	 * @brief Get the size of the texels in memory, mip levels included.
+	 * @return The size in bytes.
+	 */
+	Uint32 getMemorySize() const;
+
+	/**
+	 * @brief Build the mip levels of the texture, box filtered from the
+	 * pixels down to MIN_SIZE. A texture drawn smaller than its size then
+	 * samples the closest levels, blended when it is antialiased.
+	 * On the 3DS the levels are stored after the pixels and built again at
+	 * the next bind after the pixels are modified, on the PC the GPU builds
+	 * them after every upload. Loading new pixels drops the levels.
+	 * @param levels The levels count, the pixels included. 0 for all.
+	 * @return false if an error occurred.
+	 */
+	bool generateMipmaps(int levels = 0);
+
+	/**
+	 * @brief Get the mip levels count, 1 if there are no mipmaps.
+	 */
+	inline int getMipLevels() const { return _mipLevels; }
+
 	/**
 	 * @brief Enable or disable the antialiasing.
 	 * @param enable If true the texture will use the linear
@@ -335,6 +477,10 @@ public:
 	Texture& operator=(const Texture& other);
 
 private:
+	friend class SpriteBatch;
+	friend class RenderQueue;
+	friend class TextureResidency;
+	friend class AssetLoader;
 
 	struct ResourceData
 	{
@@ -343,6 +489,8 @@ private:
 			, width(0)
 			, height(0)
 			, location(Location::Default)
+			, format(Format::Default)
+			, mipLevels(1)
 			, pixels(nullptr)
 		{}
 
@@ -350,6 +498,8 @@ private:
 		int width;
 		int height;
 		Location location;
+		Format format;
+		int mipLevels;
 		byte* pixels;
 #ifndef _3DS
 		GLuint id;
@@ -359,6 +509,53 @@ private:
 	void loadResourceData(const ResourceData&);
 	void setMemResourceName();
 	ResourceData createResourceData();
+#ifndef _3DS
+	struct DirtyRect
+	{
+		int left;
+		int top;
+		int right;
+		int bottom;
+	};
+
+	void uploadPixels();
+	void uploadDirtyRects();
+	void applyParams();
+	void addDirtyRect(int left, int top, int right, int bottom);
+#else
+	/**
+	 * @brief Encode the mip levels after the first one.
+	 * @param pixels The pixels of the first level, overwritten.
+	 * @param texels The texels of the first level, followed by the room for the others.
+	 */
+	void encodeMipLevels(std::vector<Color>& pixels, byte* texels, int levels);
+	void markMipLevelsDirty();
+#endif // _3DS
+
+	static std::string getResourceName(const std::string& filename,
+		Location location, Format format);
+	static byte* allocatePixels(Uint32 size, Location location);
+	static void freePixels(byte* pixels, Location location);
+	static MemoryPool getMemoryPool(Location location);
+	static Uint32 getResourceSize(const ResourceData& data);
+	static void addResource(const std::string& name, const ResourceData& data);
+	static bool loadContainerData(const std::string& filename, Location location,
+		ResourceData& outData);
+
+	// The name a file is shared under, the one load(filename) uses
+	std::string getFileResourceName(const std::string& filename, Location location) const;
+	static bool isShared(const std::string& resourceName);
+	// Take a reference to a shared texture, false if it isn't loaded
+	bool loadShared(const std::string& resourceName);
+	// Share the data of a file under its name and load it
+	void loadFileData(const std::string& resourceName, const ResourceData& data);
+	// Load the decoded RGBA8 pixels of an image file and share them
+	bool loadFilePixels(const std::string& resourceName, const byte* pixels,
+		int width, int height, Location location);
+	// Load the native levels read from a container and share them
+	bool loadFileTexels(const std::string& resourceName, const byte* texels,
+		Uint32 size, int width, int height, Format format, int mipLevels,
+		Location location);
 
 	static ResourceManager<ResourceData> s_resourceManager;
 	static void deleteResourceData(ResourceData&);
@@ -370,21 +567,29 @@ protected:
 
 	static Texture* s_bindedTexture; ///< The currently binded texture
 	static bool s_defaultAaEnabled; ///< If the antialiasing is enabled by default
+	static Format s_defaultFormat;  ///< The format of the new textures
+	static bool s_ditheringEnabled; ///< If the 16 bits conversions are dithered
 
 	Location _location;  ///< The location of the texture pixels (Ram or Vram)
+	Format _format;      ///< The format of the texels
 	int _width;          ///< The texture width
 	int _height;         ///< The texture height
 	int _potWidth;       ///< The power of two width of the texture
 	int _potHeight;      ///< The power of two height of the texture
+	int _mipLevels;      ///< The mip levels count, 1 without mipmaps
 	bool _aaEnabled;     ///< Wheter the texture is antialiased or not
 	bool _repeated;      ///< Wheter the texture is repeated or not
-	bool _paramsUpdated; ///< True if the texture parameters changed
 	std::string _resourceName; ///< The name of the texture in the resource manager
 	byte* _pixels;       ///< The pixels of the texture
+	Uint32 _lastUsedFrame;   ///< The frame of the last bind, for the residency
+	bool _residencyManaged;  ///< If the TextureResidency moves the texture
 
 #ifndef _3DS
 	GLuint _id;
 	bool _pixelsUpdated;
+	std::vector<DirtyRect> _dirtyRects; ///< The regions to upload again
+#else
+	bool _mipLevelsDirty; ///< The levels after the first one miss pixel changes
 #endif // _3DS
 };
 
@@ -0,0 +1,194 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef KAIRY_GRAPHICS_TEXTURE_ATLAS_H_INCLUDED
+#define KAIRY_GRAPHICS_TEXTURE_ATLAS_H_INCLUDED
+
+#include <unordered_map>
+#include "Texture.h"
+#include "Image.h"
+
+NS_KAIRY_BEGIN
+
+/**
+ * @class TextureAtlas
+ * @brief Packs many small images into a few texture pages.
+ *
+ * Images are added by name, then pack() places them with a MaxRects
+ * (best short side fit) packer and uploads one texture per page.
+ * Frames are plain pixel rects in their page, so they can be given to
+ * Sprite::setTextureRect or to an Animation. An atlas can be saved to
+ * a descriptor plus page PNGs and loaded back without repacking.
+ */
+class TextureAtlas
+{
+public:
+	/**
+	 * @brief A packed image.
+	 */
+	struct Frame
+	{
+		Frame(void)
+			: page(0)
+			, trimmed(false)
+		{
+		}
+
+		int page;        ///< The index of the page holding the frame
+		Rect rect;       ///< The frame pixels in the page
+		Vec2 offset;     ///< Position of rect in the untrimmed image
+		Vec2 sourceSize; ///< Size of the untrimmed image
+		bool trimmed;    ///< Whether transparent borders were removed
+	};
+
+	/**
+	 * @brief Constructs an empty atlas.
+	 */
+	TextureAtlas(void);
+
+	/**
+	 * @brief Constructs an atlas loading it from a descriptor file.
+	 * @param filename The descriptor written by save().
+	 * @param location Where the pages will be allocated.
+	 */
+	TextureAtlas(const std::string& filename,
+		Texture::Location location = Texture::Location::Default);
+
+	/**
+	 * @brief Queue an image for the next pack().
+	 * @param name The name of the frame.
+	 * @param image The image to pack.
+	 * @return false if the image is empty or the name is taken.
+	 */
+	bool addImage(const std::string& name, const Image& image);
+
+	/**
+	 * @brief Queue an image file for the next pack().
+	 * @param name The name of the frame.
+	 * @param filename The image file to load.
+	 * @return false if the image can't be loaded or the name is taken.
+	 */
+	bool addImage(const std::string& name, const std::string& filename);
+
+	/**
+	 * @brief Pack the queued images and upload them to new pages.
+	 * The pages and frames packed or loaded before are kept as they are,
+	 * the queued images are never mixed into them. Packing everything at
+	 * once fills the pages better than packing in batches.
+	 * @param location Where the pages will be allocated.
+	 * @return false if an image doesn't fit in a page, nothing is added then.
+	 */
+	bool pack(Texture::Location location = Texture::Location::Default);
+
+	/**
+	 * @brief Load a packed atlas from a descriptor file.
+	 * @param filename The descriptor written by save().
+	 * @param location Where the pages will be allocated.
+	 * @return false if an error occurred.
+	 */
+	bool load(const std::string& filename,
+		Texture::Location location = Texture::Location::Default);
+
+	/**
+	 * @brief Save the pages as PNGs next to a descriptor file.
+	 * @param filename The descriptor file to write.
+	 * @return false if an error occurred.
+	 */
+	bool save(const std::string& filename) const;
+
+	/**
+	 * @brief Destroy the pages, the frames and the queued images.
+	 */
+	void clear();
+
+	inline void setPadding(int padding) { _padding = std::max(0, padding); }
+
+	inline int getPadding() const { return _padding; }
+
+	inline void setTrimEnabled(bool enabled) { _trimEnabled = enabled; }
+
+	inline bool isTrimEnabled() const { return _trimEnabled; }
+
+	/**
+	 * @brief Set the maximum size of a page, clamped to the texture limits.
+	 */
+	void setMaxPageSize(int size);
+
+	inline int getMaxPageSize() const { return _maxPageSize; }
+
+	inline bool hasFrame(const std::string& name) const { return _frames.count(name) > 0; }
+
+	/**
+	 * @brief Get a frame by name.
+	 * @return The frame or nullptr if there's no such frame.
+	 */
+	const Frame* getFrame(const std::string& name) const;
+
+	/**
+	 * @brief Get the rects of the given frames, for an Animation.
+	 * The frames should be on the same page and untrimmed.
+	 * @return The rects, or an empty vector if a frame is missing.
+	 */
+	std::vector<Rect> getFrameRects(const std::vector<std::string>& names) const;
+
+	inline Texture* getPage(int index) { return _pages.at(index).get(); }
+
+	inline int getPagesCount() const { return (int)_pages.size(); }
+
+	inline int getFramesCount() const { return (int)_frames.size(); }
+
+	/**
+	 * @brief Get the ratio between the packed pixels and the pages area.
+	 * @return A value in [0, 1], 0 if nothing has been packed.
+	 */
+	float getEfficiency() const;
+
+	/**
+	 * @brief Get the bytes used by the pages.
+	 */
+	Uint32 getMemoryUsage() const;
+
+	/**
+	 * @brief Get the bytes saved compared to one texture per image.
+	 * It can be negative when the pages are mostly empty.
+	 */
+	int getMemorySaved() const;
+
+private:
+	struct PendingImage
+	{
+		std::string name;
+		Image image;
+	};
+
+	std::vector<PendingImage> _pending;
+	std::vector<std::unique_ptr<Texture>> _pages;
+	std::unordered_map<std::string, Frame> _frames;
+	int _padding;
+	bool _trimEnabled;
+	int _maxPageSize;
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_TEXTURE_ATLAS_H_INCLUDED
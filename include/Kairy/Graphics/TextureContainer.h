@@ -0,0 +1,170 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef KAIRY_GRAPHICS_TEXTURE_CONTAINER_H_INCLUDED
+#define KAIRY_GRAPHICS_TEXTURE_CONTAINER_H_INCLUDED
+
+#include "Texture.h"
+
+NS_KAIRY_BEGIN
+
+/**
+ * @class TextureContainer
+ * @brief Reads and writes Kairy texture containers (.ktex).
+ *
+ * A container holds texels already converted to a texture format and
+ * laid out like the GPU reads them, so loading one is a plain read (or
+ * inflate) into the texture memory. Every mip level can be stored raw or
+ * zlib compressed.
+ *
+ * The file is little endian: a 20 bytes header ("KTEX", version, format,
+ * flags, compression, levels count, width, height, power of two width and
+ * height), then a table with the offset, the stored size and the raw size
+ * of every level, then the level payloads.
+ */
+class TextureContainer
+{
+public:
+	enum
+	{
+		VERSION = 1,
+		MAX_LEVELS = 8
+	};
+
+	/**
+	 * @brief How the level payloads are stored.
+	 */
+	enum class Compression
+	{
+		None,
+		Zlib
+	};
+
+	/**
+	 * @brief Write a container from RGBA8 pixels.
+	 * The smaller levels are box filtered from the previous ones and stop
+	 * at the minimum texture size.
+	 * @param filename The container file.
+	 * @param pixels The RGBA8 pixels.
+	 * @param width The width of the pixels.
+	 * @param height The height of the pixels.
+	 * @param format The format of the texels.
+	 * @param tiled If the texels are tiled (3DS) or linear (PC).
+	 * @param levels The number of mip levels to store.
+	 * @param compression How the levels are stored. A level that doesn't
+	 * shrink is stored raw.
+	 * @param dither If the 16 bits formats should be dithered.
+	 * @return false if an error occurred.
+	 */
+	static bool save(const std::string& filename, const byte* pixels,
+		int width, int height, Texture::Format format, bool tiled,
+		int levels = 1, Compression compression = Compression::Zlib,
+		bool dither = true);
+
+	/**
+	 * @brief Check if a file is a texture container, by its extension.
+	 */
+	static bool isContainer(const std::string& filename);
+
+	/**
+	 * @brief Default constructor.
+	 */
+	TextureContainer(void);
+
+	TextureContainer(const TextureContainer&) = delete;
+
+	/**
+	 * @brief Destructor, closes the file.
+	 */
+	~TextureContainer(void);
+
+	/**
+	 * @brief Open a container and read its header.
+	 * @param filename The container file.
+	 * @return false if the file is missing or invalid.
+	 */
+	bool open(const std::string& filename);
+
+	/**
+	 * @brief Close the container file.
+	 */
+	void close();
+
+	/**
+	 * @brief Read the texels of a level.
+	 * @param level The level index.
+	 * @param outTexels Where the texels are written, getLevelSize() bytes.
+	 * @return false if an error occurred.
+	 */
+	bool readLevel(int level, byte* outTexels);
+
+	/**
+	 * @brief Read the texels of a level laid out for the running platform.
+	 * A container built for the other platform is converted.
+	 * @param level The level index.
+	 * @param outTexels Where the texels are written, getLevelSize() bytes.
+	 * @return false if an error occurred.
+	 */
+	bool readNativeLevel(int level, byte* outTexels);
+
+	/**
+	 * @brief Get the size of the texels of a level.
+	 * @return The size in bytes.
+	 */
+	Uint32 getLevelSize(int level) const;
+
+	inline int getWidth() const { return _width; }
+
+	inline int getHeight() const { return _height; }
+
+	inline int getRealWidth() const { return _potWidth; }
+
+	inline int getRealHeight() const { return _potHeight; }
+
+	inline Texture::Format getFormat() const { return _format; }
+
+	inline bool isTiled() const { return _tiled; }
+
+	inline int getLevelsCount() const { return (int)_levels.size(); }
+
+private:
+	struct Level
+	{
+		Uint32 offset;
+		Uint32 size;
+		Uint32 rawSize;
+	};
+
+	std::ifstream _stream;
+	int _width;
+	int _height;
+	int _potWidth;
+	int _potHeight;
+	Texture::Format _format;
+	bool _tiled;
+	std::vector<Level> _levels;
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_TEXTURE_CONTAINER_H_INCLUDED
@@ -0,0 +1,157 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef KAIRY_GRAPHICS_TEXTURE_CONVERTER_H_INCLUDED
+#define KAIRY_GRAPHICS_TEXTURE_CONVERTER_H_INCLUDED
+
+#include "Texture.h"
+
+NS_KAIRY_BEGIN
+
+/**
+ * @class TextureConverter
+ * @brief Conversions between RGBA8 pixels and the texture formats.
+ *
+ * The texels are laid out like the GPU reads them: tiled (see
+ * TextureSwizzle) on the 3DS and linear on the PC. 16 bits texels are
+ * native endian words with red in the high bits, ETC1 blocks are 64 bits
+ * big endian words when linear and little endian words when tiled.
+ */
+class TextureConverter
+{
+public:
+	/**
+	 * @brief Get the bits used by a texel of the given format.
+	 */
+	static Uint32 getBitsPerPixel(Texture::Format format);
+
+	/**
+	 * @brief Get the bytes used by a texture of the given format and size.
+	 * @param levels The mip levels count, stored one after the other.
+	 */
+	static Uint32 getMemorySize(Texture::Format format, int potWidth, int potHeight,
+		int levels = 1);
+
+	/**
+	 * @brief Get how many mip levels a texture can have, every level
+	 * being at least Texture::MIN_SIZE wide and high.
+	 */
+	static int getMaxLevels(int potWidth, int potHeight);
+
+	/**
+	 * @brief Halve RGBA8 pixels with a 2x2 box filter.
+	 * The odd borders repeat the last pixel.
+	 * @param pixels The RGBA8 pixels, width * height of them.
+	 * @param outPixels The halved pixels, ((width + 1) / 2) * ((height + 1) / 2)
+	 * of them.
+	 */
+	static void downsample(const byte* pixels, int width, int height, byte* outPixels);
+
+	/**
+	 * @brief Convert RGBA8 pixels to texels.
+	 * The texels outside the pixels are cleared.
+	 * @param pixels The RGBA8 pixels, width * height of them.
+	 * @param width The width of the pixels.
+	 * @param height The height of the pixels.
+	 * @param format The format of the texels.
+	 * @param dither If the 16 bits formats should be dithered.
+	 * @param tiled If the texels should be tiled.
+	 * @param outTexels The texels, getMemorySize() bytes.
+	 * @param potWidth The width of the texture, a multiple of 8.
+	 * @param potHeight The height of the texture, a multiple of 8.
+	 */
+	static void encode(const byte* pixels, int width, int height,
+		Texture::Format format, bool dither, bool tiled,
+		byte* outTexels, int potWidth, int potHeight);
+
+	/**
+	 * @brief Convert RGBA8 pixels to a region of the texels, the texels
+	 * outside the region are kept. The region must be inside the texture.
+	 * An ETC1 region re-encodes the blocks it overlaps.
+	 * @param pixels The RGBA8 pixels.
+	 * @param pitch The pixels between the starts of two rows.
+	 * @param x The left of the region.
+	 * @param y The top of the region.
+	 * @param width The width of the region.
+	 * @param height The height of the region.
+	 */
+	static void encodeRegion(const byte* pixels, int pitch,
+		int x, int y, int width, int height,
+		Texture::Format format, bool dither, bool tiled,
+		byte* outTexels, int potWidth);
+
+	/**
+	 * @brief Fill a region of the texels with a color, like encodeRegion().
+	 */
+	static void fillRegion(const Color& color, int x, int y, int width, int height,
+		Texture::Format format, bool dither, bool tiled,
+		byte* outTexels, int potWidth);
+
+	/**
+	 * @brief Convert texels to RGBA8 pixels.
+	 */
+	static void decode(const byte* texels, int potWidth, int potHeight,
+		Texture::Format format, bool tiled,
+		byte* outPixels, int width, int height);
+
+	/**
+	 * @brief Move ETC1 blocks to the other layout, tiled to linear or back.
+	 * The blocks are reordered and byte swapped, never re-encoded.
+	 * @param texels The ETC1 texels, getMemorySize() bytes.
+	 * @param tiled If the source texels are tiled.
+	 * @param outTexels The texels in the other layout, getMemorySize() bytes.
+	 */
+	static void swapEtc1Layout(const byte* texels, int potWidth, int potHeight,
+		bool tiled, byte* outTexels);
+
+	/**
+	 * @brief Read a single texel.
+	 */
+	static Color getTexel(const byte* texels, int potWidth,
+		Texture::Format format, bool tiled, int x, int y);
+
+	/**
+	 * @brief Write a single texel.
+	 * An ETC1 texel re-encodes its whole 4x4 block.
+	 */
+	static void setTexel(byte* texels, int potWidth,
+		Texture::Format format, bool tiled, int x, int y, const Color& color);
+
+	/**
+	 * @brief Compress a 4x4 block to ETC1.
+	 * @param block The 16 pixels of the block, row by row.
+	 * @return The ETC1 block.
+	 */
+	static Uint64 encodeEtc1Block(const Color* block);
+
+	/**
+	 * @brief Decompress an ETC1 block.
+	 * @param block The ETC1 block.
+	 * @param outBlock The 16 pixels of the block, row by row.
+	 */
+	static void decodeEtc1Block(Uint64 block, Color* outBlock);
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_TEXTURE_CONVERTER_H_INCLUDED
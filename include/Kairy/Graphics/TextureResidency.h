@@ -0,0 +1,119 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef KAIRY_GRAPHICS_TEXTURE_RESIDENCY_H_INCLUDED
+#define KAIRY_GRAPHICS_TEXTURE_RESIDENCY_H_INCLUDED
+
+#include "Texture.h"
+
+NS_KAIRY_BEGIN
+
+/**
+ * @class TextureResidency
+ * @brief Moves the managed textures between VRAM and linear RAM.
+ *
+ * Texture::bind() stamps a texture with the current frame. Once per frame,
+ * from RenderDevice::swapBuffers() when the GPU is idle, the textures in
+ * VRAM that weren't used for a while, or the least recently used ones when
+ * over the budget, are demoted to linear RAM. The textures used in the
+ * last frame, or prefetched, are then promoted while the budget allows.
+ * The GPU reads both memories, so a texture is always drawable, VRAM is
+ * only faster. On the PC the textures don't move.
+ */
+class TextureResidency
+{
+public:
+	static TextureResidency* getInstance();
+
+	/**
+	 * @brief Get the current frame number, the stamp of the used textures.
+	 */
+	inline static Uint32 getFrame() { return s_frame; }
+
+	TextureResidency(void);
+
+	TextureResidency(const TextureResidency&) = delete;
+
+	/**
+	 * @brief Manage a texture. It must be unmanaged, or destroyed, before
+	 * the residency manager.
+	 */
+	void manage(Texture& texture);
+
+	void unmanage(Texture& texture);
+
+	/**
+	 * @brief Mark a texture as needed soon, as if it was used this frame.
+	 */
+	inline void prefetch(Texture& texture) { texture._lastUsedFrame = s_frame; }
+
+	/**
+	 * @brief Set how many bytes of VRAM the managed textures can use.
+	 */
+	inline void setVramBudget(Uint32 bytes) { _vramBudget = bytes; }
+
+	inline Uint32 getVramBudget() const { return _vramBudget; }
+
+	/**
+	 * @brief Get the bytes of VRAM used by the managed textures.
+	 */
+	Uint32 getVramUsage() const;
+
+	/**
+	 * @brief Set after how many frames without use a texture leaves VRAM.
+	 */
+	inline void setColdFrames(Uint32 frames) { _coldFrames = frames; }
+
+	inline Uint32 getColdFrames() const { return _coldFrames; }
+
+	/**
+	 * @brief Set how many textures can move in a frame.
+	 * Every move is a copy of the whole texture.
+	 */
+	inline void setMaxMovesPerFrame(int moves) { _maxMovesPerFrame = moves; }
+
+	inline int getMaxMovesPerFrame() const { return _maxMovesPerFrame; }
+
+	inline Uint32 getPromotionsCount() const { return _promotions; }
+
+	inline Uint32 getDemotionsCount() const { return _demotions; }
+
+	/**
+	 * @brief Move the textures and start a new frame.
+	 */
+	void update();
+
+private:
+	static Uint32 s_frame;
+
+	std::vector<Texture*> _textures;
+	Uint32 _vramBudget;
+	Uint32 _coldFrames;
+	int _maxMovesPerFrame;
+	Uint32 _promotions;
+	Uint32 _demotions;
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_TEXTURE_RESIDENCY_H_INCLUDED
@@ -0,0 +1,123 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef KAIRY_GRAPHICS_TEXTURE_SWIZZLE_H_INCLUDED
+#define KAIRY_GRAPHICS_TEXTURE_SWIZZLE_H_INCLUDED
+
+#include <Kairy/Common.h>
+
+NS_KAIRY_BEGIN
+
+/**
+ * @class TextureSwizzle
+ * @brief Conversions between linear RGBA8 pixels and texture memory.
+ *
+ * The 3DS GPU reads textures as 8x8 tiles with the texels of each tile in
+ * Morton (Z) order, every texel stored as ABGR. These routines convert a
+ * whole 8x8 block at a time with word copies (and SSE2/NEON where
+ * available) instead of computing the tiled index of every pixel.
+ * They don't touch the GPU, so they can be tested and timed on any host.
+ */
+class TextureSwizzle
+{
+public:
+	/**
+	 * @brief Get the index of a texel in a tiled texture.
+	 * @param x The x coordinate of the texel.
+	 * @param y The y coordinate of the texel.
+	 * @param width The width of the texture, a multiple of 8.
+	 * @return The index of the texel, in texels.
+	 */
+	static inline Uint32 getTiledIndex(int x, int y, int width)
+	{
+		return ((((y >> 3) * (width >> 3) + (x >> 3)) << 6) +
+			s_mortonX[x & 7] + s_mortonY[y & 7]);
+	}
+
+	/**
+	 * @brief Convert between RGBA and ABGR byte orders.
+	 */
+	static inline Uint32 swapChannels(Uint32 texel)
+	{
+#if defined(__GNUC__)
+		return __builtin_bswap32(texel);
+#else
+		return (texel << 24) | ((texel << 8) & 0x00FF0000) |
+			((texel >> 8) & 0x0000FF00) | (texel >> 24);
+#endif
+	}
+
+	/**
+	 * @brief Convert a buffer between RGBA and ABGR byte orders.
+	 * @param texels The texels to convert.
+	 * @param outTexels The converted texels, may be the same as texels.
+	 * @param count The number of texels.
+	 */
+	static void swapChannels(const Uint32* texels, Uint32* outTexels, Uint32 count);
+
+	/**
+	 * @brief Convert linear RGBA8 pixels to a tiled ABGR texture.
+	 * The texels outside the pixels are cleared.
+	 * @param pixels The RGBA8 pixels, width * height of them.
+	 * @param width The width of the pixels.
+	 * @param height The height of the pixels.
+	 * @param outTexels The texture, potWidth * potHeight texels.
+	 * @param potWidth The width of the texture, a multiple of 8.
+	 * @param potHeight The height of the texture, a multiple of 8.
+	 */
+	static void tile(const byte* pixels, int width, int height,
+		Uint32* outTexels, int potWidth, int potHeight);
+
+	/**
+	 * @brief Convert a tiled ABGR texture to linear RGBA8 pixels.
+	 * @param texels The texture, potWidth * potHeight texels.
+	 * @param potWidth The width of the texture, a multiple of 8.
+	 * @param potHeight The height of the texture, a multiple of 8.
+	 * @param outPixels The RGBA8 pixels, width * height of them.
+	 * @param width The width of the pixels.
+	 * @param height The height of the pixels.
+	 */
+	static void untile(const Uint32* texels, int potWidth, int potHeight,
+		byte* outPixels, int width, int height);
+
+	/**
+	 * @brief Copy linear RGBA8 pixels to a larger linear texture.
+	 * The texels outside the pixels are cleared.
+	 */
+	static void pad(const byte* pixels, int width, int height,
+		Uint32* outTexels, int potWidth, int potHeight);
+
+	/**
+	 * @brief Copy the top left part of a linear texture to RGBA8 pixels.
+	 */
+	static void unpad(const Uint32* texels, int potWidth, int potHeight,
+		byte* outPixels, int width, int height);
+
+private:
+	static const byte s_mortonX[8]; ///< Morton offset of the x bits
+	static const byte s_mortonY[8]; ///< Morton offset of the y bits
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_TEXTURE_SWIZZLE_H_INCLUDED
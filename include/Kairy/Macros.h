@@ -38,4 +38,12 @@
 		ptr = nullptr;\
 	}
 
+// The SIMD instruction set used by the vectorized code paths,
+// everything else (like the ARM11 of the 3DS) uses the scalar ones
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KAIRY_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define KAIRY_SIMD_NEON
+#endif
+
 #endif // KAIRY_MACROS_H_INCLUDED
@@ -29,6 +29,7 @@
 #include "Math/Vec3.h"
 #include "Math/Vec4.h"
 #include "Math/Transform.h"
+#include "Math/Affine2D.h"
 #include "Math/Rect.h"
 
 #endif // KAIRY_MATH_H_INCLUDED
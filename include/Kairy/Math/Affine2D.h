@@ -0,0 +1,115 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef KAIRY_MATH_AFFINE_2D_H_INCLUDED
+#define KAIRY_MATH_AFFINE_2D_H_INCLUDED
+
+#include "Transform.h"
+
+NS_KAIRY_BEGIN
+
+/**
+ * @class Affine2D
+ * @brief A 2D affine transform stored as a 2x3 matrix, mapping (x, y)
+ * to (a * x + b * y + tx, c * x + d * y + ty).
+ * It is expanded to a 4x4 matrix only when uploaded to a shader.
+ */
+class Affine2D
+{
+public:
+	static const Affine2D Identity;
+
+	inline static Affine2D createTranslation(float x, float y);
+	inline static Affine2D createTranslation(const Vec2& position);
+
+	inline static Affine2D createRotation(float radians);
+
+	inline static Affine2D createScale(float x, float y);
+	inline static Affine2D createScale(float scale);
+
+	inline static Affine2D createSkewX(float radians);
+	inline static Affine2D createSkewY(float radians);
+
+	/**
+	 * @brief Default constructor, the identity transform.
+	 */
+	inline Affine2D(void);
+
+	inline Affine2D(float a, float b, float c, float d, float tx, float ty);
+
+	inline void setIdentity(void);
+
+	/**
+	 * @brief Get an element of the matrix.
+	 * @param x The column, 0 to 2, the last one is the translation.
+	 * @param y The row, 0 or 1.
+	 */
+	inline float getValue(int x, int y) const;
+
+	inline void setValue(int x, int y, float value);
+
+	inline Vec2 getTranslation() const;
+
+	inline Vec2 transformVec2(const Vec2& vec) const;
+
+	/**
+	 * @brief Transform an array of points, vectorized when possible.
+	 * The source and the destination can be the same array.
+	 */
+	void transformPoints(const Vec2* points, Vec2* results, Uint32 count) const;
+
+	Rect transformRect(const Rect& rect) const;
+
+	/**
+	 * @brief Get the inverse transform, or the identity if
+	 * the transform can't be inverted.
+	 */
+	Affine2D getInverse() const;
+
+	/**
+	 * @brief Expand to the equivalent 4x4 matrix.
+	 */
+	inline Transform toTransform() const;
+
+	/**
+	 * @brief Multiply by another transform, vectorized when possible.
+	 * The other transform is applied first.
+	 */
+	Affine2D& combine(const Affine2D& other);
+
+	inline Affine2D operator*(const Affine2D& other) const;
+
+	inline bool operator==(const Affine2D& other) const;
+
+	inline bool operator!=(const Affine2D& other) const;
+
+private:
+	float _m[6];  ///< The columns: a, c, b, d, tx, ty
+};
+
+#include "Affine2D.inl"
+
+NS_KAIRY_END
+
+#endif // KAIRY_MATH_AFFINE_2D_H_INCLUDED
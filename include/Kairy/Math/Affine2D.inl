@@ -0,0 +1,181 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+//=============================================================================
+
+inline Affine2D Affine2D::createTranslation(float x, float y)
+{
+	return Affine2D(1.0f, 0.0f, 0.0f, 1.0f, x, y);
+}
+
+//=============================================================================
+
+inline Affine2D Affine2D::createTranslation(const Vec2& position)
+{
+	return Affine2D(1.0f, 0.0f, 0.0f, 1.0f, position.x, position.y);
+}
+
+//=============================================================================
+
+inline Affine2D Affine2D::createRotation(float radians)
+{
+	float cos = std::cos(radians);
+	float sin = std::sin(radians);
+
+	return Affine2D(cos, -sin, sin, cos, 0.0f, 0.0f);
+}
+
+//=============================================================================
+
+inline Affine2D Affine2D::createScale(float x, float y)
+{
+	return Affine2D(x, 0.0f, 0.0f, y, 0.0f, 0.0f);
+}
+
+//=============================================================================
+
+inline Affine2D Affine2D::createScale(float scale)
+{
+	return Affine2D(scale, 0.0f, 0.0f, scale, 0.0f, 0.0f);
+}
+
+//=============================================================================
+
+inline Affine2D Affine2D::createSkewX(float radians)
+{
+	return Affine2D(1.0f, std::tan(radians), 0.0f, 1.0f, 0.0f, 0.0f);
+}
+
+//=============================================================================
+
+inline Affine2D Affine2D::createSkewY(float radians)
+{
+	return Affine2D(1.0f, 0.0f, std::tan(radians), 1.0f, 0.0f, 0.0f);
+}
+
+//=============================================================================
+
+inline Affine2D::Affine2D(void)
+{
+	setIdentity();
+}
+
+//=============================================================================
+
+inline Affine2D::Affine2D(float a, float b, float c, float d, float tx, float ty)
+{
+	_m[0] = a;
+	_m[1] = c;
+	_m[2] = b;
+	_m[3] = d;
+	_m[4] = tx;
+	_m[5] = ty;
+}
+
+//=============================================================================
+
+inline void Affine2D::setIdentity()
+{
+	_m[0] = 1.0f;
+	_m[1] = 0.0f;
+	_m[2] = 0.0f;
+	_m[3] = 1.0f;
+	_m[4] = 0.0f;
+	_m[5] = 0.0f;
+}
+
+//=============================================================================
+
+inline float Affine2D::getValue(int x, int y) const
+{
+	if (x >= 0 && y >= 0 && x < 3 && y < 2)
+	{
+		return _m[x * 2 + y];
+	}
+	return 0.0f;
+}
+
+//=============================================================================
+
+inline void Affine2D::setValue(int x, int y, float value)
+{
+	if (x >= 0 && y >= 0 && x < 3 && y < 2)
+	{
+		_m[x * 2 + y] = value;
+	}
+}
+
+//=============================================================================
+
+inline Vec2 Affine2D::getTranslation() const
+{
+	return Vec2(_m[4], _m[5]);
+}
+
+//=============================================================================
+
+inline Vec2 Affine2D::transformVec2(const Vec2& vec) const
+{
+	return Vec2(
+		_m[0] * vec.x + _m[2] * vec.y + _m[4],
+		_m[1] * vec.x + _m[3] * vec.y + _m[5]);
+}
+
+//=============================================================================
+
+inline Transform Affine2D::toTransform() const
+{
+	return Transform::createAffine(_m[0], _m[2], _m[1], _m[3], _m[4], _m[5]);
+}
+
+//=============================================================================
+
+inline Affine2D Affine2D::operator*(const Affine2D& other) const
+{
+	Affine2D ret = *this;
+	return ret.combine(other);
+}
+
+//=============================================================================
+
+inline bool Affine2D::operator==(const Affine2D& other) const
+{
+	for (int i = 0; i < 6; ++i)
+	{
+		if (_m[i] != other._m[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//=============================================================================
+
+inline bool Affine2D::operator!=(const Affine2D& other) const
+{
+	return !(*this == other);
+}
+
+//=============================================================================
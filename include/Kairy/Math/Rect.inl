@@ -232,7 +232,7 @@ inline bool Rect::intersects(const Rect& other) const
     return getLeft() < other.getRight() &&
             getRight() > other.getLeft() &&
             getTop() < other.getBottom() &&
-            getRight() > other.getTop();
+            getBottom() > other.getTop();
 }
 
 //=============================================================================
@@ -50,6 +50,13 @@ public:
 	inline static Transform createFlipX();
 	inline static Transform createFlipY();
 
+	/**
+	 * @brief Create a 2D affine transform mapping (x, y) to
+	 * (a * x + b * y + tx, c * x + d * y + ty).
+	 */
+	inline static Transform createAffine(float a, float b, float c, float d,
+		float tx, float ty);
+
     inline Transform(void);
 
     inline void setZero(void);
@@ -60,9 +67,9 @@ public:
 
     inline void setValue(int x, int y, float value);
 
-	inline Vec2 transformVec2(const Vec2& vec);
+	inline Vec2 transformVec2(const Vec2& vec) const;
 
-	Rect transformRect(const Rect& rect);
+	Rect transformRect(const Rect& rect) const;
 
     inline Transform& combine(const Transform& other);
 
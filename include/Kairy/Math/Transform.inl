@@ -153,6 +153,23 @@ inline Transform Transform::createFlipY()
 
 //=============================================================================
 
+inline Transform Transform::createAffine(float a, float b, float c, float d,
+	float tx, float ty)
+{
+	Transform ret;
+
+	ret._m[0][0] = a;
+	ret._m[0][1] = b;
+	ret._m[0][3] = tx;
+	ret._m[1][0] = c;
+	ret._m[1][1] = d;
+	ret._m[1][3] = ty;
+
+	return ret;
+}
+
+//=============================================================================
+
 inline Transform::Transform(void)
 {
 	setIdentity();
@@ -206,7 +223,7 @@ inline void Transform::setValue(int x, int y, float value)
 
 //=============================================================================
 
-inline Vec2 Transform::transformVec2(const Vec2 & vec)
+inline Vec2 Transform::transformVec2(const Vec2 & vec) const
 {
 	return Vec2(
 		vec.x * _m[0][0] + vec.y * _m[0][1] + _m[0][3],
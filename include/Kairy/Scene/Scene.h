@@ -26,6 +26,7 @@
 #define KAIRY_SCENE_SCENE_H_INCLUDED
 
 #include <Kairy/Graphics/Node.h>
+#include "SpatialIndex.h"
 #include <Kairy/System/InputManager.h>
 
 NS_KAIRY_BEGIN
@@ -75,6 +76,8 @@ public:
 	virtual void addChild(const std::shared_ptr<Node>& child, int zOrder,
 		const std::string& name) override;
 
+	virtual void addChildren(const std::vector<std::shared_ptr<Node>>& children) override;
+
 	void addChildBot(const std::shared_ptr<Node>& child);
 
 	void addChildBot(const std::shared_ptr<Node>& child, int zOrder);
@@ -83,6 +86,8 @@ public:
 
 	void addChildBot(const std::shared_ptr<Node>& child, int zOrder, const std::string& name);
 
+	void addChildrenBot(const std::vector<std::shared_ptr<Node>>& children);
+
 	void addChild(const std::shared_ptr<Node>& child, Screen screen);
 
 	void addChild(const std::shared_ptr<Node>& child, int zOrder, Screen screen);
@@ -100,24 +105,62 @@ public:
 
 	Uint32 getChildrenCountBot() const;
 
-	inline std::vector<std::shared_ptr<Node>>& getChildrenBot() { return _childrenBot; }
+	inline std::vector<std::shared_ptr<Node>>& getChildrenBot() { sortChildren(); return _childrenBot; }
 
-	virtual void removeChildByTag(int tag) override;
+	virtual void removeChild(Node* child) override;
 
-	virtual void removeChildByName(const std::string& name) override;
+	/**
+	 * @brief Remove the children of both screens matching a predicate.
+	 */
+	virtual void removeChildrenIf(const std::function<bool(Node*)>& predicate) override;
 
-	virtual void removeChild(Node* child) override;
+	virtual void sortChildren() override;
 
 	void sortByZOrderBot();
 
+	/**
+	 * @brief Keep a grid of the children bounds for each screen.
+	 * The SceneManager then draws and touches only the children
+	 * found in the grid. Disabled by default.
+	 * @param cellSize The side of the grid cells in pixels.
+	 */
+	void setSpatialIndexEnabled(bool enabled, float cellSize = 64.0f);
+
+	inline bool isSpatialIndexEnabled() const { return _spatialIndexEnabled; }
+
+	/**
+	 * @brief Bring the index of a screen up to date with its children.
+	 * @return The index, or nullptr when the spatial index is disabled.
+	 */
+	SpatialIndex* updateSpatialIndex(Screen screen);
+
+	/**
+	 * @brief Get the children of a screen whose bounding box
+	 * intersects a rect in world space, in drawing order.
+	 */
+	void queryNodes(const Rect& rect, Screen screen, std::vector<Node*>& result);
+
+	/**
+	 * @brief Get the children of a screen whose bounding box
+	 * intersects a circle in world space, in drawing order.
+	 */
+	void queryNodes(const Vec2& center, float radius, Screen screen,
+		std::vector<Node*>& result);
+
 protected:
 
+	virtual void reindexChildren() override;
+
 	InputManager* _input;
 
 	Color _colorBot;
 	int _addCounterBot;
 	std::vector<std::shared_ptr<Node>> _childrenBot;
 
+	bool _spatialIndexEnabled;
+	SpatialIndex _spatialIndex;
+	SpatialIndex _spatialIndexBot;
+
 private:
 	friend class SceneManager;
 };
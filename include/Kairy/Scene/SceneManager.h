@@ -51,6 +51,19 @@ public:
 	void draw();
 	
 	void update(float dt);
+
+	/**
+	 * @brief Set if the nodes outside the screens are skipped.
+	 * Enabled by default.
+	 */
+	inline void setCullingEnabled(bool enabled) { _cullingEnabled = enabled; }
+
+	inline bool isCullingEnabled() const { return _cullingEnabled; }
+
+	/**
+	 * @brief Get the nodes drawn and culled by the last draw().
+	 */
+	inline const CullingStats& getCullingStats() const { return Node::getCullingStats(); }
 	
 	SceneManager& operator=(const SceneManager&) = delete;
 	
@@ -68,11 +81,22 @@ private:
 	
 	void onTouchUp(Vec2 position, float dt);
 
+	void beginCulling(const Vec2& screenSize);
+
+	/**
+	 * @brief Visit the children of a screen, through the spatial
+	 * index of the scene when it is enabled.
+	 */
+	void visitChildren(Scene* scene, Screen screen);
+
 private:
 	SceneManager(void) = default;
 	SceneManager(const SceneManager&) = default;
 
 	std::stack<std::shared_ptr<Scene>> _sceneStack;
+	bool _cullingEnabled = true;
+	std::vector<Node*> _visibleNodes;
+	std::vector<Node*> _touchedNodes;
 };
 
 NS_KAIRY_END
@@ -0,0 +1,126 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef KAIRY_SCENE_SPATIAL_INDEX_H_INCLUDED
+#define KAIRY_SCENE_SPATIAL_INDEX_H_INCLUDED
+
+#include <Kairy/Graphics/Node.h>
+#include <unordered_map>
+
+NS_KAIRY_BEGIN
+
+/** @class SpatialIndex
+    @brief Uniform grid of the world bounding boxes of a list of nodes.
+    A Scene keeps one per screen for its children, the queries return
+    the nodes in the order of the list, that is in drawing order.
+*/
+class SpatialIndex
+{
+public:
+	SpatialIndex(float cellSize = 64.0f);
+
+	/**
+	 * @brief Set the side of the grid cells in pixels, the grid is
+	 * built again at the next update().
+	 */
+	void setCellSize(float cellSize);
+
+	inline float getCellSize() const { return _cellSize; }
+
+	/**
+	 * @brief Bring the index up to date with a list of nodes.
+	 * Only the nodes moved since the last update are placed again,
+	 * the whole grid is built again when the list changed.
+	 */
+	void update(const std::vector<std::shared_ptr<Node>>& nodes);
+
+	void clear();
+
+	inline Uint32 getNodesCount() const { return _entries.size(); }
+
+	/**
+	 * @brief Get the nodes whose bounding box intersects a rect in world space.
+	 */
+	void queryRect(const Rect& rect, std::vector<Node*>& result) const;
+
+	/**
+	 * @brief Get the nodes whose bounding box contains a point in world space.
+	 */
+	void queryPoint(const Vec2& point, std::vector<Node*>& result) const;
+
+	/**
+	 * @brief Get the nodes whose bounding box intersects a circle in world space.
+	 */
+	void queryRadius(const Vec2& center, float radius, std::vector<Node*>& result) const;
+
+	/**
+	 * @brief Get the nodes to visit to draw a view: the nodes whose bounds
+	 * intersect the view and the nodes that can't be culled, see Node::visit().
+	 */
+	void queryVisible(const Rect& view, std::vector<Node*>& result) const;
+
+private:
+	struct Entry
+	{
+		Node* node;
+		Uint32 stamp;        ///< The bounds stamp of the node when it was placed
+		bool placed;
+		Rect box;            ///< The bounding box of the node
+		Rect bounds;         ///< The box merged with the subtree bounds, used for the cells
+		int cellLeft;
+		int cellTop;
+		int cellRight;
+		int cellBottom;
+		bool large;          ///< Covers too many cells, tested alone
+		bool unculled;       ///< Visited whatever the view
+		mutable Uint32 mark; ///< The last query returning the entry
+	};
+
+	void place(Uint32 index);
+
+	void unplace(Uint32 index);
+
+	/**
+	 * @brief Call a function with the entries whose cells intersect a rect,
+	 * once each.
+	 */
+	template <typename Func>
+	void forEachCandidate(const Rect& rect, Func func) const;
+
+	void sortResult(std::vector<Uint32>& indices, std::vector<Node*>& result) const;
+
+	static Uint64 cellKey(int x, int y);
+
+	float _cellSize;
+	std::vector<Entry> _entries;
+	std::unordered_map<Uint64, std::vector<Uint32>> _cells;
+	std::vector<Uint32> _large;
+	std::vector<Uint32> _unculled;      ///< The entries visited whatever the view
+	mutable std::vector<Uint32> _found;
+	mutable Uint32 _queryMark;
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_SCENE_SPATIAL_INDEX_H_INCLUDED
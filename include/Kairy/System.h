@@ -30,6 +30,9 @@
 #include "System/File.h"
 #include "System/Random.h"
 #include "System/Thread.h"
+#include "System/Mutex.h"
+#include "System/Semaphore.h"
+#include "System/AssetLoader.h"
 #include "System/Time.h"
 #include "System/Timer.h"
 #include "System/StopWatch.h"
@@ -0,0 +1,209 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef KAIRY_SYSTEM_ASSET_LOADER_H_INCLUDED
+#define KAIRY_SYSTEM_ASSET_LOADER_H_INCLUDED
+
+#include <Kairy/Graphics/Texture.h>
+#include <Kairy/System/Mutex.h>
+#include <Kairy/System/Semaphore.h>
+#include <Kairy/System/Thread.h>
+#include <deque>
+#include <atomic>
+
+NS_KAIRY_BEGIN
+
+class Font;
+class SoundData;
+class TmxMap;
+
+/**
+ * @class AssetLoader
+ * @brief Loads assets on background threads.
+ *
+ * A load is split in two steps. The task runs on a worker thread and does
+ * the file reads and the decoding. The finisher runs on the main thread
+ * from update(), which is called by RenderDevice::swapBuffers(), and
+ * creates the GPU resources. update() runs finishers until the upload
+ * budget of the frame is spent.
+ *
+ * An asset must not be used until its request is done.
+ */
+class AssetLoader
+{
+public:
+	typedef std::function<bool()> Task;
+	typedef std::function<bool()> Finisher;
+	typedef std::function<void(bool)> Callback;
+
+	/**
+	 * @brief The state of a queued load.
+	 */
+	class Request
+	{
+	public:
+		Request(void)
+			: _done(false)
+			, _loaded(false)
+		{}
+
+		/**
+		 * @brief Check if the load is over, successfully or not.
+		 */
+		inline bool isDone() const { return _done; }
+
+		/**
+		 * @brief Check if the asset was loaded.
+		 */
+		inline bool isLoaded() const { return _loaded; }
+
+	private:
+		friend class AssetLoader;
+
+		bool _done;
+		bool _loaded;
+	};
+
+	typedef std::shared_ptr<Request> RequestPtr;
+
+	static AssetLoader* getInstance();
+
+	AssetLoader(void);
+
+	AssetLoader(const AssetLoader&) = delete;
+
+	/**
+	 * @brief Destructor, waits for the running tasks and drops the others.
+	 */
+	virtual ~AssetLoader();
+
+	/**
+	 * @brief Set the number of worker threads.
+	 * It takes effect when the workers are started again.
+	 */
+	inline void setWorkersCount(int count) { _workersCount = std::max(1, count); }
+
+	inline int getWorkersCount() const { return _workersCount; }
+
+	/**
+	 * @brief Set the time the finishers can take in a frame.
+	 * At least one finisher runs every frame.
+	 */
+	inline void setUploadBudget(const Time& budget) { _uploadBudget = budget; }
+
+	inline Time getUploadBudget() const { return _uploadBudget; }
+
+	/**
+	 * @brief Queue a load.
+	 * @param task The work done on a worker thread, may be empty.
+	 * @param finisher The work done on the main thread, may be empty.
+	 * @param callback Called on the main thread when the load is over.
+	 * @return The request of the load.
+	 */
+	RequestPtr enqueue(const Task& task, const Finisher& finisher,
+		const Callback& callback = nullptr);
+
+	/**
+	 * @brief Load a texture. Images are decoded by the worker.
+	 * The texture is shared and cached like with Texture::load(filename),
+	 * a file that is already loaded isn't decoded again.
+	 */
+	RequestPtr loadTexture(const std::shared_ptr<Texture>& texture,
+		const std::string& filename, const Callback& callback = nullptr,
+		Texture::Location location = Texture::Location::Default);
+
+	/**
+	 * @brief Load a TTF font. The glyphs are rasterized by the worker.
+	 */
+	RequestPtr loadFont(const std::shared_ptr<Font>& font,
+		const std::string& filename, float size, const Callback& callback = nullptr,
+		Texture::Location location = Texture::Location::Default);
+
+	/**
+	 * @brief Load and decode a sound on the worker.
+	 */
+	RequestPtr loadSound(const std::shared_ptr<SoundData>& sound,
+		const std::string& filename, const Callback& callback = nullptr);
+
+	/**
+	 * @brief Parse a TMX map on the worker.
+	 */
+	RequestPtr loadTmxMap(const std::shared_ptr<TmxMap>& map,
+		const std::string& filename, const Callback& callback = nullptr);
+
+	/**
+	 * @brief Run the finishers and the callbacks of the completed tasks.
+	 */
+	void update();
+
+	/**
+	 * @brief Block until every queued load is over.
+	 */
+	void waitAll();
+
+	/**
+	 * @brief Get the number of loads that aren't over.
+	 */
+	int getPendingCount() const;
+
+	/**
+	 * @brief Get the fraction of the queued loads that are over.
+	 * The count restarts when every load is over.
+	 * @return A value between 0 and 1, 1 when nothing is queued.
+	 */
+	float getProgress() const;
+
+	inline bool isIdle() const { return getPendingCount() == 0; }
+
+private:
+	struct Job
+	{
+		Task task;
+		Finisher finisher;
+		Callback callback;
+		RequestPtr request;
+		bool succeeded;
+	};
+
+	typedef std::shared_ptr<Job> JobPtr;
+
+	void startWorkers();
+	void stopWorkers();
+	void workerLoop();
+	void finish(const JobPtr& job);
+
+	Mutex _mutex;
+	Semaphore _pendingSignal;   ///< Posted once per pending job, the workers sleep on it
+	std::deque<JobPtr> _pending;
+	std::deque<JobPtr> _completed;
+	std::vector<std::unique_ptr<Thread>> _workers;
+	std::atomic<bool> _running;
+	int _workersCount;
+	Time _uploadBudget;
+	int _queuedCount;
+	int _doneCount;
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_SYSTEM_ASSET_LOADER_H_INCLUDED
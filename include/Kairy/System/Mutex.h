@@ -21,46 +21,63 @@
  * THE SOFTWARE.
  *
  *****************************************************************************/
+#ifndef KAIRY_SYSTEM_MUTEX_H_INCLUDED
+#define KAIRY_SYSTEM_MUTEX_H_INCLUDED
 
-#ifndef KAIRY_GRAPHICS_VERTEX_POOL_H_INCLUDED
-#define KAIRY_GRAPHICS_VERTEX_POOL_H_INCLUDED
+#include <Kairy/Common.h>
 
-#include "../Graphics/Vertex.h"
+#ifndef _3DS
+#include <mutex>
+#endif // _3DS
 
 NS_KAIRY_BEGIN
 
-class VertexPool
+class Mutex
 {
 public:
 
-    enum
-    {
-        START_SIZE = 0x10000
-    };
+	Mutex(void);
 
-    static VertexPool* getInstance();
+	Mutex(const Mutex&) = delete;
 
-    void* pushVertices(Uint32 size, Uint32 count);
+	virtual ~Mutex();
 
-	template<typename T>
-	T* pushVertices(Uint32 count) {
-		return static_cast<T*>(pushVertices(sizeof(T), count));
-	}
-
-    void clear();
+	void lock();
 
-    virtual ~VertexPool();
+	void unlock();
 
 private:
+#ifdef _3DS
+	Handle _handle;
+#else
+	std::mutex _mutex;
+#endif // _3DS
+};
 
-    VertexPool();
-    VertexPool(const VertexPool&) = default;
+/**
+ * @brief Locks a mutex for the lifetime of the object.
+ */
+class Lock
+{
+public:
 
-    Uint32 _size;
-    Uint32 _index;
-    void* _vertices;
+	explicit Lock(Mutex& mutex)
+		: _mutex(mutex)
+	{
+		_mutex.lock();
+	}
+
+	Lock(const Lock&) = delete;
+
+	~Lock()
+	{
+		_mutex.unlock();
+	}
+
+private:
+	Mutex& _mutex;
 };
 
 NS_KAIRY_END
 
-#endif // KAIRY_GRAPHICS_VERTEX_POOL_H_INCLUDED
+#endif // KAIRY_SYSTEM_MUTEX_H_INCLUDED
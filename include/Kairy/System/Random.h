@@ -66,6 +66,12 @@ public:
 
 	bool nextBoolean() const;
 
+	/**
+	 * @brief Fill an array with random floats in [min, max),
+	 * cheaper than calling nextFloat() for every value.
+	 */
+	void fill(float* values, Uint32 count, float min = 0.0f, float max = 1.0f) const;
+
 private:
 	Uint32 _seed;
 	mutable sfmt_t _sfmt;
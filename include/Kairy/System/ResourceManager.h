@@ -26,9 +26,42 @@
 #define KAIRY_SYSTEM_RESOURCE_MANAGER_H_INCLUDED
 
 #include <Kairy/Common.h>
+#include <unordered_map>
+#include <list>
 
 NS_KAIRY_BEGIN
 
+/**
+ * @brief The memory pools a resource can be charged to.
+ */
+enum class MemoryPool
+{
+	Linear,
+	Vram,
+	Audio,
+
+	Count
+};
+
+/**
+ * @brief The cache counters of a resource manager.
+ */
+struct ResourceStats
+{
+	Uint32 hits;      ///< Loads of a resource already in memory
+	Uint32 misses;    ///< Loads of a resource not in memory
+	Uint32 evictions; ///< Unreferenced resources destroyed to free memory
+};
+
+/**
+ * @class ResourceManager
+ * @brief Reference counted resources with a memory budgeted cache.
+ *
+ * When the last reference to a resource goes away it is kept in a least
+ * recently used list of its pool, and loading it again is a hit. The
+ * unreferenced resources are destroyed, oldest first, when their pool
+ * goes over its budget or when evict() asks for memory.
+ */
 template<typename T>
 class ResourceManager
 {
@@ -36,21 +69,33 @@ public:
 
 	ResourceManager(void)
 	{
+		init();
 		_deleteFunc = nullptr;
 	}
 
 	ResourceManager(const std::function<void(T&)>& deleteFunc)
 	{
+		init();
 		_deleteFunc = deleteFunc;
 	}
 
+	ResourceManager(const std::function<void(T&)>& deleteFunc,
+		Uint32 linearBudget, Uint32 vramBudget = 0, Uint32 audioBudget = 0)
+	{
+		init();
+		_deleteFunc = deleteFunc;
+		_pools[(int)MemoryPool::Linear].budget = linearBudget;
+		_pools[(int)MemoryPool::Vram].budget = vramBudget;
+		_pools[(int)MemoryPool::Audio].budget = audioBudget;
+	}
+
 	virtual ~ResourceManager(void)
 	{
 		if (_deleteFunc)
 		{
 			for (auto& resource : _resources)
 			{
-				if (resource.second.preloaded)
+				if (resource.second.preloaded || resource.second.refCount <= 0)
 					_deleteFunc(resource.second.userData);
 			}
 		}
@@ -61,7 +106,57 @@ public:
 		_deleteFunc = deleteFunc;
 	}
 
-	bool addResource(const std::string& key, const T& userData)
+	/**
+	 * @brief Set how many bytes the unreferenced resources of a pool can
+	 * keep. 0 destroys them as soon as they are released.
+	 */
+	void setBudget(MemoryPool pool, Uint32 bytes)
+	{
+		_pools[(int)pool].budget = bytes;
+		trim(pool);
+	}
+
+	Uint32 getBudget(MemoryPool pool) const
+	{
+		return _pools[(int)pool].budget;
+	}
+
+	/**
+	 * @brief Get the bytes used by all the resources of a pool.
+	 */
+	Uint32 getUsedMemory(MemoryPool pool) const
+	{
+		return _pools[(int)pool].used;
+	}
+
+	/**
+	 * @brief Get the bytes used by the unreferenced resources of a pool.
+	 */
+	Uint32 getCachedMemory(MemoryPool pool) const
+	{
+		return _pools[(int)pool].cached;
+	}
+
+	inline const ResourceStats& getStats() const { return _stats; }
+
+	void resetStats()
+	{
+		_stats.hits = 0;
+		_stats.misses = 0;
+		_stats.evictions = 0;
+	}
+
+	/**
+	 * @brief Add a resource with a reference.
+	 * @param key The name of the resource.
+	 * @param userData The resource.
+	 * @param size The bytes used by the resource.
+	 * @param pool The pool the bytes are charged to.
+	 * @param cacheable If the resource can be loaded again by its name.
+	 * If false it's destroyed with its last reference.
+	 */
+	bool addResource(const std::string& key, const T& userData,
+		Uint32 size = 0, MemoryPool pool = MemoryPool::Linear, bool cacheable = true)
 	{
 		if (_resources.find(key) != _resources.end())
 			return false;
@@ -70,13 +165,22 @@ public:
 		resource.preloaded = false;
 		resource.refCount = 1;
 		resource.userData = userData;
+		resource.size = size;
+		resource.pool = pool;
+		resource.cacheable = cacheable;
+		resource.cached = false;
 
 		_resources[key] = resource;
+		_pools[(int)pool].used += size;
 
 		return true;
 	}
 
-	bool removeResource(const std::string& key)
+	/**
+	 * @brief Change the data, the size or the pool of a resource.
+	 */
+	bool updateResource(const std::string& key, const T& userData,
+		Uint32 size, MemoryPool pool)
 	{
 		auto it = _resources.find(key);
 
@@ -85,19 +189,52 @@ public:
 
 		Resource& resource = it->second;
 
+		_pools[(int)resource.pool].used -= resource.size;
+		_pools[(int)pool].used += size;
+
+		resource.userData = userData;
+		resource.size = size;
+		resource.pool = pool;
+
+		trim(pool);
+
+		return true;
+	}
+
+	bool removeResource(const std::string& key)
+	{
+		auto it = _resources.find(key);
+
+		if (it == _resources.end() || it->second.refCount <= 0)
+			return false;
+
+		Resource& resource = it->second;
+
 		resource.refCount--;
 
 		if (resource.refCount <= 0)
 		{
-			if (_deleteFunc)
-				_deleteFunc(resource.userData);
-			_resources.erase(it);
+			Pool& pool = _pools[(int)resource.pool];
+
+			if (resource.cacheable && pool.budget > 0 && resource.size <= pool.budget)
+			{
+				pool.lru.push_front(key);
+				pool.cached += resource.size;
+				resource.lruIt = pool.lru.begin();
+				resource.cached = true;
+				trim(resource.pool);
+			}
+			else
+			{
+				destroy(it);
+			}
 		}
 
 		return true;
 	}
 
-	bool preloadResource(const std::string& key, const T& userData)
+	bool preloadResource(const std::string& key, const T& userData,
+		Uint32 size = 0, MemoryPool pool = MemoryPool::Linear)
 	{
 		if (_resources.find(key) != _resources.end())
 			return true;
@@ -106,8 +243,13 @@ public:
 		resource.preloaded = true;
 		resource.refCount = 1;
 		resource.userData = userData;
+		resource.size = size;
+		resource.pool = pool;
+		resource.cacheable = true;
+		resource.cached = false;
 
 		_resources[key] = resource;
+		_pools[(int)pool].used += size;
 
 		return true;
 	}
@@ -116,17 +258,13 @@ public:
 	{
 		auto it = _resources.find(key);
 
-		if (it != _resources.end())
+		if (it == _resources.end())
 			return false;
 
 		Resource& resource = it->second;
 
 		if (resource.preloaded)
-		{
-			if(_deleteFunc)
-				_deleteFunc(resource.userData);
-			_resources.erase(it);
-		}
+			destroy(it);
 
 		return true;
 	}
@@ -136,6 +274,20 @@ public:
 		return _resources.find(key) != _resources.end();
 	}
 
+	/**
+	 * @brief Get the number of references to a resource.
+	 * @return 0 if the resource is cached or missing.
+	 */
+	int getReferenceCount(const std::string& key) const
+	{
+		auto it = _resources.find(key);
+
+		if (it == _resources.end())
+			return 0;
+
+		return it->second.refCount;
+	}
+
 	bool getResourceData(const std::string& key, T& outData)
 	{
 		auto it = _resources.find(key);
@@ -148,12 +300,21 @@ public:
 		return true;
 	}
 
+	/**
+	 * @brief Get a resource and add a reference to it.
+	 * @return false if the resource isn't loaded, a cache miss.
+	 */
 	bool loadResource(const std::string& key, T& outData)
 	{
 		auto it = _resources.find(key);
 
 		if (it == _resources.end())
+		{
+			_stats.misses++;
 			return false;
+		}
+
+		_stats.hits++;
 
 		Resource& resource = it->second;
 
@@ -162,6 +323,15 @@ public:
 			resource.refCount = 1;
 			resource.preloaded = false;
 		}
+		else if (resource.cached)
+		{
+			Pool& pool = _pools[(int)resource.pool];
+
+			pool.lru.erase(resource.lruIt);
+			pool.cached -= resource.size;
+			resource.cached = false;
+			resource.refCount = 1;
+		}
 		else
 		{
 			resource.refCount++;
@@ -172,16 +342,103 @@ public:
 		return true;
 	}
 
+	/**
+	 * @brief Destroy unreferenced resources of a pool, oldest first.
+	 * @param pool The pool to free.
+	 * @param bytes How many bytes are needed.
+	 * @return The bytes freed.
+	 */
+	Uint32 evict(MemoryPool pool, Uint32 bytes)
+	{
+		Pool& p = _pools[(int)pool];
+		Uint32 freed = 0;
+
+		while (freed < bytes && !p.lru.empty())
+		{
+			auto it = _resources.find(p.lru.back());
+			freed += it->second.size;
+			destroy(it);
+			_stats.evictions++;
+		}
+
+		return freed;
+	}
+
+	/**
+	 * @brief Destroy all the unreferenced resources.
+	 */
+	void clearCache()
+	{
+		for (int pool = 0; pool < (int)MemoryPool::Count; ++pool)
+			evict((MemoryPool)pool, UINT32_MAX);
+	}
+
 private:
 	struct Resource
 	{
 		T userData;
 		int refCount;
 		bool preloaded;
+		bool cacheable;
+		bool cached;
+		Uint32 size;
+		MemoryPool pool;
+		std::list<std::string>::iterator lruIt;
 	};
 
+	struct Pool
+	{
+		Uint32 budget;
+		Uint32 used;
+		Uint32 cached;
+		std::list<std::string> lru; // Most recently released first
+	};
+
+	typedef typename std::unordered_map<std::string, Resource>::iterator ResourceIterator;
+
+	void init()
+	{
+		for (auto& pool : _pools)
+		{
+			pool.budget = 0;
+			pool.used = 0;
+			pool.cached = 0;
+		}
+
+		resetStats();
+	}
+
+	void trim(MemoryPool pool)
+	{
+		Pool& p = _pools[(int)pool];
+
+		if (p.cached > p.budget)
+			evict(pool, p.cached - p.budget);
+	}
+
+	void destroy(ResourceIterator it)
+	{
+		Resource& resource = it->second;
+		Pool& pool = _pools[(int)resource.pool];
+
+		if (resource.cached)
+		{
+			pool.lru.erase(resource.lruIt);
+			pool.cached -= resource.size;
+		}
+
+		pool.used -= resource.size;
+
+		if (_deleteFunc)
+			_deleteFunc(resource.userData);
+
+		_resources.erase(it);
+	}
+
 	std::function<void(T&)> _deleteFunc;
-	std::map<std::string, Resource> _resources;
+	std::unordered_map<std::string, Resource> _resources;
+	Pool _pools[(int)MemoryPool::Count];
+	ResourceStats _stats;
 };
 
 NS_KAIRY_END
@@ -0,0 +1,71 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef KAIRY_SYSTEM_SEMAPHORE_H_INCLUDED
+#define KAIRY_SYSTEM_SEMAPHORE_H_INCLUDED
+
+#include <Kairy/Common.h>
+
+#ifndef _3DS
+#include <mutex>
+#include <condition_variable>
+#endif // _3DS
+
+NS_KAIRY_BEGIN
+
+/**
+ * @brief A counter the threads can wait on without spinning.
+ */
+class Semaphore
+{
+public:
+	Semaphore(void);
+
+	Semaphore(const Semaphore&) = delete;
+
+	virtual ~Semaphore();
+
+	/**
+	 * @brief Increment the counter, waking a waiting thread.
+	 */
+	void post(int count = 1);
+
+	/**
+	 * @brief Block until the counter is positive, then decrement it.
+	 */
+	void wait();
+
+private:
+#ifdef _3DS
+	Handle _handle;
+#else
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	int _count;
+#endif // _3DS
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_SYSTEM_SEMAPHORE_H_INCLUDED
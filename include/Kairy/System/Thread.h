@@ -59,6 +59,13 @@ public:
 
 	Thread(const Callback& callback);
 
+	/**
+	 * @brief Constructs a thread with a custom stack.
+	 * @param callback The function run by the thread.
+	 * @param stackSize The stack size in bytes, used on the 3DS only.
+	 */
+	Thread(const Callback& callback, Uint32 stackSize);
+
 	virtual ~Thread();
 
     bool start(void* userdata,
@@ -86,9 +93,10 @@ private:
 	
 	static void svcThreadFunc(void*);
 	
-	enum { STACK_SIZE = 1024 * 2 };
+	enum { STACK_SIZE = 1024 * 8 };
 	
 	void* _userdata;
+	Uint32 _stackSize;
 
 	Handle _handle;
 	u32* _stack;
@@ -42,6 +42,18 @@ public:
         Staggered
     };
 
+    enum class StaggerAxis
+    {
+        X,
+        Y
+    };
+
+    enum class StaggerIndex
+    {
+        Odd,
+        Even
+    };
+
 	struct TileCollision
 	{
 		int id;
@@ -69,6 +81,10 @@ public:
 
     inline Orientation getOrientation() const { return _orientation; }
 
+    inline StaggerAxis getStaggerAxis() const { return _staggerAxis; }
+
+    inline StaggerIndex getStaggerIndex() const { return _staggerIndex; }
+
 	inline int getTilesetsCount() const { return (int)_tilesets.size(); }
 
 	inline int getLayersCount() const { return (int)_layers.size(); }
@@ -122,6 +138,8 @@ private:
     int _tileHeight;
     Color _bgColor;
     Orientation _orientation;
+    StaggerAxis _staggerAxis;
+    StaggerIndex _staggerIndex;
     TmxProperties _properties;
     std::vector<TmxTileset> _tilesets;
     std::map<std::string, int> _layersIn;
@@ -27,12 +27,18 @@
 
 #include "TmxMap.h"
 #include <Kairy/Graphics/Sprite.h>
+#include <Kairy/Graphics/SpriteBatch.h>
 
 NS_KAIRY_BEGIN
 
 class TmxMapRenderer : public Node
 {
 public:
+	enum
+	{
+		CHUNK_SIZE = 16 ///< The width and height of a chunk in tiles
+	};
+
 	static std::shared_ptr<TmxMapRenderer>
 		create(void);
 
@@ -64,9 +70,15 @@ public:
 
 	inline int getMapHeight() const { return _mapHeight; }
 
-	inline int getMapWidthInPixels() const { return _mapWidth * _tileWidth; }
+	int getMapWidthInPixels() const;
+
+	int getMapHeightInPixels() const;
 
-	inline int getMapHeightInPixels() const { return _mapHeight * _tileHeight; }
+	/**
+	 * @brief Get the top left corner of the bounding box of a tile
+	 * cell in map space, for any orientation.
+	 */
+	Vec2 getTilePosition(int x, int y) const;
 
 	inline int getTileWidth() const { return _tileWidth; }
 
@@ -82,6 +94,15 @@ public:
 
 	void setCamera(const Rect& camera) { _camera = camera; }
 
+	/**
+	 * @brief Let the TextureResidency move the tilesets between VRAM
+	 * and linear RAM. The tilesets of the chunks around the camera are
+	 * prefetched, so they are promoted before being visible.
+	 */
+	void setStreamingEnabled(bool enabled);
+
+	inline bool isStreamingEnabled() const { return _streaming; }
+
 protected:
     struct Tile
     {
@@ -89,9 +110,42 @@ protected:
         short tilesetIndex;
     };
 
+    struct AnimatedTile
+    {
+        Uint32 quad;
+        short id;
+        short tilesetIndex;
+    };
+
+    /**
+     * @brief Consecutive quads of a chunk using the same tileset.
+     */
+    struct ChunkRun
+    {
+        Uint32 firstQuad;
+        Uint32 quads;
+        short tilesetIndex;
+    };
+
+    /**
+     * @brief A block of CHUNK_SIZE x CHUNK_SIZE tiles of a layer,
+     * built lazily the first time it is visible.
+     * The quads are stored back to front, see toChunkSpace().
+     */
+    struct Chunk
+    {
+        std::vector<SpriteBatch::Vertex> vertices;
+        std::vector<ChunkRun> runs;
+        std::vector<AnimatedTile> animatedTiles;
+        Color color;
+        Uint32 animationStamp;
+        bool dirty;
+    };
+
     struct Layer
     {
         std::vector<Tile> tiles;
+        std::vector<Chunk> chunks;
         byte opacity;
     };
 
@@ -128,11 +182,59 @@ protected:
     Uint16 _tileHeight;
     bool _loaded;
 	TmxMap::Orientation _type;
+	TmxMap::StaggerAxis _staggerAxis;
+	TmxMap::StaggerIndex _staggerIndex;
+	int _chunksX;
+	int _chunksY;
+	Uint16 _tilesOverhangX;
+	Uint16 _tilesOverhangY;
+	Uint32 _animationStamp;
+	bool _streaming;
 
     short getTileAnimId(const Tile& tile);
 
+    bool isStaggered(int index) const;
+
+    /**
+     * @brief Convert tile coordinates to chunk space, where drawing
+     * the tiles row by row draws them back to front.
+     * It matches the map coordinates for orthogonal and isometric maps
+     * while staggered maps are mapped to the equivalent isometric grid.
+     */
+    void toChunkSpace(int x, int y, int& u, int& v) const;
+
+    /**
+     * @brief Convert chunk space coordinates to tile coordinates.
+     * @return false if the tile is outside the map.
+     */
+    bool fromChunkSpace(int u, int v, int& x, int& y) const;
+
+    /**
+     * @brief Convert a map space position to fractional chunk
+     * space coordinates, with an error of less than one tile.
+     */
+    Vec2 pixelToChunkSpace(float x, float y) const;
+
+    Rect getTileTexCoords(Tileset& tileset, short id);
+
+    void buildChunk(Layer& layer, int chunkX, int chunkY, const Color& color);
+
+    void drawChunk(Chunk& chunk, const Affine2D& modelview);
+
+    void updateChunkColor(Chunk& chunk, const Color& color);
+
+    void updateChunkAnimations(Chunk& chunk);
+
+    /**
+     * @brief Prefetch the tilesets of the chunks in the ring around
+     * the given range of chunks, building them if needed.
+     */
+    void prefetchChunks(Layer& layer, int startX, int startY,
+        int endX, int endY, const Color& color);
+
     std::vector<std::unique_ptr<Tileset>> _tilesets;
     std::vector<Layer> _layers;
+    std::vector<Rect> _chunksBounds;
 };
 
 NS_KAIRY_END
@@ -0,0 +1,176 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <Kairy/Graphics/AtlasSprite.h>
+#include <Kairy/Graphics/RenderDevice.h>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+std::shared_ptr<AtlasSprite> AtlasSprite::create(void)
+{
+	return std::make_shared<AtlasSprite>();
+}
+
+//=============================================================================
+
+std::shared_ptr<AtlasSprite> AtlasSprite::create(const std::shared_ptr<TextureAtlas>& atlas,
+	const std::string& frame)
+{
+	auto sprite = std::make_shared<AtlasSprite>();
+
+	if (!sprite)
+	{
+		return nullptr;
+	}
+
+	sprite->setAtlas(atlas);
+
+	if (!sprite->setFrame(frame))
+	{
+		return nullptr;
+	}
+
+	return sprite;
+}
+
+//=============================================================================
+
+AtlasSprite::AtlasSprite(void)
+	: Sprite()
+	, _framePage(-1)
+{
+}
+
+//=============================================================================
+
+AtlasSprite::AtlasSprite(const std::shared_ptr<TextureAtlas>& atlas, const std::string& frame)
+	: Sprite()
+	, _atlas(atlas)
+	, _framePage(-1)
+{
+	setFrame(frame);
+}
+
+//=============================================================================
+
+AtlasSprite::~AtlasSprite()
+{
+}
+
+//=============================================================================
+
+void AtlasSprite::setAtlas(const std::shared_ptr<TextureAtlas>& atlas)
+{
+	if (_atlas == atlas)
+	{
+		return;
+	}
+
+	_atlas = atlas;
+
+	// The page index refers to the previous atlas
+	_framePage = -1;
+
+	if (!_frameName.empty())
+	{
+		setFrame(_frameName);
+	}
+}
+
+//=============================================================================
+
+bool AtlasSprite::setFrame(const std::string& name)
+{
+	const TextureAtlas::Frame* frame = _atlas ? _atlas->getFrame(name) : nullptr;
+
+	if (!frame)
+	{
+		return false;
+	}
+
+	if (frame->page != _framePage)
+	{
+		_texture = *_atlas->getPage(frame->page);
+		_framePage = frame->page;
+	}
+
+	_frameName = name;
+	_frameRect = frame->rect;
+	_frameOffset = frame->offset;
+	_frameSourceSize = frame->sourceSize;
+	_textureRect = frame->rect;
+
+	setSize(frame->sourceSize);
+	return true;
+}
+
+//=============================================================================
+
+void AtlasSprite::draw()
+{
+	if (!_device->isInitialized() || !_visible ||
+		_size.x == 0.0f || _size.y == 0.0f ||
+		_texture.getRealWidth() == 0 || _texture.getRealHeight() == 0)
+	{
+		return;
+	}
+
+	updateTransform();
+
+	if (_color.a > 0)
+	{
+		RenderCommand command;
+		command.texture = &_texture;
+
+		if (_textureRect == _frameRect && _frameSourceSize.x > 0.0f && _frameSourceSize.y > 0.0f)
+		{
+			// Place the trimmed pixels where they were in the full frame
+			Vec2 scale(_size.x / _frameSourceSize.x, _size.y / _frameSourceSize.y);
+
+			command.transform = getCombinedTransform() *
+				Affine2D::createTranslation(_frameOffset.x * scale.x, _frameOffset.y * scale.y);
+			command.size = Vec2(_frameRect.width * scale.x, _frameRect.height * scale.y);
+		}
+		else
+		{
+			command.transform = getCombinedTransform();
+			command.size = _size;
+		}
+
+		command.textureRect = _textureRect;
+		command.color = _color;
+		command.blendMode = _blendMode;
+		command.layer = _layer;
+		command.zOrder = _globalZOrder;
+
+		_device->submit(command);
+	}
+
+	Node::draw();
+}
+
+//=============================================================================
+
+NS_KAIRY_END
@@ -26,9 +26,7 @@
 #include <Kairy/Graphics/ShaderProgram.h>
 #include <Kairy/Graphics/RenderDevice.h>
 
-#ifdef _3DS
-#include "../3DS/VertexPool.h"
-#endif // _3DS
+#include "VertexPool.h"
 
 NS_KAIRY_BEGIN
 
@@ -53,24 +51,6 @@ CircleShape::CircleShape()
 {
 	_segments = 60;
 	setRadius(1.0f);
-
-#ifndef _3DS
-	glGenVertexArrays(1, &_vao);
-	glGenBuffers(1, &_vbo);
-
-	glBindVertexArray(_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 9 * MAX_SEGMENTS, nullptr, GL_DYNAMIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 9, 0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 9, (GLvoid*)(sizeof(float) * 3));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 9, (GLvoid*)(sizeof(float) * 7));
-	glEnableVertexAttribArray(2);
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-#endif // _3DS
 }
 
 //=============================================================================
@@ -90,7 +70,10 @@ void CircleShape::draw()
 
 	if (_color.a > 0)
 	{
-		ShaderProgram::setUniform(UNIFORM_MODELVIEW_NAME, getCombinedTransform());
+		// Shapes are drawn right away, after everything batched before
+		_device->flush();
+		ShaderProgram::setUniform(UniformHandle::Modelview, getCombinedTransform());
+		_device->setBlendMode(_blendMode);
 
 #ifdef _3DS
 
@@ -117,13 +100,7 @@ void CircleShape::draw()
 
 		//=========================================================================
 
-		GPU_SetTexEnv(0,
-			GPU_TEVSOURCES(GPU_CONSTANT, GPU_CONSTANT, GPU_CONSTANT),
-			GPU_TEVSOURCES(GPU_CONSTANT, GPU_CONSTANT, GPU_CONSTANT),
-			GPU_TEVOPERANDS(0, 0, 0),
-			GPU_TEVOPERANDS(0, 0, 0),
-			GPU_REPLACE, GPU_REPLACE,
-			_color.r | _color.g << 8 | _color.b << 16 | _color.a << 24);
+		_device->getRenderState().setColorCombiner(_color);
 
 		u32 bufferOffsets[] = { 0x00 };
 		u64 bufferPermutations[] = { 0x10 };
@@ -144,14 +121,8 @@ void CircleShape::draw()
 		GPU_DrawArray(GPU_TRIANGLE_FAN, 0, _segments + 2);
 
 #else
-		struct Vertex
-		{
-			Vec3 position;
-			Vec4 color;
-			Vec2 texcoord;
-		};
-
-		std::vector<Vertex> vertices(_segments + 2);
+		auto pool = VertexPool::getInstance();
+		auto vertices = pool->pushVertices<VertexPositionColorTexture>(_segments + 2);
 
 		Vec4 c = _color.toVector();
 
@@ -175,17 +146,12 @@ void CircleShape::draw()
 
 		vertices[_segments + 1] = vertices[1];
 
-		glUniform1i(ShaderProgram::getCurrentProgram()->
-			getUniformLocation("textureEnabled"), false);
+		GLint first = pool->commit();
 
-		glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex),
-			vertices.data());
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		_device->getRenderState().setColorCombiner(_color);
 
-		glBindVertexArray(_vao);
-		glDrawArrays(GL_TRIANGLE_FAN, 0, vertices.size());
-		glBindVertexArray(0);
+		pool->bindVertexArray();
+		glDrawArrays(GL_TRIANGLE_FAN, first, _segments + 2);
 #endif // _3DS
 	}
 
@@ -198,32 +164,11 @@ void CircleShape::updateTransform()
 {
 	if (_transformUpdated)
 	{
-		auto centerInPixels = _center * getSize()
-			- Vec2(_radius, _radius);
-
-		auto&& translation = Transform::createTranslation(_position);
-		auto&& scale = Transform::createScale(_scaleX, _scaleY);
-
-		if (_flipX)
-			scale.setValue(0, 0, scale.getValue(0, 0) * -1.0f);
-
-		if (_flipY)
-			scale.setValue(1, 1, scale.getValue(1, 1) * -1.0f);
-
-		auto&& rotation = Transform::createRotation(util::deg_to_rad(_angle));
-
-		auto&& rotScale =
-			Transform::createTranslation(centerInPixels) *
-			scale *
-			rotation *
-			Transform::createTranslation(-centerInPixels);
-
-		auto&& skew = Transform::createSkewX(util::deg_to_rad(_skewX)) *
-			Transform::createSkewY(util::deg_to_rad(_skewY));
-
-		_transform = translation * rotScale * skew;
-
+		_transform = composeTransform(_center * getSize()
+			- Vec2(_radius, _radius));
 		_transformUpdated = false;
+
+		invalidateWorldTransform();
 	}
 }
 
@@ -33,6 +33,9 @@ Drawable::Drawable(void)
 	: _device(RenderDevice::getInstance())
 	, _color(Color::White)
 	, _visible(true)
+	, _blendMode(BlendMode::Alpha)
+	, _layer(0)
+	, _globalZOrder(0)
 {
 }
 
@@ -23,12 +23,42 @@
 *****************************************************************************/
 
 #include <Kairy/Graphics/Emitter.h>
+#include <Kairy/Graphics/RenderDevice.h>
 #include <Kairy/System/Random.h>
+#include <Kairy/Util/Clamp.h>
+#include <Kairy/Util/Radians.h>
+#include <Kairy/Macros.h>
+
+#if defined(KAIRY_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(KAIRY_SIMD_NEON)
+#include <arm_neon.h>
+#endif
 
 NS_KAIRY_BEGIN
 
 //=============================================================================
 
+// The particles updated by every SIMD step
+static constexpr Uint32 PARTICLES_PER_STEP = 4;
+
+// The random values used to respawn a particle
+enum
+{
+	RANDOM_LIFE,
+	RANDOM_POSITION_X,
+	RANDOM_POSITION_Y,
+	RANDOM_VELOCITY_X,
+	RANDOM_VELOCITY_Y,
+	RANDOM_ROTATION,
+	RANDOM_ROTATION_SPEED,
+	RANDOM_SCALE,
+	RANDOM_TEXTURE_INDEX,
+	RANDOMS_PER_PARTICLE
+};
+
+//=============================================================================
+
 Emitter::Emitter(void)
 	: _duration(-1)
 	, _position(Vec2::Zero)
@@ -52,8 +82,8 @@ Emitter::Emitter(void)
 	, _endColor(Color::White)
 	, _textureIndex(-1)
 	, _textureIndexVar(0)
+	, _drawnParticles(0)
 {
-	_circleShape.setSegments(40);
 	_particles.resize(100);
 }
 
@@ -61,76 +91,338 @@ Emitter::Emitter(void)
 
 void Emitter::update(float dt)
 {
-	for (auto& particle : _particles)
+	integrateParticles(dt);
+	respawnParticles();
+}
+
+//=============================================================================
+
+void Emitter::integrateParticles(float dt)
+{
+	ParticleArrays& p = _particles;
+	Uint32 i = 0;
+
+	Vec4 start = _startColor.toVector();
+	Vec4 end = _endColor.toVector();
+	Vec4 range = end - start;
+
+	// Particles with no life left are respawned after the update
+	constexpr float minLife = 1e-6f;
+
+#if defined(KAIRY_SIMD_SSE2)
+	const __m128 vdt = _mm_set1_ps(dt);
+	const __m128 vgx = _mm_set1_ps(_gravity.x * dt);
+	const __m128 vgy = _mm_set1_ps(_gravity.y * dt);
+	const __m128 vminLife = _mm_set1_ps(minLife);
+	const __m128 vstart[] = { _mm_set1_ps(start.x), _mm_set1_ps(start.y), _mm_set1_ps(start.z), _mm_set1_ps(start.w) };
+	const __m128 vrange[] = { _mm_set1_ps(range.x), _mm_set1_ps(range.y), _mm_set1_ps(range.z), _mm_set1_ps(range.w) };
+	float* colors[] = { p.colorR.data(), p.colorG.data(), p.colorB.data(), p.colorA.data() };
+
+	for (; i + PARTICLES_PER_STEP <= p.count; i += PARTICLES_PER_STEP)
+	{
+		__m128 life = _mm_loadu_ps(&p.life[i]);
+		__m128 currentLife = _mm_loadu_ps(&p.currentLife[i]);
+		__m128 delta = _mm_div_ps(currentLife, _mm_max_ps(life, vminLife));
+
+		__m128 vx = _mm_add_ps(_mm_loadu_ps(&p.velocityX[i]), vgx);
+		__m128 vy = _mm_add_ps(_mm_loadu_ps(&p.velocityY[i]), vgy);
+		_mm_storeu_ps(&p.velocityX[i], vx);
+		_mm_storeu_ps(&p.velocityY[i], vy);
+		_mm_storeu_ps(&p.positionX[i], _mm_add_ps(_mm_loadu_ps(&p.positionX[i]), _mm_mul_ps(vx, vdt)));
+		_mm_storeu_ps(&p.positionY[i], _mm_add_ps(_mm_loadu_ps(&p.positionY[i]), _mm_mul_ps(vy, vdt)));
+
+		__m128 rotationSpeed = _mm_loadu_ps(&p.rotationSpeed[i]);
+		_mm_storeu_ps(&p.rotation[i], _mm_add_ps(_mm_loadu_ps(&p.rotation[i]), _mm_mul_ps(rotationSpeed, vdt)));
+		_mm_storeu_ps(&p.currentLife[i], _mm_add_ps(currentLife, vdt));
+
+		for (int c = 0; c < 4; ++c)
+		{
+			_mm_storeu_ps(&colors[c][i], _mm_add_ps(vstart[c], _mm_mul_ps(vrange[c], delta)));
+		}
+	}
+#elif defined(KAIRY_SIMD_NEON)
+	const float32x4_t vgx = vdupq_n_f32(_gravity.x * dt);
+	const float32x4_t vgy = vdupq_n_f32(_gravity.y * dt);
+	const float32x4_t vminLife = vdupq_n_f32(minLife);
+	const float32x4_t vstart[] = { vdupq_n_f32(start.x), vdupq_n_f32(start.y), vdupq_n_f32(start.z), vdupq_n_f32(start.w) };
+	const float32x4_t vrange[] = { vdupq_n_f32(range.x), vdupq_n_f32(range.y), vdupq_n_f32(range.z), vdupq_n_f32(range.w) };
+	float* colors[] = { p.colorR.data(), p.colorG.data(), p.colorB.data(), p.colorA.data() };
+
+	for (; i + PARTICLES_PER_STEP <= p.count; i += PARTICLES_PER_STEP)
 	{
-		updateParticle(particle, dt);
+		float32x4_t life = vmaxq_f32(vld1q_f32(&p.life[i]), vminLife);
+		float32x4_t currentLife = vld1q_f32(&p.currentLife[i]);
+
+		// No vector division, refine the reciprocal estimate twice
+		float32x4_t inverseLife = vrecpeq_f32(life);
+		inverseLife = vmulq_f32(vrecpsq_f32(life, inverseLife), inverseLife);
+		inverseLife = vmulq_f32(vrecpsq_f32(life, inverseLife), inverseLife);
+		float32x4_t delta = vmulq_f32(currentLife, inverseLife);
+
+		float32x4_t vx = vaddq_f32(vld1q_f32(&p.velocityX[i]), vgx);
+		float32x4_t vy = vaddq_f32(vld1q_f32(&p.velocityY[i]), vgy);
+		vst1q_f32(&p.velocityX[i], vx);
+		vst1q_f32(&p.velocityY[i], vy);
+		vst1q_f32(&p.positionX[i], vmlaq_n_f32(vld1q_f32(&p.positionX[i]), vx, dt));
+		vst1q_f32(&p.positionY[i], vmlaq_n_f32(vld1q_f32(&p.positionY[i]), vy, dt));
+
+		vst1q_f32(&p.rotation[i], vmlaq_n_f32(vld1q_f32(&p.rotation[i]), vld1q_f32(&p.rotationSpeed[i]), dt));
+		vst1q_f32(&p.currentLife[i], vaddq_f32(currentLife, vdupq_n_f32(dt)));
+
+		for (int c = 0; c < 4; ++c)
+		{
+			vst1q_f32(&colors[c][i], vmlaq_f32(vstart[c], vrange[c], delta));
+		}
+	}
+#endif
+
+	for (; i < p.count; ++i)
+	{
+		float delta = p.currentLife[i] / std::max(p.life[i], minLife);
+
+		p.velocityX[i] += _gravity.x * dt;
+		p.velocityY[i] += _gravity.y * dt;
+		p.positionX[i] += p.velocityX[i] * dt;
+		p.positionY[i] += p.velocityY[i] * dt;
+		p.rotation[i] += p.rotationSpeed[i] * dt;
+		p.currentLife[i] += dt;
+
+		p.colorR[i] = start.x + range.x * delta;
+		p.colorG[i] = start.y + range.y * delta;
+		p.colorB[i] = start.z + range.z * delta;
+		p.colorA[i] = start.w + range.w * delta;
 	}
 }
 
 //=============================================================================
 
-void Emitter::draw()
+void Emitter::respawnParticles()
 {
-	for (auto& particle : _particles)
+	ParticleArrays& p = _particles;
+
+	_respawned.clear();
+
+	for (Uint32 i = 0; i < p.count; ++i)
+	{
+		if (p.currentLife[i] >= p.life[i])
+		{
+			_respawned.push_back(i);
+		}
+	}
+
+	if (_respawned.empty())
 	{
-		drawParticle(particle);
+		return;
+	}
+
+	// Generate all the random values at once
+	_randoms.resize(_respawned.size() * RANDOMS_PER_PARTICLE);
+	Random::getInstance()->fill(_randoms.data(), (Uint32)_randoms.size(), -1.0f, 1.0f);
+
+	Vec4 color = _startColor.toVector();
+	const float* r = _randoms.data();
+
+	for (Uint32 i : _respawned)
+	{
+		p.life[i] = _lifeTime.asSeconds() + _lifeTimeVar.asSeconds() * r[RANDOM_LIFE];
+		p.currentLife[i] = 0.0f;
+		p.positionX[i] = _position.x + _positionVar.x * r[RANDOM_POSITION_X];
+		p.positionY[i] = _position.y + _positionVar.y * r[RANDOM_POSITION_Y];
+		p.velocityX[i] = _speed.x + _speedVar * r[RANDOM_VELOCITY_X];
+		p.velocityY[i] = _speed.y + _speedVar * r[RANDOM_VELOCITY_Y];
+		p.rotation[i] = _rotation + _rotationVar * r[RANDOM_ROTATION];
+		p.rotationSpeed[i] = _rotationSpeed + _rotationSpeedVar * r[RANDOM_ROTATION_SPEED];
+		p.scale[i] = _scale + _scaleVar * r[RANDOM_SCALE];
+		p.textureIndex[i] = _textureIndex + int(_textureIndexVar * r[RANDOM_TEXTURE_INDEX]);
+		p.colorR[i] = color.x;
+		p.colorG[i] = color.y;
+		p.colorB[i] = color.z;
+		p.colorA[i] = color.w;
+
+		r += RANDOMS_PER_PARTICLE;
 	}
 }
 
 //=============================================================================
 
-void Emitter::resetParticle(Particle& particle)
+void Emitter::ParticleArrays::resize(Uint32 newCount)
 {
-	auto random = Random::getInstance();
-	auto randomSign = [random]() {
-		return random->nextFloat() * (random->nextBoolean() ? 1.0f : -1.0f);
-	};
-
-	particle = Particle(Time::seconds(_lifeTime.asSeconds() + _lifeTimeVar.asSeconds() * randomSign()));
-
-	particle.setPosition(_position + _positionVar * randomSign());
-	particle.setRotation(_rotation + _rotationVar * randomSign());
-	particle.setRotationSpeed(_rotationSpeed + _rotationSpeedVar * randomSign());
-	particle.setScale(_scale + _scaleVar * randomSign());
-	particle.setTextureIndex(_textureIndex + int(_textureIndexVar * randomSign()));
-	particle.setVelocity(_speed + _speedVar * randomSign());
+	for (auto array : { &positionX, &positionY, &velocityX, &velocityY,
+		&life, &currentLife, &rotation, &rotationSpeed, &scale,
+		&colorR, &colorG, &colorB, &colorA })
+	{
+		array->resize(newCount, 0.0f);
+	}
+
+	textureIndex.resize(newCount, 0);
+
+	// The new particles have no life left and respawn on the next update
+	for (Uint32 i = count; i < newCount; ++i)
+	{
+		life[i] = 0.0f;
+		currentLife[i] = 0.0f;
+		scale[i] = 1.0f;
+	}
+
+	count = newCount;
 }
 
 //=============================================================================
 
-void Emitter::drawParticle(const Particle& particle)
+void Emitter::draw()
 {
+	_drawnParticles = 0;
+
+	if (!_device->isInitialized() || !_visible || _particles.count == 0)
+	{
+		return;
+	}
+
+	if (_textures.empty() && !createCircleTexture())
+	{
+		return;
+	}
+
+	// The particles are drawn as a single stream, everything
+	// submitted before must be drawn first
+	_device->flush();
+	_device->setBlendMode(_blendMode);
+
+	SpriteBatch* batch = _device->getSpriteBatch();
+
 	if (_textures.empty())
 	{
-		float delta = particle._curLife.asSeconds() / particle._life.asSeconds();
+		Uint32 quads = buildQuads(-1, Rect(0.0f, 0.0f,
+			(float)_circleTexture.getWidth(), (float)_circleTexture.getHeight()));
 
-		_circleShape.setPosition(particle.getPosition());
-		_circleShape.setRadius(_startSize + _endSize * delta);
-		_circleShape.setColor(particle.getColor());
-		_circleShape.setAngle(particle.getRotation());
-		_circleShape.setScale(particle.getScale());
+		batch->drawQuads(_circleTexture, _vertices.data(), quads);
+	}
+	else
+	{
+		// One draw for every texture in use
+		for (Uint32 i = 0; i < _textures.size(); ++i)
+		{
+			Uint32 quads = buildQuads(i, _textures[i]->getTextureRect());
 
-		_circleShape.draw();
+			batch->drawQuads(_textures[i]->getTexture(), _vertices.data(), quads);
+		}
 	}
 }
 
 //=============================================================================
 
-void Emitter::updateParticle(Particle& particle, float dt)
+void Emitter::addTexture(const std::string& filename, Texture::Location location)
 {
-	if (particle.getCurrentTime() >= particle.getLifeTime())
+	std::unique_ptr<Sprite> sprite(new Sprite());
+
+	if (sprite->loadTexture(filename, location))
 	{
-		resetParticle(particle);
+		_textures.push_back(std::move(sprite));
 	}
-	else
+}
+
+//=============================================================================
+
+void Emitter::addTexture(const byte* data, Uint32 dataSize, Texture::Location location)
+{
+	std::unique_ptr<Sprite> sprite(new Sprite());
+
+	if (sprite->loadTexture(data, dataSize, location))
+	{
+		_textures.push_back(std::move(sprite));
+	}
+}
+
+//=============================================================================
+
+void Emitter::addTexture(const byte* pixels, int width, int height, Texture::Location location)
+{
+	std::unique_ptr<Sprite> sprite(new Sprite());
+
+	if (sprite->loadTexture(pixels, width, height, PixelFormat::RGBA8, location))
+	{
+		_textures.push_back(std::move(sprite));
+	}
+}
+
+//=============================================================================
+
+bool Emitter::createCircleTexture()
+{
+	if (_circleTexture.getRealWidth() != 0)
+	{
+		return true;
+	}
+
+	constexpr int size = 64;
+	constexpr float radius = size * 0.5f;
+
+	std::vector<Color> pixels(size * size);
+
+	for (int y = 0; y < size; ++y)
 	{
-		float delta = particle._curLife.asSeconds() / particle._life.asSeconds();
+		for (int x = 0; x < size; ++x)
+		{
+			float dx = x + 0.5f - radius;
+			float dy = y + 0.5f - radius;
+
+			// One pixel of antialiasing on the border
+			float alpha = util::clamp(radius - std::sqrt(dx * dx + dy * dy), 0.0f, 1.0f);
 
-		particle._position += particle._velocity * dt;
-		particle._curLife = particle._curLife + Time::seconds(dt);
-		particle._rotation += particle._rotationSpeed * dt;
-		particle._color = _startColor.mix(_endColor, delta);
+			pixels[x + y * size] = Color(255, 255, 255, byte(alpha * 255.0f));
+		}
 	}
+
+	return _circleTexture.load((byte*)&pixels.front(), size, size);
+}
+
+//=============================================================================
+
+Uint32 Emitter::buildQuads(int textureIndex, const Rect& textureRect)
+{
+	Texture& texture = textureIndex < 0 ? _circleTexture :
+		_textures[textureIndex]->getTexture();
+
+	const ParticleArrays& p = _particles;
+	Rect texcoords = SpriteBatch::getTexCoords(texture, textureRect);
+	int lastTexture = int(_textures.size()) - 1;
+	Uint32 quads = 0;
+
+	_vertices.resize(p.count * SpriteBatch::VERTICES_PER_QUAD);
+
+	for (Uint32 i = 0; i < p.count; ++i)
+	{
+		if (textureIndex >= 0 &&
+			util::clamp(p.textureIndex[i], 0, lastTexture) != textureIndex)
+		{
+			continue;
+		}
+
+		float delta = p.life[i] > 0.0f ? p.currentLife[i] / p.life[i] : 0.0f;
+		float half = (_startSize + _endSize * delta) * p.scale[i];
+
+		// Only one sine and cosine for each particle
+		float angle = util::deg_to_rad(p.rotation[i]);
+		float c = std::cos(angle) * half;
+		float s = std::sin(angle) * half;
+
+		float x = p.positionX[i];
+		float y = p.positionY[i];
+
+		SpriteBatch::setQuad(&_vertices[quads * SpriteBatch::VERTICES_PER_QUAD],
+			Vec2(x - c + s, y - s - c),
+			Vec2(x + c + s, y + s - c),
+			Vec2(x - c - s, y - s + c),
+			Vec2(x + c - s, y + s + c),
+			texcoords,
+			Vec4(p.colorR[i], p.colorG[i], p.colorB[i], p.colorA[i]));
+
+		quads++;
+	}
+
+	_drawnParticles += quads;
+
+	return quads;
 }
 
 //=============================================================================
@@ -425,7 +425,23 @@ bool Font::loadTtf(const std::string& filename, float size, Texture::Location lo
 bool Font::loadTtf(const byte* buffer, float size, Texture::Location location)
 {
 	unload();
-	
+
+	std::vector<Image> pages;
+
+	if (!bakeTtf(buffer, size, pages))
+	{
+		return false;
+	}
+
+	loadPages(pages, location);
+
+	return true;
+}
+
+//=============================================================================
+
+bool Font::bakeTtf(const byte* buffer, float size, std::vector<Image>& outPages)
+{
 	if(!buffer)
 	{
 		return false;
@@ -436,7 +452,21 @@ bool Font::loadTtf(const byte* buffer, float size, Texture::Location location)
 	stbtt_fontinfo info;
 	stbtt_InitFont(&info, buffer, fontOffset);
 	
-	return loadStb(&info, size, location);
+	return bakeStb(&info, size, outPages);
+}
+
+//=============================================================================
+
+void Font::loadPages(const std::vector<Image>& pages, Texture::Location location)
+{
+	for (auto& pageImage : pages)
+	{
+		std::unique_ptr<Texture> page(new Texture());
+
+		pageImage.toTexture(*page);
+		page->changeLocation(location);
+		_pages.push_back(std::move(page));
+	}
 }
 
 //=============================================================================
@@ -449,6 +479,22 @@ bool Font::loadTtf(float size, Texture::Location location)
 //=============================================================================
 
 bool Font::loadStb(void* stb, float size, Texture::Location location)
+{
+	std::vector<Image> pages;
+
+	if (!bakeStb(stb, size, pages))
+	{
+		return false;
+	}
+
+	loadPages(pages, location);
+
+	return true;
+}
+
+//=============================================================================
+
+bool Font::bakeStb(void* stb, float size, std::vector<Image>& outPages)
 {
 	int pageWidth = 512;
 	int pageHeight = 512;
@@ -499,11 +545,8 @@ bool Font::loadStb(void* stb, float size, Texture::Location location)
 
 			if (y + _lineHeight >= pageHeight)
 			{
-				std::unique_ptr<Texture> page(new Texture());
-
-				pageImage.toTexture(*page);
+				outPages.push_back(pageImage);
 				pageImage.clear(Color::Transparent);
-				_pages.push_back(std::move(page));
 				y = 0;
 			}
 			else
@@ -534,7 +577,7 @@ bool Font::loadStb(void* stb, float size, Texture::Location location)
 
 		Character ch;
 
-		ch.page = (int)_pages.size();
+		ch.page = (int)outPages.size();
 		ch.height = height;
 		ch.width = width;
 		ch.x = x;
@@ -559,9 +602,7 @@ bool Font::loadStb(void* stb, float size, Texture::Location location)
 		x += width;
 	}
 
-	std::unique_ptr<Texture> page(new Texture());
-	pageImage.toTexture(*page);
-	_pages.push_back(std::move(page));
+	outPages.push_back(pageImage);
 
 	_base = maxWidth;
 
@@ -24,6 +24,7 @@
 
 #include <Kairy/Graphics/Image.h>
 #include <Kairy/Graphics/ImageLoader.h>
+#include <Kairy/Graphics/ImageOps.h>
 #include <Kairy/Graphics/Texture.h>
 #include <Kairy/Ext/hqx/hqx.h>
 #include <Kairy/Util/Radians.h>
@@ -579,7 +580,7 @@ bool Image::scaleHq4x(void)
 
 bool Image::scaleNearest(int newWidth, int newHeight)
 {
-    if(newWidth == 0 || newHeight == 0 || _pixels.size() == 0)
+    if(newWidth <= 0 || newHeight <= 0 || _pixels.size() == 0)
     {
         return false;
     }
@@ -591,24 +592,10 @@ bool Image::scaleNearest(int newWidth, int newHeight)
 
     std::vector<Color> newPixels(newWidth * newHeight);
 
-    float x_ratio = _width / (float)newWidth;
-    float y_ratio = _height / (float)newHeight;
-    float px, py;
-
-    for(int y = 0; y < newHeight; ++y)
-    {
-        for(int x = 0; x < newWidth; ++x)
-        {
-            px = std::floor(x * x_ratio);
-            py = std::floor(y * y_ratio);
-
-            newPixels[x + y * newWidth] = _pixels[int(px + py * _width)];
-        }
-    }
-
-    _pixels.resize(newWidth * newHeight);
-    std::copy(newPixels.begin(), newPixels.end(), _pixels.begin());
+    ImageOps::scaleNearest(&_pixels.front(), _width, _height,
+            &newPixels.front(), newWidth, newHeight);
 
+    _pixels.swap(newPixels);
     _width = newWidth;
     _height = newHeight;
 
@@ -624,44 +611,17 @@ bool Image::scaleBilinear(int newWidth, int newHeight)
 		return true;
 	}
 
-	if (_pixels.size() == 0)
+	if (newWidth <= 0 || newHeight <= 0 || _pixels.size() == 0)
 	{
 		return false;
 	}
 
 	std::vector<Color> newPixels(newWidth * newHeight);
 
-	float x_ratio = ((float)(_width - 1) / newWidth);
-	float y_ratio = ((float)(_height - 1) / newHeight);
-	Color a, b, c, d;
-	int x, y;
-	float w, h;
-
-	for (int i = 0; i < newWidth; ++i)
-	{
-		for (int j = 0; j < newHeight; ++j)
-		{
-			x = (int)(x_ratio * i);
-			y = (int)(y_ratio * j);
-
-			w = (x_ratio * i) - x;
-			h = (y_ratio * j) - y;
-
-			a = getPixel(x, y);
-			b = getPixel(x + 1, y);
-			c = getPixel(x, y + 1);
-			d = getPixel(x + 1, y + 1);
-
-			byte cr = (byte)(a.r * (1 - w) * (1 - h) + b.r * (w)* (1 - h) + c.r * (h)* (1 - w) + d.r * (w * h));
-			byte cg = (byte)(a.g * (1 - w) * (1 - h) + b.g * (w)* (1 - h) + c.g * (h)* (1 - w) + d.g * (w * h));
-			byte cb = (byte)(a.b * (1 - w) * (1 - h) + b.b * (w)* (1 - h) + c.b * (h)* (1 - w) + d.b * (w * h));
-
-			newPixels[i + j * newWidth] = Color(cr, cg, cb);
-		}
-	}
+	ImageOps::scaleBilinear(&_pixels.front(), _width, _height,
+		&newPixels.front(), newWidth, newHeight);
 
-	_pixels.resize(newWidth * newHeight);
-	std::copy(newPixels.begin(), newPixels.end(), _pixels.begin());
+	_pixels.swap(newPixels);
 	_width = newWidth;
 	_height = newHeight;
 
@@ -672,12 +632,9 @@ bool Image::scaleBilinear(int newWidth, int newHeight)
 
 bool Image::flipX()
 {
-	for (int x = 0; x < _width; ++x)
+	if (_pixels.size() > 0)
 	{
-		for (int y = 0; y < _height/2; ++y)
-		{
-			std::swap(_pixels[x + y * _width], _pixels[x + (_height - y - 1) * _width]);
-		}
+		ImageOps::flipRows(&_pixels.front(), _width, _height);
 	}
 
 	return true;
@@ -687,12 +644,9 @@ bool Image::flipX()
 
 bool Image::flipY()
 {
-	for (int x = 0; x < _width / 2; ++x)
+	if (_pixels.size() > 0)
 	{
-		for (int y = 0; y < _height; ++y)
-		{
-			std::swap(_pixels[x + y * _width], _pixels[_width - x - 1 + y * _width]);
-		}
+		ImageOps::flipColumns(&_pixels.front(), _width, _height);
 	}
 
 	return true;
@@ -721,26 +675,17 @@ bool Image::rotate(float angle)
 	float minX = std::min({ 0.0f, x1, x2, x3 });
 	float minY = std::min({ 0.0f, y1, y2, y3 });
 	float maxX = std::max({ x1, x2, x3 });
-	float maxY = std::max({ x1, y2, y3 });
+	float maxY = std::max({ y1, y2, y3 });
 
 	int newWidth = (int)std::ceil(std::fabs(maxX) - minX);
 	int newHeight = (int)std::ceil(std::fabs(maxY) - minY);
 
 	std::vector<Color> newPixels(newWidth * newHeight);
 
-	for (int x = 0; x < newWidth; ++x)
-	{
-		for (int y = 0; y < newHeight; ++y)
-		{
-			int srcX = (int)((x + minX) * cosine + (y + minY) * sine);
-			int srcY = (int)((y + minY) * cosine - (x + minX) * sine);
-
-			newPixels[x + y * newWidth] = getPixel(srcX, srcY);
-		}
-	}
+	ImageOps::rotate(&_pixels.front(), _width, _height, cosine, sine, minX, minY,
+		&newPixels.front(), newWidth, newHeight);
 
-	_pixels.resize(newPixels.size());
-	std::copy(newPixels.begin(), newPixels.end(), _pixels.begin());
+	_pixels.swap(newPixels);
 	_width = newWidth;
 	_height = newHeight;
 
@@ -751,9 +696,9 @@ bool Image::rotate(float angle)
 
 void Image::invertColors()
 {
-	for (auto& pixel : _pixels)
+	if (_pixels.size() > 0)
 	{
-		pixel = Color(255 - pixel.r, 255 - pixel.g, 255 - pixel.b, pixel.a);
+		ImageOps::invertColors(&_pixels.front(), (Uint32)_pixels.size());
 	}
 }
 
@@ -768,21 +713,21 @@ void Image::drawImage(int x, int y, const Image& image)
 
 void Image::drawImage(int x, int y, const Image& image, const Rect& source)
 {
-	int startX = (int)source.getLeft();
-	int startY = (int)source.getTop();
-	int endX = (int)source.getRight();
-	int endY = (int)source.getBottom();
-	Color pixel, result;
+	// The source pixels land at the same offset from (x, y),
+	// clipped to both images
+	int startX = std::max({ (int)source.getLeft(), 0, -x });
+	int startY = std::max({ (int)source.getTop(), 0, -y });
+	int endX = std::min({ (int)source.getRight(), image.getWidth(), _width - x });
+	int endY = std::min({ (int)source.getBottom(), image.getHeight(), _height - y });
 
-	for (int i = startX; i < endX; ++i)
+	if (startX >= endX || startY >= endY)
 	{
-		for (int j = startY; j < endY; ++j)
-		{
-			pixel = image.getPixel(i, j);
-			result = pixel.blend(getPixel(x + i, y + j));
-			setPixel(x + i, y + j, result);
-		}
+		return;
 	}
+
+	ImageOps::blend(&image._pixels[startX + startY * image._width], image._width,
+		&_pixels[x + startX + (y + startY) * _width], _width,
+		endX - startX, endY - startY);
 }
 
 //=============================================================================
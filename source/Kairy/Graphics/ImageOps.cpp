@@ -0,0 +1,468 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <Kairy/Graphics/ImageOps.h>
+#include <Kairy/System/Thread.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#if defined(KAIRY_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(KAIRY_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+int ImageOps::s_threadsCount = 1;
+
+// Fewer rows are not worth a thread
+static const int kMinBandRows = 32;
+
+// The even channels of a pixel, the odd ones once shifted by 8 bits
+static const Uint32 kEvenMask = 0x00FF00FF;
+
+//=============================================================================
+
+// Splits [0, count) in bands processed in parallel, the calling thread
+// processing the first one
+static void forEachBand(int count, int minBand, const std::function<void(int, int)>& func)
+{
+	int bands = std::min(ImageOps::getThreadsCount(), count / minBand);
+
+	if (bands <= 1)
+	{
+		func(0, count);
+		return;
+	}
+
+	std::vector<std::unique_ptr<Thread>> threads;
+
+	for (int band = 1; band < bands; ++band)
+	{
+		int first = count * band / bands;
+		int last = count * (band + 1) / bands;
+
+		threads.emplace_back(new Thread([&func, first, last](void*)
+		{
+			func(first, last);
+		}));
+
+		threads.back()->start();
+	}
+
+	func(0, count / bands);
+
+	for (auto& thread : threads)
+	{
+		thread->join();
+	}
+}
+
+//=============================================================================
+
+// Interpolates two pixels, two channels per 16 bits lane.
+// The weight of the second pixel is in [0, 256).
+static inline Uint32 lerpPixels(Uint32 a, Uint32 b, Uint32 weight)
+{
+	Uint32 inverse = 256 - weight;
+	Uint32 even = ((a & kEvenMask) * inverse + (b & kEvenMask) * weight) >> 8;
+	Uint32 odd = (a >> 8 & kEvenMask) * inverse + (b >> 8 & kEvenMask) * weight;
+
+	return (even & kEvenMask) | (odd & ~kEvenMask);
+}
+
+//=============================================================================
+
+static void lerpRows(const Uint32* row0, const Uint32* row1, Uint32 weight,
+	Uint32* outRow, int count)
+{
+	int i = 0;
+
+#if defined(KAIRY_SIMD_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i weight0 = _mm_set1_epi16((short)(256 - weight));
+	const __m128i weight1 = _mm_set1_epi16((short)weight);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(row0 + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(row1 + i));
+
+		__m128i lo = _mm_add_epi16(
+			_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), weight0),
+			_mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), weight1));
+		__m128i hi = _mm_add_epi16(
+			_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), weight0),
+			_mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), weight1));
+
+		_mm_storeu_si128((__m128i*)(outRow + i),
+			_mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+	}
+#elif defined(KAIRY_SIMD_NEON)
+	// A weight of 0 is a copy done by the caller, both weights fit a byte
+	const uint8x8_t weight0 = vdup_n_u8((uint8_t)(256 - weight));
+	const uint8x8_t weight1 = vdup_n_u8((uint8_t)weight);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		uint8x16_t a = vld1q_u8((const uint8_t*)(row0 + i));
+		uint8x16_t b = vld1q_u8((const uint8_t*)(row1 + i));
+
+		uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(a), weight0), vget_low_u8(b), weight1);
+		uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(a), weight0), vget_high_u8(b), weight1);
+
+		vst1q_u8((uint8_t*)(outRow + i), vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		outRow[i] = lerpPixels(row0[i], row1[i], weight);
+	}
+}
+
+//=============================================================================
+
+// Rounded division by 255 of a value up to 255 * 255
+static inline Uint32 div255(Uint32 value)
+{
+	value += 128;
+	return (value + (value >> 8)) >> 8;
+}
+
+//=============================================================================
+
+static inline void blendPixel(const byte* pixel, byte* outPixel)
+{
+	Uint32 alpha = pixel[3];
+	Uint32 weight = div255(outPixel[3] * (255 - alpha));
+
+	outPixel[0] = (byte)div255(pixel[0] * alpha + outPixel[0] * weight);
+	outPixel[1] = (byte)div255(pixel[1] * alpha + outPixel[1] * weight);
+	outPixel[2] = (byte)div255(pixel[2] * alpha + outPixel[2] * weight);
+	outPixel[3] = (byte)(alpha + weight);
+}
+
+//=============================================================================
+
+#if defined(KAIRY_SIMD_SSE2)
+static inline __m128i div255(__m128i value)
+{
+	value = _mm_add_epi16(value, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+}
+
+// Blends two pixels unpacked to 16 bits channels
+static inline __m128i blendPixels2(__m128i pixels, __m128i outPixels)
+{
+	const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+	const __m128i opaque = _mm_set1_epi16(255);
+
+	__m128i alpha = _mm_shufflehi_epi16(
+		_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	__m128i outAlpha = _mm_shufflehi_epi16(
+		_mm_shufflelo_epi16(outPixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+	__m128i weight = div255(_mm_mullo_epi16(outAlpha, _mm_sub_epi16(opaque, alpha)));
+	__m128i colors = div255(_mm_add_epi16(_mm_mullo_epi16(pixels, alpha),
+		_mm_mullo_epi16(outPixels, weight)));
+
+	return _mm_or_si128(_mm_andnot_si128(alphaMask, colors),
+		_mm_and_si128(alphaMask, _mm_add_epi16(alpha, weight)));
+}
+#elif defined(KAIRY_SIMD_NEON)
+static inline uint8x8_t div255(uint16x8_t value)
+{
+	value = vaddq_u16(value, vdupq_n_u16(128));
+	return vshrn_n_u16(vaddq_u16(value, vshrq_n_u16(value, 8)), 8);
+}
+#endif
+
+//=============================================================================
+
+static void blendRow(const Uint32* pixels, Uint32* outPixels, int count)
+{
+	int i = 0;
+
+#if defined(KAIRY_SIMD_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i src = _mm_loadu_si128((const __m128i*)(pixels + i));
+		__m128i dst = _mm_loadu_si128((const __m128i*)(outPixels + i));
+
+		__m128i lo = blendPixels2(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+		__m128i hi = blendPixels2(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+
+		_mm_storeu_si128((__m128i*)(outPixels + i), _mm_packus_epi16(lo, hi));
+	}
+#elif defined(KAIRY_SIMD_NEON)
+	// The channels are deinterleaved, 8 pixels at a time
+	for (; i + 8 <= count; i += 8)
+	{
+		uint8x8x4_t src = vld4_u8((const uint8_t*)(pixels + i));
+		uint8x8x4_t dst = vld4_u8((const uint8_t*)(outPixels + i));
+
+		uint8x8_t weight = div255(vmull_u8(dst.val[3], vmvn_u8(src.val[3])));
+
+		for (int c = 0; c < 3; ++c)
+		{
+			dst.val[c] = div255(vmlal_u8(vmull_u8(src.val[c], src.val[3]), dst.val[c], weight));
+		}
+
+		dst.val[3] = vadd_u8(src.val[3], weight);
+
+		vst4_u8((uint8_t*)(outPixels + i), dst);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		blendPixel((const byte*)(pixels + i), (byte*)(outPixels + i));
+	}
+}
+
+//=============================================================================
+
+// Maps the destination pixel centers to source coordinates with 8 bits of
+// fraction: the two source pixels and the weight of the second one
+static void getBilinearCoords(int size, int newSize, std::vector<int>& outFirst,
+	std::vector<int>& outSecond, std::vector<Uint32>& outWeights)
+{
+	outFirst.resize(newSize);
+	outSecond.resize(newSize);
+	outWeights.resize(newSize);
+
+	for (int i = 0; i < newSize; ++i)
+	{
+		int position = (int)((Uint64)(2 * i + 1) * size * 256 / (2 * newSize)) - 128;
+		position = std::max(0, position);
+
+		int first = position >> 8;
+		Uint32 weight = position & 0xFF;
+
+		if (first >= size - 1)
+		{
+			first = size - 1;
+			weight = 0;
+		}
+
+		outFirst[i] = first;
+		outSecond[i] = std::min(first + 1, size - 1);
+		outWeights[i] = weight;
+	}
+}
+
+//=============================================================================
+
+void ImageOps::setThreadsCount(int count)
+{
+	s_threadsCount = std::max(1, count);
+}
+
+//=============================================================================
+
+void ImageOps::scaleNearest(const Color* pixels, int width, int height,
+	Color* outPixels, int newWidth, int newHeight)
+{
+	const Uint32* src = (const Uint32*)pixels;
+	Uint32* dst = (Uint32*)outPixels;
+
+	std::vector<int> columns(newWidth);
+
+	for (int x = 0; x < newWidth; ++x)
+	{
+		columns[x] = (int)((Uint64)x * width / newWidth);
+	}
+
+	forEachBand(newHeight, kMinBandRows, [&](int first, int last)
+	{
+		int lastRow = -1;
+
+		for (int y = first; y < last; ++y)
+		{
+			int row = (int)((Uint64)y * height / newHeight);
+			Uint32* dstRow = dst + y * newWidth;
+
+			// Upscaled rows repeat the previous one
+			if (row == lastRow)
+			{
+				std::memcpy(dstRow, dstRow - newWidth, newWidth * sizeof(Uint32));
+				continue;
+			}
+
+			const Uint32* srcRow = src + row * width;
+
+			for (int x = 0; x < newWidth; ++x)
+			{
+				dstRow[x] = srcRow[columns[x]];
+			}
+
+			lastRow = row;
+		}
+	});
+}
+
+//=============================================================================
+
+void ImageOps::scaleBilinear(const Color* pixels, int width, int height,
+	Color* outPixels, int newWidth, int newHeight)
+{
+	const Uint32* src = (const Uint32*)pixels;
+	Uint32* dst = (Uint32*)outPixels;
+
+	std::vector<int> columns0, columns1, rows0, rows1;
+	std::vector<Uint32> columnWeights, rowWeights;
+
+	getBilinearCoords(width, newWidth, columns0, columns1, columnWeights);
+	getBilinearCoords(height, newHeight, rows0, rows1, rowWeights);
+
+	forEachBand(newHeight, kMinBandRows, [&](int first, int last)
+	{
+		std::vector<Uint32> blended(width);
+
+		for (int y = first; y < last; ++y)
+		{
+			// Blend the two source rows, then the columns of the result
+			const Uint32* row = src + rows0[y] * width;
+
+			if (rowWeights[y] != 0)
+			{
+				lerpRows(row, src + rows1[y] * width, rowWeights[y], blended.data(), width);
+				row = blended.data();
+			}
+
+			Uint32* dstRow = dst + y * newWidth;
+
+			for (int x = 0; x < newWidth; ++x)
+			{
+				dstRow[x] = lerpPixels(row[columns0[x]], row[columns1[x]], columnWeights[x]);
+			}
+		}
+	});
+}
+
+//=============================================================================
+
+void ImageOps::flipRows(Color* pixels, int width, int height)
+{
+	forEachBand(height / 2, kMinBandRows, [&](int first, int last)
+	{
+		for (int y = first; y < last; ++y)
+		{
+			Color* top = pixels + y * width;
+			std::swap_ranges(top, top + width, pixels + (height - y - 1) * width);
+		}
+	});
+}
+
+//=============================================================================
+
+void ImageOps::flipColumns(Color* pixels, int width, int height)
+{
+	forEachBand(height, kMinBandRows, [&](int first, int last)
+	{
+		for (int y = first; y < last; ++y)
+		{
+			Uint32* row = (Uint32*)pixels + y * width;
+			std::reverse(row, row + width);
+		}
+	});
+}
+
+//=============================================================================
+
+void ImageOps::rotate(const Color* pixels, int width, int height,
+	float cosine, float sine, float originX, float originY,
+	Color* outPixels, int newWidth, int newHeight)
+{
+	const Uint32* src = (const Uint32*)pixels;
+	Uint32* dst = (Uint32*)outPixels;
+
+	Uint32 transparent;
+	std::memcpy(&transparent, (const void*)&Color::Transparent, sizeof(transparent));
+
+	forEachBand(newHeight, kMinBandRows, [&](int first, int last)
+	{
+		for (int y = first; y < last; ++y)
+		{
+			float rowX = (y + originY) * sine;
+			float rowY = (y + originY) * cosine;
+			Uint32* dstRow = dst + y * newWidth;
+
+			for (int x = 0; x < newWidth; ++x)
+			{
+				float column = x + originX;
+				int srcX = (int)(column * cosine + rowX);
+				int srcY = (int)(rowY - column * sine);
+
+				if ((unsigned)srcX < (unsigned)width && (unsigned)srcY < (unsigned)height)
+					dstRow[x] = src[srcX + srcY * width];
+				else
+					dstRow[x] = transparent;
+			}
+		}
+	});
+}
+
+//=============================================================================
+
+void ImageOps::invertColors(Color* pixels, Uint32 count)
+{
+	Uint32 mask;
+	Color colors(255, 255, 255, 0);
+	std::memcpy(&mask, (const void*)&colors, sizeof(mask));
+
+	forEachBand((int)count, kMinBandRows * 1024, [&](int first, int last)
+	{
+		Uint32* texels = (Uint32*)pixels;
+
+		for (int i = first; i < last; ++i)
+		{
+			texels[i] ^= mask;
+		}
+	});
+}
+
+//=============================================================================
+
+void ImageOps::blend(const Color* pixels, int pitch, Color* outPixels, int outPitch,
+	int width, int height)
+{
+	forEachBand(height, kMinBandRows, [&](int first, int last)
+	{
+		for (int y = first; y < last; ++y)
+		{
+			blendRow((const Uint32*)pixels + y * pitch, (Uint32*)outPixels + y * outPitch, width);
+		}
+	});
+}
+
+//=============================================================================
+
+NS_KAIRY_END
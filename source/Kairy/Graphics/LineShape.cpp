@@ -26,9 +26,7 @@
 #include <Kairy/Graphics/ShaderProgram.h>
 #include <Kairy/Graphics/RenderDevice.h>
 
-#ifdef _3DS
-#include "../3DS/VertexPool.h"
-#endif // _3DS
+#include "VertexPool.h"
 
 NS_KAIRY_BEGIN
 
@@ -59,24 +57,6 @@ LineShape::LineShape(void) :
 	Shape()
 {
 	_thickness = 1.0f;
-
-#ifndef _3DS
-	glGenVertexArrays(1, &_vao);
-	glGenBuffers(1, &_vbo);
-
-	glBindVertexArray(_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 36, nullptr, GL_DYNAMIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 9, 0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 9, (GLvoid*)(sizeof(float) * 3));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 9, (GLvoid*)(sizeof(float) * 7));
-	glEnableVertexAttribArray(2);
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-#endif // _3DS
 }
 
 //=============================================================================
@@ -91,31 +71,10 @@ inline void LineShape::updateTransform()
 {
 	if (_transformUpdated)
 	{
-		auto centerInPixels = _center * (_start + _end);
-
-		auto&& translation = Transform::createTranslation(_position);
-		auto&& scale = Transform::createScale(_scaleX, _scaleY);
-
-		if (_flipX)
-			scale.setValue(0, 0, scale.getValue(0, 0) * -1.0f);
-
-		if (_flipY)
-			scale.setValue(1, 1, scale.getValue(1, 1) * -1.0f);
-
-		auto&& rotation = Transform::createRotation(util::deg_to_rad(_angle));
-
-		auto&& rotScale =
-			Transform::createTranslation(centerInPixels) *
-			scale *
-			rotation *
-			Transform::createTranslation(-centerInPixels);
-
-		auto&& skew = Transform::createSkewX(util::deg_to_rad(_skewX)) *
-			Transform::createSkewY(util::deg_to_rad(_skewY));
-
-		_transform = translation * rotScale * skew;
-
+		_transform = composeTransform(_center * (_start + _end));
 		_transformUpdated = false;
+
+		invalidateWorldTransform();
 	}
 }
 
@@ -130,7 +89,10 @@ void LineShape::draw()
 
 	if (_color.a > 0)
 	{
-		ShaderProgram::setUniform(UNIFORM_MODELVIEW_NAME, getCombinedTransform());
+		// Shapes are drawn right away, after everything batched before
+		_device->flush();
+		ShaderProgram::setUniform(UniformHandle::Modelview, getCombinedTransform());
+		_device->setBlendMode(_blendMode);
 
 #ifdef _3DS
 
@@ -149,13 +111,7 @@ void LineShape::draw()
 
 		//=========================================================================
 
-		GPU_SetTexEnv(0,
-			GPU_TEVSOURCES(GPU_CONSTANT, GPU_CONSTANT, GPU_CONSTANT),
-			GPU_TEVSOURCES(GPU_CONSTANT, GPU_CONSTANT, GPU_CONSTANT),
-			GPU_TEVOPERANDS(0, 0, 0),
-			GPU_TEVOPERANDS(0, 0, 0),
-			GPU_REPLACE, GPU_REPLACE,
-			_color.r | _color.g << 8 | _color.b << 16 | _color.a << 24);
+		_device->getRenderState().setColorCombiner(_color);
 
 		u32 bufferOffsets[] = { 0x00 };
 		u64 bufferPermutations[] = { 0x10 };
@@ -176,29 +132,31 @@ void LineShape::draw()
 		GPU_DrawArray(GPU_TRIANGLE_STRIP, 0, 4);
 
 #else
+		auto pool = VertexPool::getInstance();
+		auto vertices = pool->pushVertices<VertexPositionColorTexture>(2);
+
 		Vec4 c = _color.toVector();
 
-		float vertices[] =
+		vertices[0].position = Vec3(_start.x, _start.y, -0.5f);
+		vertices[1].position = Vec3(_end.x, _end.y, -0.5f);
+
+		for (int i = 0; i < 2; ++i)
 		{
-			_start.x, _start.y, -0.5f, c.x, c.y, c.z, c.w, 0, 0,
-			_end.x, _end.y, -0.5f, c.x, c.y, c.z, c.w, 0, 0
-		};
+			vertices[i].color = c;
+			vertices[i].texcoord = Vec2::Zero;
+		}
 
-		glUniform1i(ShaderProgram::getCurrentProgram()->
-			getUniformLocation("textureEnabled"), false);
+		GLint first = pool->commit();
 
-		glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * 18, vertices);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		_device->getRenderState().setColorCombiner(_color);
 
 		float prevThickness = 0.0f;
 
 		glGetFloatv(GL_LINE_WIDTH, &prevThickness);
 		glLineWidth(_thickness);
 
-		glBindVertexArray(_vao);
-		glDrawArrays(GL_LINES, 0, 2);
-		glBindVertexArray(0);
+		pool->bindVertexArray();
+		glDrawArrays(GL_LINES, first, 2);
 
 		glLineWidth(prevThickness);
 
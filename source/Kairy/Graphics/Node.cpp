@@ -28,8 +28,15 @@ NS_KAIRY_BEGIN
 
 //=============================================================================
 
+bool Node::s_culling = false;
+Rect Node::s_cullRect;
+CullingStats Node::s_cullingStats = { 0, 0, 0 };
+
+//=============================================================================
+
 Node::Node()
 	: _transformUpdated(true)
+	, _worldTransformDirty(true)
 	, _position(Vec2::Zero)
 	, _size(Vec2::Zero)
 	, _scaleX(1.0f)
@@ -40,17 +47,19 @@ Node::Node()
 	, _flipX(false)
 	, _flipY(false)
 	, _center(Vec2::Middle)
+	, _tag(-1)
 	, _userdata(nullptr)
 	, _zOrder(-1)
 	, _addCounter(0)
+	, _childrenOrderDirty(false)
 	, _parent(nullptr)
 	, _scene(nullptr)
 	, _touchEnabled(false)
 	, _touchCallback(nullptr)
-#ifndef _3DS
-	, _vao(0)
-	, _vbo(0)
-#endif // _3DS
+	, _cullable(false)
+	, _cullingEnabled(true)
+	, _hasSubtreeBounds(false)
+	, _boundsStamp(0)
 {
 }
 
@@ -60,17 +69,8 @@ Node::~Node()
 {
 	removeFromParent();
 
-#ifndef _3DS
-	if (_vao != 0)
-	{
-		glDeleteVertexArrays(1, &_vao);
-	}
-
-	if (_vbo != 0)
-	{
-		glDeleteBuffers(1, &_vbo);
-	}
-#endif // _3DS
+	// The children released with this node must not reach back to it
+	Node::clearChildren();
 }
 
 //=============================================================================
@@ -79,31 +79,55 @@ void Node::updateTransform()
 {
 	if (_transformUpdated)
 	{
-		auto centerInPixels = _center * _size;
-
-		auto&& translation = Transform::createTranslation(_position);
-		auto&& scale = Transform::createScale(_scaleX, _scaleY);
-
-		if (_flipX)
-			scale.setValue(0, 0, scale.getValue(0, 0) * -1.0f);
+		_transform = composeTransform(_center * _size);
+		_transformUpdated = false;
 
-		if (_flipY)
-			scale.setValue(1, 1, scale.getValue(1, 1) * -1.0f);
+		// The world transform may have been read in between
+		invalidateWorldTransform();
+	}
+}
 
-		auto&& rotation = Transform::createRotation(util::deg_to_rad(_angle));
+//=============================================================================
 
-		auto&& rotScale =
-			Transform::createTranslation(centerInPixels) *
-			scale *
-			rotation *
-			Transform::createTranslation(-centerInPixels);
+Affine2D Node::composeTransform(const Vec2& pivot) const
+{
+	// translation * pivot * scale * rotation * -pivot * skewX * skewY
+	// expanded by hand, the result is always a 2D affine transform
+	float radians = util::deg_to_rad(_angle);
+	float cos = std::cos(radians);
+	float sin = std::sin(radians);
+
+	float scaleX = _flipX ? -_scaleX : _scaleX;
+	float scaleY = _flipY ? -_scaleY : _scaleY;
+
+	float m00 = scaleX * cos;
+	float m01 = -scaleX * sin;
+	float m10 = scaleY * sin;
+	float m11 = scaleY * cos;
+
+	float skewX = (_skewX != 0.0f) ? std::tan(util::deg_to_rad(_skewX)) : 0.0f;
+	float skewY = (_skewY != 0.0f) ? std::tan(util::deg_to_rad(_skewY)) : 0.0f;
+	float skewXY = 1.0f + skewX * skewY;
+
+	return Affine2D(
+		m00 * skewXY + m01 * skewY,
+		m00 * skewX + m01,
+		m10 * skewXY + m11 * skewY,
+		m10 * skewX + m11,
+		_position.x + pivot.x - (m00 * pivot.x + m01 * pivot.y),
+		_position.y + pivot.y - (m10 * pivot.x + m11 * pivot.y));
+}
 
-		auto&& skew = Transform::createSkewX(util::deg_to_rad(_skewX)) *
-			Transform::createSkewY(util::deg_to_rad(_skewY));
+//=============================================================================
 
-		_transform = translation * rotScale * skew;
+void Node::invalidateSubtree()
+{
+	_worldTransformDirty = true;
+	_boundsStamp++;
 
-		_transformUpdated = false;
+	for (auto& child : _children)
+	{
+		child->invalidateWorldTransform();
 	}
 }
 
@@ -118,41 +142,136 @@ void Node::addChild(const std::shared_ptr<Node>& child)
 
 void Node::addChild(const std::shared_ptr<Node>& child, int zOrder)
 {
-	_children.push_back(child);
-	_children.back()->_parent = this;
-	_children.back()->_zOrder = zOrder;
-	
-	sortByZOrder();
+	child->_zOrder = zOrder;
+	attachChild(_children, child);
 }
 
 //=============================================================================
 
 void Node::addChild(const std::shared_ptr<Node>& child, int zOrder, int tag)
 {
-	_children.push_back(child);
-	_children.back()->_parent = this;
-	_children.back()->_zOrder = zOrder;
-	_children.back()->_tag = tag;
-
-	sortByZOrder();
+	child->_zOrder = zOrder;
+	child->_tag = tag;
+	attachChild(_children, child);
 }
 
 //=============================================================================
 
 void Node::addChild(const std::shared_ptr<Node>& child, int zOrder, const std::string & name)
 {
-	_children.push_back(child);
-	_children.back()->_parent = this;
-	_children.back()->_zOrder = zOrder;
-	_children.back()->_name = name;
+	child->_zOrder = zOrder;
+	child->_name = name;
+	attachChild(_children, child);
+}
 
-	sortByZOrder();
+//=============================================================================
+
+void Node::addChildren(const std::vector<std::shared_ptr<Node>>& children)
+{
+	attachChildren(_children, children, _addCounter);
+}
+
+//=============================================================================
+
+void Node::attachChild(std::vector<std::shared_ptr<Node>>& children,
+	const std::shared_ptr<Node>& child)
+{
+	child->setParent(this);
+	indexChild(child.get());
+
+	// A list waiting for its sort takes the child at the end
+	if (_childrenOrderDirty)
+	{
+		children.push_back(child);
+		return;
+	}
+
+	// Past the children with the same z-order, as a stable sort would do,
+	// so adding with increasing z-orders only appends
+	auto it = std::upper_bound(children.begin(), children.end(), child->_zOrder,
+		[](int zOrder, const std::shared_ptr<Node>& other)
+	{
+		return zOrder < other->_zOrder;
+	});
+
+	children.insert(it, child);
+}
+
+//=============================================================================
+
+void Node::attachChildren(std::vector<std::shared_ptr<Node>>& children,
+	const std::vector<std::shared_ptr<Node>>& added, int& addCounter)
+{
+	auto size = children.size();
+	children.reserve(size + added.size());
+
+	for (auto& child : added)
+	{
+		child->_zOrder = addCounter++;
+		child->setParent(this);
+		indexChild(child.get());
+		children.push_back(child);
+	}
+
+	// Both ranges are sorted, the merge is linear
+	if (!_childrenOrderDirty)
+	{
+		std::inplace_merge(children.begin(), children.begin() + size, children.end(),
+			[](const std::shared_ptr<Node>& a, const std::shared_ptr<Node>& b)
+		{
+			return a->_zOrder < b->_zOrder;
+		});
+	}
+}
+
+//=============================================================================
+
+void Node::compactChildren(std::vector<std::shared_ptr<Node>>& children,
+	const std::function<bool(Node*)>& predicate)
+{
+	// Kept alive until they are all out of the list
+	std::vector<std::shared_ptr<Node>> removed;
+	Uint32 kept = 0;
+
+	for (Uint32 i = 0; i < children.size(); ++i)
+	{
+		if (predicate(children[i].get()))
+		{
+			removed.push_back(std::move(children[i]));
+		}
+		else
+		{
+			if (kept != i)
+				children[kept] = std::move(children[i]);
+
+			kept++;
+		}
+	}
+
+	children.erase(children.begin() + kept, children.end());
+
+	for (auto& child : removed)
+	{
+		child->setParent(nullptr);
+	}
 }
 
 //=============================================================================
 
 Node* Node::getChildByName(const std::string& name) const
 {
+	auto range = _childrenByName.equal_range(name);
+
+	// The unnamed children aren't in the table
+	if (!name.empty())
+	{
+		if (range.first == range.second)
+			return nullptr;
+
+		if (std::next(range.first) == range.second)
+			return range.first->second;
+	}
+
 	for(auto& child : _children)
 	{
 		if(child->getName() == name)
@@ -166,6 +285,17 @@ Node* Node::getChildByName(const std::string& name) const
 
 Node* Node::getChildByTag(int tag) const
 {
+	auto range = _childrenByTag.equal_range(tag);
+
+	if (tag != -1)
+	{
+		if (range.first == range.second)
+			return nullptr;
+
+		if (std::next(range.first) == range.second)
+			return range.first->second;
+	}
+
 	for(auto& child : _children)
 	{
 		if(child->getTag() == tag)
@@ -179,36 +309,27 @@ Node* Node::getChildByTag(int tag) const
 
 void Node::removeChildByTag(int tag)
 {
-	std::vector<Uint32> toRemove;
-	
-	for(Uint32 i = 0; i < _children.size(); ++i)
-	{
-		if(_children[i]->getTag() == tag)
-			toRemove.push_back(i);
-	}
-	
-	for(auto& index : toRemove)
+	// The tag table knows when there is nothing to remove
+	if (tag != -1 && _childrenByTag.find(tag) == _childrenByTag.end())
+		return;
+
+	removeChildrenIf([tag](Node* child)
 	{
-		_children.erase(_children.begin() + index);
-	}
+		return child->getTag() == tag;
+	});
 }
 
 //=============================================================================
 
 void Node::removeChildByName(const std::string& name)
 {
-	std::vector<Uint32> toRemove;
-	
-	for(Uint32 i = 0; i < _children.size(); ++i)
-	{
-		if(_children[i]->getName() == name)
-			toRemove.push_back(i);
-	}
-	
-	for(auto& index : toRemove)
+	if (!name.empty() && _childrenByName.find(name) == _childrenByName.end())
+		return;
+
+	removeChildrenIf([&name](Node* child)
 	{
-		_children.erase(_children.begin() + index);
-	}
+		return child->getName() == name;
+	});
 }
 
 //=============================================================================
@@ -219,7 +340,12 @@ void Node::removeChild(Node* node)
 	{
 		if(_children[i].get() == node)
 		{
+			// Keep the child alive until it is out of the list
+			auto child = _children[i];
+
+			unindexChild(node);
 			_children.erase(_children.begin() + i);
+			child->setParent(nullptr);
 			break;
 		}
 	}
@@ -227,12 +353,71 @@ void Node::removeChild(Node* node)
 
 //=============================================================================
 
+void Node::removeChildrenIf(const std::function<bool(Node*)>& predicate)
+{
+	compactChildren(_children, predicate);
+	reindexChildren();
+}
+
+//=============================================================================
+
 void Node::removeFromParent()
 {
+	// The parent clears _parent and may release this node
 	if(_parent)
 	{
 		_parent->removeChild(this);
-		_parent = nullptr;
+	}
+}
+
+//=============================================================================
+
+void Node::indexChild(Node* child)
+{
+	if (!child->_name.empty())
+		_childrenByName.emplace(child->_name, child);
+
+	if (child->_tag != -1)
+		_childrenByTag.emplace(child->_tag, child);
+}
+
+//=============================================================================
+
+void Node::reindexChildren()
+{
+	_childrenByName.clear();
+	_childrenByTag.clear();
+
+	for (auto& child : _children)
+	{
+		indexChild(child.get());
+	}
+}
+
+//=============================================================================
+
+void Node::unindexChild(Node* child)
+{
+	auto names = _childrenByName.equal_range(child->_name);
+
+	for (auto it = names.first; it != names.second; ++it)
+	{
+		if (it->second == child)
+		{
+			_childrenByName.erase(it);
+			break;
+		}
+	}
+
+	auto tags = _childrenByTag.equal_range(child->_tag);
+
+	for (auto it = tags.first; it != tags.second; ++it)
+	{
+		if (it->second == child)
+		{
+			_childrenByTag.erase(it);
+			break;
+		}
 	}
 }
 
@@ -241,11 +426,89 @@ void Node::removeFromParent()
 void Node::draw()
 {
 	updateTransform();
+	sortChildren();
 
 	for(auto& child : _children)
 	{
-		child->draw();
+		child->visit();
+	}
+}
+
+//=============================================================================
+
+void Node::visit()
+{
+	if (!s_culling)
+	{
+		draw();
+		return;
+	}
+
+	updateTransform();
+
+	if (_hasSubtreeBounds &&
+		!s_cullRect.intersects(getCombinedTransform().transformRect(_subtreeBounds)))
+	{
+		s_cullingStats.culledSubtrees++;
+		return;
 	}
+
+	if (_cullable && _cullingEnabled && !s_cullRect.intersects(getBoundingBox()))
+	{
+		s_cullingStats.culled++;
+
+		// Hidden drawables don't draw their children either
+		if (isVisible())
+		{
+			Node::draw();
+		}
+
+		return;
+	}
+
+	s_cullingStats.drawn++;
+	draw();
+}
+
+//=============================================================================
+
+void Node::setSubtreeBounds(const Rect& bounds)
+{
+	_subtreeBounds = bounds;
+	_hasSubtreeBounds = true;
+	_boundsStamp++;
+}
+
+//=============================================================================
+
+void Node::clearSubtreeBounds()
+{
+	_hasSubtreeBounds = false;
+	_boundsStamp++;
+}
+
+//=============================================================================
+
+void Node::beginCulling(const Rect& view)
+{
+	s_cullRect = view;
+	s_culling = true;
+}
+
+//=============================================================================
+
+void Node::endCulling()
+{
+	s_culling = false;
+}
+
+//=============================================================================
+
+void Node::resetCullingStats()
+{
+	s_cullingStats.drawn = 0;
+	s_cullingStats.culled = 0;
+	s_cullingStats.culledSubtrees = 0;
 }
 
 //=============================================================================
@@ -422,8 +685,8 @@ Action* Node::getActionByTag(int tag)
 
 void Node::sortByZOrder()
 {
-	std::sort(_children.begin(), _children.end(),
-		[](std::shared_ptr<Node>& a, std::shared_ptr<Node>& b)
+	std::stable_sort(_children.begin(), _children.end(),
+		[](const std::shared_ptr<Node>& a, const std::shared_ptr<Node>& b)
 	{
 		return a->getZOrder() < b->getZOrder();
 	});
@@ -431,6 +694,17 @@ void Node::sortByZOrder()
 
 //=============================================================================
 
+void Node::sortChildren()
+{
+	if (_childrenOrderDirty)
+	{
+		sortByZOrder();
+		_childrenOrderDirty = false;
+	}
+}
+
+//=============================================================================
+
 
 void Node::runAction(const std::shared_ptr<Action>& action)
 {
@@ -26,9 +26,7 @@
 #include <Kairy/Graphics/ShaderProgram.h>
 #include <Kairy/Graphics/RenderDevice.h>
 
-#ifdef _3DS
-#include "../3DS/VertexPool.h"
-#endif // _3DS
+#include "VertexPool.h"
 
 NS_KAIRY_BEGIN
 
@@ -66,24 +64,6 @@ RectangleShape::RectangleShape(void)
 	: OutlinedShape()
 {
 	setOutlineColor(Color::Transparent);
-
-#ifndef _3DS
-	glGenVertexArrays(1, &_vao);
-	glGenBuffers(1, &_vbo);
-
-	glBindVertexArray(_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 36, nullptr, GL_DYNAMIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 9, 0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 9, (GLvoid*)(sizeof(float) * 3));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 9, (GLvoid*)(sizeof(float) * 7));
-	glEnableVertexAttribArray(2);
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-#endif // _3DS
 }
 
 //=============================================================================
@@ -103,7 +83,10 @@ void RectangleShape::draw()
 	
 	if (_color.a > 0)
 	{
-		ShaderProgram::setUniform(UNIFORM_MODELVIEW_NAME, getCombinedTransform());
+		// Shapes are drawn right away, after everything batched before
+		_device->flush();
+		ShaderProgram::setUniform(UniformHandle::Modelview, getCombinedTransform());
+		_device->setBlendMode(_blendMode);
 
 #ifdef _3DS
 
@@ -122,13 +105,7 @@ void RectangleShape::draw()
 
 		//=========================================================================
 
-		GPU_SetTexEnv(0,
-			GPU_TEVSOURCES(GPU_CONSTANT, GPU_CONSTANT, GPU_CONSTANT),
-			GPU_TEVSOURCES(GPU_CONSTANT, GPU_CONSTANT, GPU_CONSTANT),
-			GPU_TEVOPERANDS(0, 0, 0),
-			GPU_TEVOPERANDS(0, 0, 0),
-			GPU_REPLACE, GPU_REPLACE,
-			_color.r | _color.g << 8 | _color.b << 16 | _color.a << 24);
+		_device->getRenderState().setColorCombiner(_color);
 
 		u32 bufferOffsets[] = { 0x00 };
 		u64 bufferPermutations[] = { 0x10 };
@@ -149,26 +126,28 @@ void RectangleShape::draw()
 		GPU_DrawArray(GPU_TRIANGLE_STRIP, 0, 4);
 
 #else
+		auto pool = VertexPool::getInstance();
+		auto vertices = pool->pushVertices<VertexPositionColorTexture>(4);
+
 		Vec4 c = _color.toVector();
 
-		float vertices[] =
+		vertices[0].position = Vec3(0, 0, -0.5f);
+		vertices[1].position = Vec3(_size.x, 0, -0.5f);
+		vertices[2].position = Vec3(0, _size.y, -0.5f);
+		vertices[3].position = Vec3(_size.x, _size.y, -0.5f);
+
+		for (int i = 0; i < 4; ++i)
 		{
-			0, 0, -0.5f, c.x, c.y, c.z, c.w, 0, 0,
-			_size.x, 0, -0.5f, c.x, c.y, c.z, c.w, 0, 0,
-			0, _size.y, -0.5f, c.x, c.y, c.z, c.w, 0, 0,
-			_size.x, _size.y, -0.5f, c.x, c.y, c.z, c.w, 0, 0
-		};
-
-		glUniform1i(ShaderProgram::getCurrentProgram()->
-			getUniformLocation("textureEnabled"), false);
-
-		glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * 36, vertices);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-		glBindVertexArray(_vao);
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-		glBindVertexArray(0);
+			vertices[i].color = c;
+			vertices[i].texcoord = Vec2::Zero;
+		}
+
+		GLint first = pool->commit();
+
+		_device->getRenderState().setColorCombiner(_color);
+
+		pool->bindVertexArray();
+		glDrawArrays(GL_TRIANGLE_STRIP, first, 4);
 #endif // _3DS
 	}
 
@@ -2,12 +2,15 @@
 #include <Kairy/Macros.h>
 #include <Kairy/Graphics/ImageLoader.h>
 #include <Kairy/System/InputManager.h>
+#include <Kairy/System/AssetLoader.h>
+#include <Kairy/Graphics/TextureResidency.h>
 #include <Kairy/Scene/SceneManager.h>
 #include <Kairy/Util/Clamp.h>
 
+#include "VertexPool.h"
+
 #ifdef _3DS
 #include "base_vsh_shbin.h"
-#include "../3DS/VertexPool.h"
 #else
 #include <Kairy/Util/StringFormat.h>
 #include <thread>
@@ -57,6 +60,10 @@ RenderDevice::RenderDevice(void)
     ,_targetScreen(Screen::Top)
     ,_targetSide(Side::Left)
     ,_defaultProgram(nullptr)
+    ,_spriteBatch(nullptr)
+    ,_renderQueue(nullptr)
+    ,_renderQueueEnabled(true)
+    ,_blendMode(BlendMode::Alpha)
 #ifdef _3DS
     ,_frameBuffer(nullptr)
     ,_depthBuffer(nullptr)
@@ -75,7 +82,7 @@ RenderDevice::~RenderDevice()
 
 //=============================================================================
 
-bool RenderDevice::init(Uint32 cmd_size)
+bool RenderDevice::init(Uint32 cmd_size, Uint32 vertex_pool_size)
 {
     if(_initialized)
     {
@@ -207,6 +214,22 @@ bool RenderDevice::init(Uint32 cmd_size)
 
 #endif // _3DS
 
+	if (!VertexPool::getInstance()->init(vertex_pool_size))
+	{
+		destroy();
+		return false;
+	}
+
+	_spriteBatch.reset(new SpriteBatch());
+
+	if (!_spriteBatch || !_spriteBatch->init())
+	{
+		destroy();
+		return false;
+	}
+
+	_renderQueue.reset(new RenderQueue());
+
     _topProjection = Transform::createOrthographic(0.0f, TOP_SCREEN_WIDTH,
             0.0f, TOP_SCREEN_HEIGHT, 0.0f, 1.0f);
     _botProjection = Transform::createOrthographic(0.0f, BOTTOM_SCREEN_WIDTH,
@@ -266,6 +289,11 @@ void RenderDevice::swapBuffers()
 	_lastTime = _currentTime;
 
 	InputManager::getInstance()->update(_deltaTime);
+	AssetLoader::getInstance()->update();
+
+	// The GPU is done with the frame, the textures can move
+	TextureResidency::getInstance()->update();
+	ShaderProgram::resetUniformCounters();
 	
 	if(_quitOnStart)
 	{
@@ -341,12 +369,13 @@ void RenderDevice::startFrame(void)
 
 void RenderDevice::startFrame(ShaderProgram& program)
 {
-#ifdef _3DS
-    VertexPool::getInstance()->clear();
-#endif // _3DS
-
     if(!_initialized)
         return;
+
+    VertexPool::getInstance()->beginFrame();
+
+    _spriteBatch->begin();
+    _renderQueue->begin();
 	
 #ifdef _3DS
     GPUCMD_SetBufferOffset(0);
@@ -367,10 +396,6 @@ void RenderDevice::startFrame(ShaderProgram& program)
     GPUCMD_Add(GPUCMD_HEADER(0, 0x1, GPUREG_0062), tmp, 1);
     GPUCMD_Add(GPUCMD_HEADER(0, 0xF, GPUREG_0118), tmp, 1);
 
-    GPU_SetAlphaBlending(GPU_BLEND_ADD,
-            GPU_BLEND_ADD,
-            GPU_SRC_ALPHA, GPU_ONE_MINUS_SRC_ALPHA,
-            GPU_ONE, GPU_ZERO);
     GPU_SetAlphaTest(true, GPU_ALWAYS, 0x00);
 
     for(int i = 0; i < 6; ++i)
@@ -379,18 +404,24 @@ void RenderDevice::startFrame(ShaderProgram& program)
     }
 #endif // _3DS
 
+    // Whatever ran since the last frame may have changed the gpu state
+    _renderState.invalidate();
+
+    _blendMode = BlendMode::Alpha;
+    _renderState.setBlendMode(_blendMode);
+
     program.use();
 
     if(_targetScreen == Screen::Top)
     {
-        ShaderProgram::setUniform(UNIFORM_PROJECTION_NAME, _topProjection);
+        ShaderProgram::setUniform(UniformHandle::Projection, _topProjection);
     }
     else
     {
-        ShaderProgram::setUniform(UNIFORM_PROJECTION_NAME, _botProjection);
+        ShaderProgram::setUniform(UniformHandle::Projection, _botProjection);
     }
 
-    ShaderProgram::setUniform(UNIFORM_MODELVIEW_NAME, _defaultModelview);
+    ShaderProgram::setUniform(UniformHandle::Modelview, _defaultModelview);
 }
 
 //=============================================================================
@@ -400,12 +431,18 @@ void RenderDevice::endFrame()
     if(!_initialized)
         return;
 
+    flush();
+
+    VertexPool::getInstance()->endFrame();
+
 #ifdef _3DS
     GPU_FinishDrawing();
     GPUCMD_Finalize();
     GPUCMD_FlushAndRun(nullptr);
     gspWaitForP3D();
 
+    VertexPool::getInstance()->retireFrames();
+
     int width = getScreenWidth();
     int height = getScreenHeight();
     gfxScreen_t screen = (gfxScreen_t)_targetScreen;
@@ -503,6 +540,97 @@ ShaderProgram * RenderDevice::getDefaultShaderProgram()
 
 //=============================================================================
 
+void RenderDevice::submit(const RenderCommand& command)
+{
+	if (!_initialized || !command.texture)
+	{
+		return;
+	}
+
+	if (_renderQueueEnabled)
+	{
+		_renderQueue->submit(command);
+	}
+	else
+	{
+		setBlendMode(command.blendMode);
+		_spriteBatch->draw(*command.texture, command.transform, command.size,
+			command.textureRect, command.color);
+	}
+}
+
+//=============================================================================
+
+void RenderDevice::flush()
+{
+	if (_renderQueue)
+	{
+		_renderQueue->flush(*this);
+	}
+
+	if (_spriteBatch)
+	{
+		_spriteBatch->flush();
+	}
+}
+
+//=============================================================================
+
+Uint32 RenderDevice::getVertexPoolUsage() const
+{
+	return VertexPool::getInstance()->getLastFrameUsage();
+}
+
+//=============================================================================
+
+Uint32 RenderDevice::getVertexPoolHighWaterMark() const
+{
+	return VertexPool::getInstance()->getHighWaterMark();
+}
+
+//=============================================================================
+
+Uint32 RenderDevice::getVertexPoolCapacity() const
+{
+	return VertexPool::getInstance()->getCapacity();
+}
+
+//=============================================================================
+
+void RenderDevice::setRenderQueueEnabled(bool enable)
+{
+	if (_renderQueueEnabled != enable)
+	{
+		flush();
+		_renderQueueEnabled = enable;
+	}
+}
+
+//=============================================================================
+
+void RenderDevice::setBlendMode(BlendMode mode)
+{
+	if (_blendMode == mode)
+	{
+		return;
+	}
+
+	// The quads already batched must be drawn with the old blending
+	if (_spriteBatch)
+	{
+		_spriteBatch->flush();
+	}
+
+	_blendMode = mode;
+
+	if (_initialized)
+	{
+		_renderState.setBlendMode(mode);
+	}
+}
+
+//=============================================================================
+
 #ifdef _3DS
 void RenderDevice::setDummyTexEnv(u8 id)
 {
@@ -671,6 +799,10 @@ void RenderDevice::destroy(void)
 {
     if(_initialized)
     {
+		_renderQueue.reset();
+		_spriteBatch.reset();
+		VertexPool::getInstance()->destroy();
+
 #ifdef _3DS
 		gfxExit();
         vramFree(_frameBuffer);
@@ -0,0 +1,212 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <Kairy/Graphics/RenderQueue.h>
+#include <Kairy/Graphics/RenderDevice.h>
+#include <Kairy/Graphics/Texture.h>
+#include <Kairy/Util/Clamp.h>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+RenderQueue::RenderQueue(void)
+	: _executedCommands(0)
+	, _stateChanges(0)
+	, _stateChangesAvoided(0)
+	, _flushing(false)
+	, _stateSorting(false)
+{
+}
+
+//=============================================================================
+
+RenderQueue::~RenderQueue()
+{
+}
+
+//=============================================================================
+
+void RenderQueue::begin()
+{
+	_commands.clear();
+	_sortItems.clear();
+	_executedCommands = 0;
+	_stateChanges = 0;
+	_stateChangesAvoided = 0;
+}
+
+//=============================================================================
+
+void RenderQueue::submit(const RenderCommand& command)
+{
+	if (!command.texture)
+	{
+		return;
+	}
+
+	_commands.push_back(command);
+
+	if (!_commands.back().program)
+	{
+		_commands.back().program = ShaderProgram::getCurrentProgram();
+	}
+}
+
+//=============================================================================
+
+void RenderQueue::flush(RenderDevice& device)
+{
+	if (_flushing || _commands.empty())
+	{
+		return;
+	}
+
+	_flushing = true;
+
+	_states.clear();
+	_sortItems.resize(_commands.size());
+
+	for (Uint32 i = 0; i < _commands.size(); ++i)
+	{
+		_sortItems[i].key = createKey(_commands[i]);
+		_sortItems[i].index = i;
+	}
+
+	Uint32 unsortedChanges = countStateChanges(false);
+
+	std::sort(_sortItems.begin(), _sortItems.end(),
+		[](const SortItem& a, const SortItem& b)
+	{
+		return a.key < b.key || (a.key == b.key && a.index < b.index);
+	});
+
+	Uint32 sortedChanges = countStateChanges(true);
+
+	_stateChanges += sortedChanges;
+
+	if (unsortedChanges > sortedChanges)
+	{
+		_stateChangesAvoided += unsortedChanges - sortedChanges;
+	}
+
+	ShaderProgram* previousProgram = ShaderProgram::getCurrentProgram();
+	BlendMode previousBlendMode = device.getBlendMode();
+	SpriteBatch* batch = device.getSpriteBatch();
+
+	for (const SortItem& item : _sortItems)
+	{
+		RenderCommand& command = _commands[item.index];
+
+		if (command.program && command.program != ShaderProgram::getCurrentProgram())
+		{
+			command.program->use();
+		}
+
+		device.setBlendMode(command.blendMode);
+		batch->draw(*command.texture, command.transform, command.size,
+			command.textureRect, command.color);
+	}
+
+	batch->flush();
+
+	if (previousProgram && previousProgram != ShaderProgram::getCurrentProgram())
+	{
+		previousProgram->use();
+	}
+
+	device.setBlendMode(previousBlendMode);
+
+	_executedCommands += (Uint32)_commands.size();
+	_commands.clear();
+	_sortItems.clear();
+
+	_flushing = false;
+}
+
+//=============================================================================
+
+Uint32 RenderQueue::getStateId(const void* state)
+{
+	auto it = std::find(_states.begin(), _states.end(), state);
+
+	if (it != _states.end())
+	{
+		return Uint32(it - _states.begin());
+	}
+
+	_states.push_back(state);
+
+	return Uint32(_states.size() - 1);
+}
+
+//=============================================================================
+
+Uint64 RenderQueue::createKey(const RenderCommand& command)
+{
+	// | layer: 8 | z-order: 16 | program: 8 | blend: 4 | texture: 28 |
+	Uint64 layer = Uint64(util::clamp(command.layer + 128, 0, 0xFF));
+	Uint64 zOrder = Uint64(util::clamp(command.zOrder + 32768, 0, 0xFFFF));
+
+	// Without the state bits the submission index breaks the ties,
+	// so the painter's order holds inside a layer and z-order
+	if (!_stateSorting)
+	{
+		return (layer << 56) | (zOrder << 40);
+	}
+
+	Uint64 program = Uint64(std::min(getStateId(command.program), 0xFFu));
+	Uint64 blend = Uint64(command.blendMode) & 0xF;
+	Uint64 texture = Uint64(std::min(getStateId(command.texture->_pixels), 0xFFFFFFFu));
+
+	return (layer << 56) | (zOrder << 40) | (program << 32) | (blend << 28) | texture;
+}
+
+//=============================================================================
+
+Uint32 RenderQueue::countStateChanges(bool sorted) const
+{
+	Uint32 changes = 0;
+	const RenderCommand* last = nullptr;
+
+	for (Uint32 i = 0; i < _commands.size(); ++i)
+	{
+		const RenderCommand& command = _commands[sorted ? _sortItems[i].index : i];
+
+		if (!last || last->program != command.program)
+			changes++;
+		if (!last || last->blendMode != command.blendMode)
+			changes++;
+		if (!last || last->texture->_pixels != command.texture->_pixels)
+			changes++;
+
+		last = &command;
+	}
+
+	return changes;
+}
+
+//=============================================================================
+
+NS_KAIRY_END
@@ -0,0 +1,348 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <Kairy/Graphics/RenderState.h>
+#include <Kairy/Graphics/ShaderProgram.h>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+#ifdef _3DS
+// The LOD registers of the texture units, the max level is in bits 16-19
+static const u32 kTexUnitLodRegisters[RenderState::TEXTURE_UNITS] = { 0x084, 0x094, 0x09C };
+#else
+// No object has this name, what is bound is unknown
+static const GLuint kUnknownName = 0xFFFFFFFF;
+#endif // _3DS
+
+//=============================================================================
+
+RenderState::RenderState(void)
+{
+	invalidate();
+}
+
+//=============================================================================
+
+void RenderState::invalidate()
+{
+	_blendKnown = false;
+	_blendMode = BlendMode::Alpha;
+	_combiner = Combiner::Unknown;
+	_combinerColor = Color::White;
+
+#ifdef _3DS
+	for (auto& unit : _units)
+	{
+		unit.texels = nullptr;
+	}
+
+	_enabledUnits = -1;
+	_program = nullptr;
+#else
+	for (auto& unit : _units)
+	{
+		unit = kUnknownName;
+	}
+
+	_activeUnit = -1;
+	_vertexArray = kUnknownName;
+	_arrayBuffer = kUnknownName;
+	_program = kUnknownName;
+
+	// The parameters live in the texture objects, they can't be lost
+#endif // _3DS
+}
+
+//=============================================================================
+
+void RenderState::setBlendMode(BlendMode mode)
+{
+	if (_blendKnown && _blendMode == mode)
+	{
+		return;
+	}
+
+	_blendKnown = true;
+	_blendMode = mode;
+
+#ifdef _3DS
+	GPU_BLENDFACTOR src = GPU_SRC_ALPHA;
+	GPU_BLENDFACTOR dst = GPU_ONE_MINUS_SRC_ALPHA;
+
+	switch (mode)
+	{
+	case BlendMode::Additive: dst = GPU_ONE; break;
+	case BlendMode::Multiply: src = GPU_DST_COLOR; dst = GPU_ZERO; break;
+	case BlendMode::None: src = GPU_ONE; dst = GPU_ZERO; break;
+	default: break;
+	}
+
+	GPU_SetAlphaBlending(GPU_BLEND_ADD,
+		GPU_BLEND_ADD,
+		src, dst,
+		GPU_ONE, GPU_ZERO);
+#else
+	GLenum src = GL_SRC_ALPHA;
+	GLenum dst = GL_ONE_MINUS_SRC_ALPHA;
+
+	switch (mode)
+	{
+	case BlendMode::Additive: dst = GL_ONE; break;
+	case BlendMode::Multiply: src = GL_DST_COLOR; dst = GL_ZERO; break;
+	case BlendMode::None: src = GL_ONE; dst = GL_ZERO; break;
+	default: break;
+	}
+
+	glBlendFunc(src, dst);
+#endif // _3DS
+}
+
+//=============================================================================
+
+void RenderState::setTextureCombiner()
+{
+#ifdef _3DS
+	if (_combiner == Combiner::Texture)
+	{
+		return;
+	}
+
+	GPU_SetTexEnv(0,
+		GPU_TEVSOURCES(GPU_TEXTURE0, GPU_PRIMARY_COLOR, GPU_PRIMARY_COLOR),
+		GPU_TEVSOURCES(GPU_TEXTURE0, GPU_PRIMARY_COLOR, GPU_PRIMARY_COLOR),
+		GPU_TEVOPERANDS(0, 0, 0),
+		GPU_TEVOPERANDS(0, 0, 0),
+		GPU_MODULATE, GPU_MODULATE,
+		0xFFFFFFFF);
+#else
+	// The uniform is filtered by the program using it
+	ShaderProgram::setUniform(UniformHandle::TextureEnabled, true);
+#endif // _3DS
+
+	_combiner = Combiner::Texture;
+}
+
+//=============================================================================
+
+void RenderState::setColorCombiner(const Color& color)
+{
+#ifdef _3DS
+	if (_combiner == Combiner::Color && _combinerColor == color)
+	{
+		return;
+	}
+
+	GPU_SetTexEnv(0,
+		GPU_TEVSOURCES(GPU_CONSTANT, GPU_CONSTANT, GPU_CONSTANT),
+		GPU_TEVSOURCES(GPU_CONSTANT, GPU_CONSTANT, GPU_CONSTANT),
+		GPU_TEVOPERANDS(0, 0, 0),
+		GPU_TEVOPERANDS(0, 0, 0),
+		GPU_REPLACE, GPU_REPLACE,
+		color.r | color.g << 8 | color.b << 16 | color.a << 24);
+#else
+	ShaderProgram::setUniform(UniformHandle::TextureEnabled, false);
+#endif // _3DS
+
+	_combiner = Combiner::Color;
+	_combinerColor = color;
+}
+
+//=============================================================================
+
+#ifdef _3DS
+void RenderState::setTexture(int unit, const void* texels, Uint32 width, Uint32 height,
+	Uint32 params, GPU_TEXCOLOR format, int levels)
+{
+	if (unit < 0 || unit >= TEXTURE_UNITS)
+	{
+		return;
+	}
+
+	TextureUnit& current = _units[unit];
+
+	if (_enabledUnits != (1 << unit))
+	{
+		GPU_SetTextureEnable(GPU_TEXUNIT(1 << unit));
+		_enabledUnits = 1 << unit;
+	}
+
+	if (current.texels == texels && current.width == width && current.height == height &&
+		current.params == params && current.format == format && current.levels == levels)
+	{
+		return;
+	}
+
+	GPU_SetTexture(GPU_TEXUNIT(1 << unit),
+		(u32*)osConvertVirtToPhys((u32)texels),
+		width, height,
+		params,
+		format);
+
+	// Also written without mipmaps, the last texture may have had some
+	u32 lod = (u32)(levels - 1) << 16;
+	GPUCMD_Add(GPUCMD_HEADER(0, 0xF, kTexUnitLodRegisters[unit]), &lod, 1);
+
+	current.texels = texels;
+	current.width = width;
+	current.height = height;
+	current.params = params;
+	current.format = format;
+	current.levels = levels;
+}
+
+//=============================================================================
+
+void RenderState::useProgram(shaderProgram_s* program)
+{
+	if (_program != program)
+	{
+		shaderProgramUse(program);
+		_program = program;
+	}
+}
+
+//=============================================================================
+
+void RenderState::forgetProgram(shaderProgram_s* program)
+{
+	if (_program == program)
+	{
+		_program = nullptr;
+	}
+}
+#else
+
+//=============================================================================
+
+void RenderState::bindTexture(int unit, GLuint id)
+{
+	if (unit < 0 || unit >= TEXTURE_UNITS)
+	{
+		return;
+	}
+
+	if (_activeUnit != unit)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		_activeUnit = unit;
+	}
+
+	if (_units[unit] != id)
+	{
+		glBindTexture(GL_TEXTURE_2D, id);
+		_units[unit] = id;
+	}
+}
+
+//=============================================================================
+
+void RenderState::setTextureParams(GLuint id, GLint minFilter, GLint magFilter, GLint wrap)
+{
+	auto it = _textureParams.find(id);
+
+	if (it != _textureParams.end() && it->second.minFilter == minFilter &&
+		it->second.magFilter == magFilter && it->second.wrap == wrap)
+	{
+		return;
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+
+	// Only needed once, a texture keeps it
+	if (it == _textureParams.end())
+	{
+		GLfloat borderColor[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+	}
+
+	_textureParams[id] = { minFilter, magFilter, wrap };
+}
+
+//=============================================================================
+
+void RenderState::forgetTexture(GLuint id)
+{
+	_textureParams.erase(id);
+
+	for (auto& unit : _units)
+	{
+		if (unit == id)
+		{
+			unit = kUnknownName;
+		}
+	}
+}
+
+//=============================================================================
+
+void RenderState::bindVertexArray(GLuint vao)
+{
+	if (_vertexArray != vao)
+	{
+		glBindVertexArray(vao);
+		_vertexArray = vao;
+	}
+}
+
+//=============================================================================
+
+void RenderState::bindArrayBuffer(GLuint buffer)
+{
+	if (_arrayBuffer != buffer)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		_arrayBuffer = buffer;
+	}
+}
+
+//=============================================================================
+
+void RenderState::useProgram(GLuint program)
+{
+	if (_program != program)
+	{
+		glUseProgram(program);
+		_program = program;
+	}
+}
+
+//=============================================================================
+
+void RenderState::forgetProgram(GLuint program)
+{
+	if (_program == program)
+	{
+		_program = kUnknownName;
+	}
+}
+#endif // _3DS
+
+//=============================================================================
+
+NS_KAIRY_END
@@ -25,9 +25,7 @@
 #include <Kairy/Graphics/RenderTexture.h>
 #include <Kairy/Graphics/RenderDevice.h>
 
-#ifdef _3DS
-#include "../3DS/VertexPool.h"
-#endif // _3DS
+#include "VertexPool.h"
 
 NS_KAIRY_BEGIN
 
@@ -102,12 +100,17 @@ void RenderTexture::startFrame()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 #endif // _3DS
 
+	// The state set above isn't tracked
+	_device->getRenderState().invalidate();
+
+	VertexPool::getInstance()->beginFrame();
+
 	_device->getDefaultShaderProgram()->use();
 
 	auto projection = Transform::createOrthographic(0, (float)_width, (float)_height, 0, 0.0f, 1.0f);
 
-	ShaderProgram::setUniform(UNIFORM_PROJECTION_NAME, projection);
-	ShaderProgram::setUniform(UNIFORM_MODELVIEW_NAME, Transform::createTranslation(0, 0, 0));
+	ShaderProgram::setUniform(UniformHandle::Projection, projection);
+	ShaderProgram::setUniform(UniformHandle::Modelview, Transform::createTranslation(0, 0, 0));
 }
 
 //=============================================================================
@@ -119,12 +122,18 @@ void RenderTexture::endFrame()
 		return;
 	}
 
+	_device->flush();
+
+	VertexPool::getInstance()->endFrame();
+
 #ifdef _3DS
 	GPU_FinishDrawing();
 	GPUCMD_Finalize();
 	GPUCMD_FlushAndRun(nullptr);
 	gspWaitForP3D();
 
+	VertexPool::getInstance()->retireFrames();
+
 	byte* rawPixels = (byte*)linearAlloc(_potWidth * _potHeight * 3);
 
 	GX_SetDisplayTransfer(nullptr, _device->_frameBuffer,
@@ -158,15 +167,12 @@ void RenderTexture::endFrame()
 
 	linearFree(rawPixels);
 #else
-	GLint oldTexture = 0;
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldTexture);
-	glBindTexture(GL_TEXTURE_2D, _id);
+	_device->getRenderState().bindTexture(0, _id);
 
 	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, _pixels);
 	
 	glEnable(GL_SCISSOR_TEST);
 	glViewport(_oldViewport[0], _oldViewport[1], _oldViewport[2], _oldViewport[3]);
-	glBindTexture(GL_TEXTURE_2D, oldTexture);
 	glBindFramebuffer(GL_FRAMEBUFFER, _oldFbo);
 	glClearColor(_oldClearColor[0], _oldClearColor[1], _oldClearColor[2], _oldClearColor[3]);
 #endif // _3DS
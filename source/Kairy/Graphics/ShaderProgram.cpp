@@ -30,6 +30,39 @@ NS_KAIRY_BEGIN
 //=============================================================================
 
 ShaderProgram* ShaderProgram::s_currentProgram = nullptr;
+Uint32 ShaderProgram::s_uploads = 0;
+Uint32 ShaderProgram::s_skippedUploads = 0;
+Uint32 ShaderProgram::s_lastUploads = 0;
+Uint32 ShaderProgram::s_lastSkippedUploads = 0;
+
+// The ids follow the order of the names in getUniformNames()
+const UniformHandle UniformHandle::Projection(0);
+const UniformHandle UniformHandle::Modelview(1);
+const UniformHandle UniformHandle::TextureEnabled(2);
+
+//=============================================================================
+
+// The names of the handles, indexed by id
+static std::vector<std::string>& getUniformNames()
+{
+	static std::vector<std::string> names =
+	{
+		UNIFORM_PROJECTION_NAME,
+		UNIFORM_MODELVIEW_NAME,
+		"textureEnabled"
+	};
+
+	return names;
+}
+
+//=============================================================================
+
+// The queued commands and the batched quads must be drawn with the
+// program and the uniforms that were set when they were submitted
+static inline void flushRenderDevice()
+{
+	RenderDevice::getInstance()->flush();
+}
 
 //=============================================================================
 
@@ -97,6 +130,8 @@ bool ShaderProgram::load(const byte* vsh_data,
     }
 
     shaderProgramSetVsh(&_shaderProgram, &_vertexShader->DVLE[0]);
+    RenderDevice::getInstance()->getRenderState().forgetProgram(&_shaderProgram);
+    resolveUniforms();
 #else
 
 	constexpr const char* fShaderData =
@@ -139,6 +174,9 @@ bool ShaderProgram::load(const byte* vsh_data,
 		return false;
 	}
 
+	// The name of a deleted program can be reused
+	RenderDevice::getInstance()->getRenderState().forgetProgram(_program);
+
 	glShaderSource(fshaderId, 1, &fShaderData, &fShaderDataLen);
 	glShaderSource(vshaderId, 1, &vShaderData, &vShaderDataLen);
 
@@ -178,6 +216,7 @@ bool ShaderProgram::load(const byte* vsh_data,
 	glDeleteShader(fshaderId);
 
 	_initialized = true;
+	resolveUniforms();
 
 #endif // _3DS
 
@@ -189,6 +228,7 @@ bool ShaderProgram::load(const byte* vsh_data,
 void ShaderProgram::unload()
 {
 	_locationsMap.clear();
+	_uniforms.clear();
 	
 #ifdef _3DS
     if(_vertexShader)
@@ -218,10 +258,21 @@ void ShaderProgram::use()
 {
     if(_initialized && s_currentProgram != this)
     {
+        flushRenderDevice();
+
+        auto& state = RenderDevice::getInstance()->getRenderState();
+
 #ifdef _3DS
-        shaderProgramUse(&_shaderProgram);
+        state.useProgram(&_shaderProgram);
+
+        // The uniform registers are shared by all the programs,
+        // the previous one may have overwritten the values
+        for(auto& slot : _uniforms)
+        {
+            slot.size = 0;
+        }
 #else
-		glUseProgram(_program);
+		state.useProgram(_program);
 #endif // _3DS
         s_currentProgram = this;
     }
@@ -261,111 +312,307 @@ int ShaderProgram::getUniformLocation(const std::string& name) const
 
 //=============================================================================
 
+UniformHandle ShaderProgram::getUniformHandle(const std::string& name)
+{
+	auto& names = getUniformNames();
+
+	for(Uint32 i = 0; i < names.size(); ++i)
+	{
+		if(names[i] == name)
+		{
+			return UniformHandle((int)i);
+		}
+	}
+
+	names.push_back(name);
+
+	return UniformHandle((int)names.size() - 1);
+}
+
+//=============================================================================
+
+void ShaderProgram::resolveUniforms()
+{
+	auto& names = getUniformNames();
+
+	for(Uint32 i = (Uint32)_uniforms.size(); i < names.size(); ++i)
+	{
+		UniformSlot slot;
+		slot.location = getUniformLocation(names[i]);
+		slot.size = 0;
+
+		_uniforms.push_back(slot);
+	}
+}
+
+//=============================================================================
+
+ShaderProgram::UniformSlot* ShaderProgram::getUniformSlot(UniformHandle handle)
+{
+	if(!handle.isValid())
+	{
+		return nullptr;
+	}
+
+	if((Uint32)handle.getId() >= _uniforms.size())
+	{
+		resolveUniforms();
+
+		if((Uint32)handle.getId() >= _uniforms.size())
+		{
+			return nullptr;
+		}
+	}
+
+	return &_uniforms[handle.getId()];
+}
+
+//=============================================================================
+
+ShaderProgram::UniformSlot* ShaderProgram::prepareUniform(UniformHandle handle,
+	const float* values, Uint32 size)
+{
+	if(!s_currentProgram || !s_currentProgram->_initialized)
+	{
+		return nullptr;
+	}
+
+	UniformSlot* slot = s_currentProgram->getUniformSlot(handle);
+
+	if(!slot || slot->location < 0)
+	{
+		return nullptr;
+	}
+
+	if(slot->size == size && memcmp(slot->values, values, size * sizeof(float)) == 0)
+	{
+		s_skippedUploads++;
+		return nullptr;
+	}
+
+	flushRenderDevice();
+
+	memcpy(slot->values, values, size * sizeof(float));
+	slot->size = size;
+
+	s_uploads++;
+
+	return slot;
+}
+
+//=============================================================================
+
+void ShaderProgram::resetUniformCounters()
+{
+	s_lastUploads = s_uploads;
+	s_lastSkippedUploads = s_skippedUploads;
+	s_uploads = 0;
+	s_skippedUploads = 0;
+}
+
+//=============================================================================
+
 void ShaderProgram::setUniform(const std::string& name, float value)
 {
-    if(s_currentProgram && s_currentProgram->_initialized)
-    {
-#ifdef _3DS
-        GPU_SetFloatUniform(GPU_VERTEX_SHADER,
-                            s_currentProgram->getUniformLocation(name),
-                            (u32*)&value, 1);
-#else
-		glUniform1f(s_currentProgram->getUniformLocation(name), value);
-#endif // _3DS
-    }
+    setUniform(getUniformHandle(name), value);
 }
 
 //=============================================================================
 
 void ShaderProgram::setUniform(const std::string& name, float x, float y, float z)
 {
-    if(s_currentProgram && s_currentProgram->_initialized)
-    {
-#ifdef _3DS
-        float values[] = { x, y, z };
-        GPU_SetFloatUniform(GPU_VERTEX_SHADER,
-                            s_currentProgram->getUniformLocation(name),
-                            (u32*)values, 3);
-#else
-		glUniform3f(s_currentProgram->getUniformLocation(name), x, y, z);
-#endif // _3DS
-    }
+    setUniform(getUniformHandle(name), x, y, z);
 }
 
 //=============================================================================
 
 void ShaderProgram::setUniform(const std::string& name, float x, float y, float z, float w)
 {
-    if(s_currentProgram && s_currentProgram->_initialized)
+    setUniform(getUniformHandle(name), x, y, z, w);
+}
+
+//=============================================================================
+
+void ShaderProgram::setUniform(const std::string& name, const Vec4& v4)
+{
+    setUniform(getUniformHandle(name), v4);
+}
+
+//=============================================================================
+
+void ShaderProgram::setUniform(const std::string& name, const Vec3& v3)
+{
+    setUniform(getUniformHandle(name), v3);
+}
+
+//=============================================================================
+
+void ShaderProgram::setUniform(const std::string& name, const Transform& t)
+{
+    setUniform(getUniformHandle(name), t);
+}
+
+//=============================================================================
+
+void ShaderProgram::setUniform(const std::string& name, const Affine2D& t)
+{
+    setUniform(getUniformHandle(name), t);
+}
+
+//=============================================================================
+
+void ShaderProgram::setUniform(UniformHandle handle, bool value)
+{
+    float values[] = { value ? 1.0f : 0.0f };
+    auto slot = prepareUniform(handle, values, 1);
+
+    if(slot)
     {
 #ifdef _3DS
-        float values[] = { x, y, z, w };
-        GPU_SetFloatUniform(GPU_VERTEX_SHADER,
-                            s_currentProgram->getUniformLocation(name),
-                            (u32*)values, 4);
+        // The boolean registers are only written when the program is used
+        shaderInstanceSetBool(s_currentProgram->_shaderProgram.vertexShader,
+                              slot->location, value);
+        shaderProgramUse(&s_currentProgram->_shaderProgram);
 #else
-		glUniform4f(s_currentProgram->getUniformLocation(name), x, y, z, w);
+		glUniform1i(slot->location, value);
 #endif // _3DS
     }
 }
 
 //=============================================================================
 
-void ShaderProgram::setUniform(const std::string& name, const Vec4& v4)
+void ShaderProgram::setUniform(UniformHandle handle, float value)
 {
-    if(s_currentProgram && s_currentProgram->_initialized)
+    float values[] = { value };
+    setFloatUniform(handle, values, 1);
+}
+
+//=============================================================================
+
+void ShaderProgram::setUniform(UniformHandle handle, float x, float y, float z)
+{
+    float values[] = { x, y, z };
+    setFloatUniform(handle, values, 3);
+}
+
+//=============================================================================
+
+void ShaderProgram::setUniform(UniformHandle handle, float x, float y, float z, float w)
+{
+    float values[] = { x, y, z, w };
+    setFloatUniform(handle, values, 4);
+}
+
+//=============================================================================
+
+void ShaderProgram::setFloatUniform(UniformHandle handle, const float* values, Uint32 count)
+{
+    auto slot = prepareUniform(handle, values, count);
+
+    if(!slot)
     {
+        return;
+    }
+
 #ifdef _3DS
-        GPU_SetFloatUniform(GPU_VERTEX_SHADER,
-                            s_currentProgram->getUniformLocation(name),
-                            (u32*)&v4, 4);
+    // A register always holds four components, in reverse order
+    float reversed[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    for(Uint32 i = 0; i < count; ++i)
+    {
+        reversed[3 - i] = values[i];
+    }
+
+    GPU_SetFloatUniform(GPU_VERTEX_SHADER, slot->location, (u32*)reversed, 1);
 #else
-		glUniform4f(s_currentProgram->getUniformLocation(name),
-			v4.x, v4.y, v4.z, v4.w);
-#endif // _3DS
+    // The upload has to match the size declared by the shader
+    switch(count)
+    {
+    case 1:
+        glUniform1f(slot->location, values[0]);
+        break;
+    case 3:
+        glUniform3f(slot->location, values[0], values[1], values[2]);
+        break;
+    default:
+        glUniform4f(slot->location, values[0], values[1], values[2], values[3]);
+        break;
     }
+#endif // _3DS
 }
 
 //=============================================================================
 
-void ShaderProgram::setUniform(const std::string& name, const Vec3& v3)
+void ShaderProgram::setUniform(UniformHandle handle, const Vec4& v4)
+{
+    setUniform(handle, v4.x, v4.y, v4.z, v4.w);
+}
+
+//=============================================================================
+
+void ShaderProgram::setUniform(UniformHandle handle, const Vec3& v3)
 {
-    if(s_currentProgram && s_currentProgram->_initialized)
+    setUniform(handle, v3.x, v3.y, v3.z);
+}
+
+//=============================================================================
+
+void ShaderProgram::setUniform(UniformHandle handle, const Transform& t)
+{
+    auto slot = prepareUniform(handle, (const float*)&t, 16);
+
+    if(slot)
     {
 #ifdef _3DS
-        GPU_SetFloatUniform(GPU_VERTEX_SHADER,
-                            s_currentProgram->getUniformLocation(name),
-                            (u32*)&v3, 3);
+        float mu[16];
+
+        for(int i = 0; i < 4; ++i)
+        {
+            for(int j = 0; j < 4; ++j)
+            {
+                mu[i*4 + j] = t.getValue(3 - j, i);
+            }
+        }
+
+        GPU_SetFloatUniform(GPU_VERTEX_SHADER, slot->location, (u32*)mu, 4);
 #else
-		glUniform3f(s_currentProgram->getUniformLocation(name),
-			v3.x, v3.y, v3.z);
+		glUniformMatrix4fv(slot->location, 1, GL_TRUE, (const float*)&t);
 #endif // _3DS
     }
 }
 
 //=============================================================================
 
-void ShaderProgram::setUniform(const std::string& name, const Transform& t)
+void ShaderProgram::setUniform(UniformHandle handle, const Affine2D& t)
 {
-    if(s_currentProgram && s_currentProgram->_initialized)
+    // Expand to a row major 4x4 matrix
+    float m[16] =
+    {
+        t.getValue(0, 0), t.getValue(1, 0), 0.0f, t.getValue(2, 0),
+        t.getValue(0, 1), t.getValue(1, 1), 0.0f, t.getValue(2, 1),
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+
+    auto slot = prepareUniform(handle, m, 16);
+
+    if(slot)
     {
+#ifdef _3DS
+        // The vertex shader reads every row in reverse order
         float mu[16];
 
         for(int i = 0; i < 4; ++i)
         {
             for(int j = 0; j < 4; ++j)
             {
-                mu[i*4 + j] = t.getValue(3 - j, i);
+                mu[i*4 + j] = m[i*4 + 3 - j];
             }
         }
 
-#ifdef _3DS
-        GPU_SetFloatUniform(GPU_VERTEX_SHADER,
-                            s_currentProgram->getUniformLocation(name),
-                            (u32*)mu, 4);
+        GPU_SetFloatUniform(GPU_VERTEX_SHADER, slot->location, (u32*)mu, 4);
 #else
-		glUniformMatrix4fv(s_currentProgram->getUniformLocation(name),
-			1, GL_TRUE, (float*)&t);
+		glUniformMatrix4fv(slot->location, 1, GL_TRUE, m);
 #endif // _3DS
     }
 }
@@ -23,13 +23,8 @@
  *****************************************************************************/
 
 #include <Kairy/Graphics/Sprite.h>
-#include <Kairy/Graphics/ShaderProgram.h>
 #include <Kairy/Graphics/RenderDevice.h>
 
-#ifdef _3DS
-#include "../3DS/VertexPool.h"
-#endif // _3DS
-
 NS_KAIRY_BEGIN
 
 //=============================================================================
@@ -186,85 +181,17 @@ void Sprite::draw()
 
 	if (_color.a > 0)
 	{
-		//=========================================================================
-		// Setting up the vertices
-		//=========================================================================
-
-		auto u0 = _textureRect.getLeft() / (float)_texture.getRealWidth();
-		auto u1 = _textureRect.getRight() / (float)_texture.getRealWidth();
-		auto v0 = _textureRect.getTop() / (float)_texture.getRealHeight();
-		auto v1 = _textureRect.getBottom() / (float)_texture.getRealHeight();
-
-		ShaderProgram::setUniform(UNIFORM_MODELVIEW_NAME, getCombinedTransform());
-
-#ifdef _3DS
-		auto vertices = (VertexPositionTexture*)VertexPool::getInstance()->
-			pushVertices(sizeof(VertexPositionTexture), 4);
-
-		vertices[0].position = Vec2(0, 0);
-		vertices[1].position = Vec2(_size.x, 0);
-		vertices[2].position = Vec2(0, _size.y);
-		vertices[3].position = Vec2(_size.x, _size.y);
-
-		vertices[0].texcoord = Vec2(u0, 1 - v0);
-		vertices[1].texcoord = Vec2(u1, 1 - v0);
-		vertices[2].texcoord = Vec2(u0, 1 - v1);
-		vertices[3].texcoord = Vec2(u1, 1 - v1);
-
-		//=========================================================================
-
-		GPU_SetTexEnv(0,
-			GPU_TEVSOURCES(GPU_TEXTURE0, GPU_CONSTANT, GPU_CONSTANT),
-			GPU_TEVSOURCES(GPU_TEXTURE0, GPU_CONSTANT, GPU_CONSTANT),
-			GPU_TEVOPERANDS(0, 0, 0),
-			GPU_TEVOPERANDS(0, 0, 0),
-			GPU_MODULATE, GPU_MODULATE,
-			_color.r | _color.g << 8 | _color.b << 16 | _color.a << 24);
-
-		u32 bufferOffsets[] = { 0x00 };
-		u64 bufferPermutations[] = { 0x10 };
-		u8 bufferNumAttributes[] = { 2 };
-
-		_texture.bind();
-
-		GPU_SetAttributeBuffers(
-			2,
-			(u32*)osConvertVirtToPhys((u32)vertices),
-			GPU_ATTRIBFMT(0, 2, GPU_FLOAT) |
-			GPU_ATTRIBFMT(1, 2, GPU_FLOAT),
-			0xFFFC,
-			0x10,
-			1,
-			bufferOffsets,
-			bufferPermutations,
-			bufferNumAttributes);
-
-		GPU_DrawArray(GPU_TRIANGLE_STRIP, 0, 4);
-#else
-		Vec4 c = _color.toVector();
-
-		float vertices[] =
-		{
-			0, 0, -0.5f, c.x, c.y, c.z, c.w, u0, v0,
-			_size.x, 0, -0.5f, c.x, c.y, c.z, c.w, u1, v0,
-			0, _size.y, -0.5f, c.x, c.y, c.z, c.w, u0, v1,
-			_size.x, _size.y, -0.5f, c.x, c.y, c.z, c.w, u1, v1
-		};
-
-		glUniform1i(ShaderProgram::getCurrentProgram()->
-			getUniformLocation("textureEnabled"), true);
-
-		glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * 36, vertices);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-		_texture.bind();
-
-		glBindVertexArray(_vao);
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-		glBindVertexArray(0);
-
-#endif // _3DS
+		RenderCommand command;
+		command.texture = &_texture;
+		command.transform = getCombinedTransform();
+		command.size = _size;
+		command.textureRect = _textureRect;
+		command.color = _color;
+		command.blendMode = _blendMode;
+		command.layer = _layer;
+		command.zOrder = _globalZOrder;
+
+		_device->submit(command);
 	}
 
 	Node::draw();
@@ -335,23 +262,8 @@ void Sprite::init()
 {
 	updateTextureRect();
 
-#ifndef _3DS
-	glGenVertexArrays(1, &_vao);
-	glGenBuffers(1, &_vbo);
-
-	glBindVertexArray(_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 36, nullptr, GL_DYNAMIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 9, 0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 9, (GLvoid*)(sizeof(float) * 3));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 9, (GLvoid*)(sizeof(float) * 7));
-	glEnableVertexAttribArray(2);
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-#endif // _3DS
+	// The quad fills the bounding box
+	_cullable = true;
 }
 
 //=============================================================================
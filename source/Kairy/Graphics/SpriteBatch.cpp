@@ -0,0 +1,324 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <Kairy/Graphics/SpriteBatch.h>
+#include <Kairy/Graphics/Texture.h>
+#include <Kairy/Graphics/ShaderProgram.h>
+#include <Kairy/Graphics/RenderDevice.h>
+
+#include "VertexPool.h"
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+SpriteBatch::SpriteBatch(void)
+	: _quadsCount(0)
+	, _drawCalls(0)
+	, _quadsDrawn(0)
+	, _runPixels(nullptr)
+	, _runAaEnabled(false)
+	, _runRepeated(false)
+	, _runProgram(nullptr)
+{
+}
+
+//=============================================================================
+
+SpriteBatch::~SpriteBatch()
+{
+	destroy();
+}
+
+//=============================================================================
+
+bool SpriteBatch::init()
+{
+	_vertices.resize(MAX_QUADS * VERTICES_PER_QUAD);
+	_quadsCount = 0;
+
+#ifndef _3DS
+	// The vertices are drawn from the vertex pool with its layout
+	static_assert(sizeof(Vertex) == sizeof(VertexPositionColorTexture),
+		"SpriteBatch::Vertex must match VertexPositionColorTexture");
+#endif // _3DS
+
+	return true;
+}
+
+//=============================================================================
+
+void SpriteBatch::destroy()
+{
+	_vertices.clear();
+	_quadsCount = 0;
+}
+
+//=============================================================================
+
+void SpriteBatch::begin()
+{
+	_quadsCount = 0;
+	_drawCalls = 0;
+	_quadsDrawn = 0;
+	_runPixels = nullptr;
+	_runProgram = nullptr;
+}
+
+//=============================================================================
+
+void SpriteBatch::draw(Texture& texture, const Affine2D& transform,
+	const Vec2& size, const Rect& textureRect, const Color& color)
+{
+	if (_vertices.empty())
+	{
+		return;
+	}
+
+	if (_quadsCount >= MAX_QUADS ||
+		(_quadsCount > 0 && !isSameRun(texture)))
+	{
+		flush();
+	}
+
+	if (_quadsCount == 0)
+	{
+		texture.bind();
+
+		_runPixels = texture._pixels;
+		_runAaEnabled = texture._aaEnabled;
+		_runRepeated = texture._repeated;
+		_runProgram = ShaderProgram::getCurrentProgram();
+	}
+
+	// Transform the corners of the quad on the CPU so that every
+	// quad of the run can share the same modelview
+	Vec2 corners[4] =
+	{
+		Vec2(0.0f, 0.0f),
+		Vec2(size.x, 0.0f),
+		Vec2(0.0f, size.y),
+		Vec2(size.x, size.y)
+	};
+
+	transform.transformPoints(corners, corners, 4);
+
+	setQuad(&_vertices[_quadsCount * VERTICES_PER_QUAD],
+		corners[0], corners[1], corners[2], corners[3],
+		getTexCoords(texture, textureRect),
+		color.toVector());
+
+	_quadsCount++;
+}
+
+//=============================================================================
+
+void SpriteBatch::flush()
+{
+	if (_quadsCount == 0)
+	{
+		return;
+	}
+
+	Uint32 verticesCount = _quadsCount * VERTICES_PER_QUAD;
+
+	_quadsDrawn += _quadsCount;
+	_drawCalls++;
+
+	// Reset the counter before touching the uniforms, since setting
+	// them flushes the pending quads
+	_quadsCount = 0;
+
+	ShaderProgram::setUniform(UniformHandle::Modelview, _identity);
+
+	drawVertices(_vertices.data(), verticesCount);
+}
+
+//=============================================================================
+
+void SpriteBatch::drawQuads(Texture& texture, const Vertex* vertices, Uint32 quads)
+{
+	drawQuads(texture, vertices, quads, _identity);
+}
+
+//=============================================================================
+
+void SpriteBatch::drawQuads(Texture& texture, const Vertex* vertices, Uint32 quads,
+	const Affine2D& modelview)
+{
+	if (!vertices || quads == 0)
+	{
+		return;
+	}
+
+	// Draw everything pending before this stream
+	RenderDevice::getInstance()->flush();
+	ShaderProgram::setUniform(UniformHandle::Modelview, modelview);
+
+	texture.bind();
+
+	_quadsDrawn += quads;
+	_drawCalls++;
+
+	drawVertices(vertices, quads * VERTICES_PER_QUAD);
+}
+
+//=============================================================================
+
+void SpriteBatch::setQuad(Vertex* vertices, const Vec2& p0, const Vec2& p1,
+	const Vec2& p2, const Vec2& p3, const Rect& texcoords, const Vec4& color)
+{
+	float u0 = texcoords.getLeft();
+	float u1 = texcoords.getRight();
+	float v0 = texcoords.getTop();
+	float v1 = texcoords.getBottom();
+
+	auto setVertex = [&color](Vertex& vertex, const Vec2& p, float u, float v)
+	{
+#ifdef _3DS
+		vertex.position = p;
+#else
+		vertex.position = Vec3(p.x, p.y, -0.5f);
+#endif // _3DS
+		vertex.texcoord = Vec2(u, v);
+		vertex.color = color;
+	};
+
+	setVertex(vertices[0], p0, u0, v0);
+	setVertex(vertices[1], p1, u1, v0);
+	setVertex(vertices[2], p2, u0, v1);
+	setVertex(vertices[3], p2, u0, v1);
+	setVertex(vertices[4], p1, u1, v0);
+	setVertex(vertices[5], p3, u1, v1);
+}
+
+//=============================================================================
+
+void SpriteBatch::setQuadTexCoords(Vertex* vertices, const Rect& texcoords)
+{
+	float u0 = texcoords.getLeft();
+	float u1 = texcoords.getRight();
+	float v0 = texcoords.getTop();
+	float v1 = texcoords.getBottom();
+
+	vertices[0].texcoord = Vec2(u0, v0);
+	vertices[1].texcoord = Vec2(u1, v0);
+	vertices[2].texcoord = Vec2(u0, v1);
+	vertices[3].texcoord = Vec2(u0, v1);
+	vertices[4].texcoord = Vec2(u1, v0);
+	vertices[5].texcoord = Vec2(u1, v1);
+}
+
+//=============================================================================
+
+Rect SpriteBatch::getTexCoords(const Texture& texture, const Rect& textureRect)
+{
+	float width = (float)texture.getRealWidth();
+	float height = (float)texture.getRealHeight();
+
+	float u0 = textureRect.getLeft() / width;
+	float u1 = textureRect.getRight() / width;
+	float v0 = textureRect.getTop() / height;
+	float v1 = textureRect.getBottom() / height;
+
+#ifdef _3DS
+	v0 = 1.0f - v0;
+	v1 = 1.0f - v1;
+#endif // _3DS
+
+	return Rect(u0, v0, u1 - u0, v1 - v0);
+}
+
+//=============================================================================
+
+void SpriteBatch::drawVertices(const Vertex* vertices, Uint32 count)
+{
+	auto pool = VertexPool::getInstance();
+	auto poolVertices = pool->pushVertices<Vertex>(count);
+
+	if (!poolVertices)
+	{
+		return;
+	}
+
+	memcpy(poolVertices, vertices, sizeof(Vertex) * count);
+
+#ifdef _3DS
+
+	RenderDevice::getInstance()->getRenderState().setTextureCombiner();
+
+	u32 bufferOffsets[] = { 0x00 };
+	u64 bufferPermutations[] = { 0x210 };
+	u8 bufferNumAttributes[] = { 3 };
+
+	GPU_SetAttributeBuffers(
+		3,
+		(u32*)osConvertVirtToPhys((u32)poolVertices),
+		GPU_ATTRIBFMT(0, 2, GPU_FLOAT) |
+		GPU_ATTRIBFMT(1, 2, GPU_FLOAT) |
+		GPU_ATTRIBFMT(2, 4, GPU_FLOAT),
+		0xFFF8,
+		0x210,
+		1,
+		bufferOffsets,
+		bufferPermutations,
+		bufferNumAttributes);
+
+	GPU_DrawArray(GPU_TRIANGLES, 0, count);
+#else
+	RenderDevice::getInstance()->getRenderState().setTextureCombiner();
+
+	GLint first = pool->commit();
+
+	pool->bindVertexArray();
+	glDrawArrays(GL_TRIANGLES, first, count);
+#endif // _3DS
+}
+
+//=============================================================================
+
+bool SpriteBatch::isSameRun(const Texture& texture) const
+{
+	if (texture._pixels != _runPixels ||
+		texture._aaEnabled != _runAaEnabled ||
+		texture._repeated != _runRepeated ||
+		ShaderProgram::getCurrentProgram() != _runProgram)
+	{
+		return false;
+	}
+
+#ifndef _3DS
+	// The texture must be uploaded again before drawing with it
+	if (texture._pixelsUpdated || !texture._dirtyRects.empty())
+	{
+		return false;
+	}
+#endif // _3DS
+
+	return true;
+}
+
+//=============================================================================
+
+NS_KAIRY_END
@@ -136,6 +136,7 @@ std::shared_ptr<Text> Text::createBMF(const std::string & filename)
 
 Text::Text(void)
 	: Node()
+	, _glyphsDirty(false)
 	, _lineWidth(0)
 	, _useKerning(true)
 {
@@ -175,6 +176,7 @@ Text::~Text()
 
 bool Text::loadFont(const std::string & filename)
 {
+	_glyphsDirty = true;
 	return _font.loadBmf(filename);
 }
 
@@ -182,6 +184,7 @@ bool Text::loadFont(const std::string & filename)
 
 bool Text::loadFont(const std::string & filename, float size)
 {
+	_glyphsDirty = true;
 	return _font.loadTtf(filename, size);
 }
 
@@ -189,6 +192,7 @@ bool Text::loadFont(const std::string & filename, float size)
 
 bool Text::loadFont(const byte * buffer, float size)
 {
+	_glyphsDirty = true;
 	return _font.loadTtf(buffer, size);
 }
 
@@ -196,6 +200,7 @@ bool Text::loadFont(const byte * buffer, float size)
 
 bool Text::loadFont(float size)
 {
+	_glyphsDirty = true;
 	return _font.loadTtf(size);
 }
 
@@ -258,17 +263,103 @@ void Text::draw()
 		return;
 	}
 
+	updateTransform();
+
+	if (_glyphsDirty)
+	{
+		updateGlyphs();
+	}
+	else if (_verticesColor != _color)
+	{
+		for (auto& glyph : _glyphs)
+		{
+			updateGlyphColor(glyph);
+		}
+
+		_verticesColor = _color;
+	}
+
+	if (_color.a > 0)
+	{
+		// The glyphs are drawn as a single stream for every page,
+		// everything submitted before must be drawn first
+		_device->flush();
+		_device->setBlendMode(_blendMode);
+
+		SpriteBatch* batch = _device->getSpriteBatch();
+
+		for (Uint32 i = 0; i < _pageVertices.size(); ++i)
+		{
+			auto& vertices = _pageVertices[i];
+
+			batch->drawQuads(*_font._pages[i], vertices.data(),
+				Uint32(vertices.size() / SpriteBatch::VERTICES_PER_QUAD),
+				getCombinedTransform());
+		}
+	}
+
 	Node::draw();
 }
 
 //=============================================================================
 
+void Text::setCharacterColor(Uint32 index, const Color& color)
+{
+	if (_glyphsDirty)
+	{
+		updateGlyphs();
+	}
+
+	if (index < _glyphs.size())
+	{
+		_glyphs[index].color = color;
+		updateGlyphColor(_glyphs[index]);
+	}
+}
+
+//=============================================================================
+
+Color Text::getCharacterColor(Uint32 index)
+{
+	if (_glyphsDirty)
+	{
+		updateGlyphs();
+	}
+
+	if (index < _glyphs.size())
+	{
+		return _glyphs[index].color;
+	}
+
+	return Color::White;
+}
+
+//=============================================================================
+
+void Text::updateGlyphColor(const Glyph& glyph)
+{
+	if (glyph.page < 0)
+	{
+		return;
+	}
+
+	Vec4 color = (glyph.color * _color).toVector();
+	auto vertices = &_pageVertices[glyph.page][glyph.quad * SpriteBatch::VERTICES_PER_QUAD];
+
+	for (Uint32 i = 0; i < SpriteBatch::VERTICES_PER_QUAD; ++i)
+	{
+		vertices[i].color = color;
+	}
+}
+
+//=============================================================================
+
 void Text::incrementX(float& x, float& y, float amount)
 {
 	if (_lineWidth > 0 && x + amount >= _lineWidth)
 	{
 		x = 0.0f;
-		y += _font._lineHeight * _scale;
+		y += getLineHeight();
 	}
 
 	x += amount;
@@ -276,15 +367,19 @@ void Text::incrementX(float& x, float& y, float amount)
 
 //=============================================================================
 
-void Text::updateCharacters()
+void Text::updateGlyphs()
 {
-	for (auto& character : _characters)
+	_glyphsDirty = false;
+	_verticesColor = _color;
+
+	_glyphs.assign(_str.length(), Glyph{ -1, 0, Color::White });
+	_pageVertices.resize(_font._pages.size());
+
+	for (auto& vertices : _pageVertices)
 	{
-		removeChild(character.get());
+		vertices.clear();
 	}
 
-	_characters.clear();
-
 	int previousChar = 0;
 
 	float x = 0.0f;
@@ -321,6 +416,11 @@ void Text::updateCharacters()
 			continue;
 		}
 
+		if (character.page < 0 || character.page >= (int)_font._pages.size())
+		{
+			continue;
+		}
+
 		auto& page = _font._pages[character.page];
 
 		int kerning = 0;
@@ -346,18 +446,27 @@ void Text::updateCharacters()
 			px += kerning;
 		}
 
-		auto charSprite = std::make_shared<Sprite>();
+		float width = (float)character.width;
+		float height = (float)character.height;
+
+		// The quads are in the space of the text, moving it
+		// doesn't require to build them again
+		auto& vertices = _pageVertices[character.page];
 
-		charSprite->getTexture() = *page;
-		charSprite->setTextureRect((float)character.x, (float)character.y,
-			(float)character.width, (float)character.height);
+		Glyph& glyph = _glyphs[i];
+		glyph.page = character.page;
+		glyph.quad = Uint32(vertices.size() / SpriteBatch::VERTICES_PER_QUAD);
 
-		charSprite->setPosition(px, py);
-		charSprite->setColor(_color);
-		charSprite->setTag(i);
+		vertices.resize(vertices.size() + SpriteBatch::VERTICES_PER_QUAD);
 
-		addChild(charSprite);
-		_characters.push_back(charSprite);
+		SpriteBatch::setQuad(&vertices[glyph.quad * SpriteBatch::VERTICES_PER_QUAD],
+			Vec2(px, py),
+			Vec2(px + width, py),
+			Vec2(px, py + height),
+			Vec2(px + width, py + height),
+			SpriteBatch::getTexCoords(*page, Rect((float)character.x,
+				(float)character.y, width, height)),
+			(glyph.color * _color).toVector());
 
 		x += character.xadvance;
 
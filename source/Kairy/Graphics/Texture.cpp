@@ -24,6 +24,10 @@
 
 #include <Kairy/Graphics/Texture.h>
 #include <Kairy/Graphics/ImageLoader.h>
+#include <Kairy/Graphics/TextureSwizzle.h>
+#include <Kairy/Graphics/TextureConverter.h>
+#include <Kairy/Graphics/TextureContainer.h>
+#include <Kairy/Graphics/TextureResidency.h>
 #include <Kairy/System/ResourceManager.h>
 #include <Kairy/Util/Npot.h>
 #include <Kairy/Util/Clamp.h>
@@ -38,41 +42,86 @@ NS_KAIRY_BEGIN
 
 //=============================================================================
 
-#ifdef _3DS
-// Grabbed from CTRCommon
-inline u32 gpuTextureIndex(u32 x, u32 y, u32 w, u32 h)
-{
-	return (((y >> 3) * (w >> 3) + (x >> 3)) << 6) + ((x & 1) |
-		((y & 1) << 1) | ((x & 2) << 1) | ((y & 2) << 2) |
-		((x & 4) << 2) | ((y & 4) << 3));
-}
-#endif // _3DS
-
-//=============================================================================
-
 Texture* Texture::s_bindedTexture = nullptr;
 bool Texture::s_defaultAaEnabled = true;
+Texture::Format Texture::s_defaultFormat = Texture::Format::Default;
+bool Texture::s_ditheringEnabled = true;
 Uint32 Texture::s_memResCounter = 0;
 
 //=============================================================================
 
+// The cache is opt-in: only the textures evict the released ones to make
+// room, the other linear heap users would fail their allocations
+static const Uint32 kDefaultLinearCacheBudget = 0;
+
+//=============================================================================
+
 static const std::string kMemResPrefix = "mem_";
 
 //=============================================================================
 
-void Texture::deleteResourceData(ResourceData & data)
-{
+#ifndef _3DS
+// Past this, the regions are merged in a single upload
+static const size_t kMaxDirtyRects = 8;
+#endif // _3DS
+
+//=============================================================================
+
 #ifdef _3DS
-	if (data.pixels)
+#ifndef GPU_TEXTURE_MIP_FILTER
+#define GPU_TEXTURE_MIP_FILTER(v) (((v) & 0x1) << 24)
+#endif // GPU_TEXTURE_MIP_FILTER
+
+//=============================================================================
+
+static GPU_TEXCOLOR getGpuFormat(Texture::Format format)
+{
+	switch (format)
 	{
-		if (data.location == Location::Ram)
-			linearFree(data.pixels);
-		else
-			vramFree(data.pixels);
+	case Texture::Format::RGB5A1: return GPU_RGBA5551;
+	case Texture::Format::RGB565: return GPU_RGB565;
+	case Texture::Format::RGBA4:  return GPU_RGBA4;
+	case Texture::Format::L8:     return GPU_L8;
+	case Texture::Format::A8:     return GPU_A8;
+	case Texture::Format::ETC1:   return GPU_ETC1;
+	default:                      return GPU_RGBA8;
 	}
+}
 #else
+// The name of a deleted texture can be reused, the render state
+// must not take the new texture for the old one
+static GLuint genTexture()
+{
+	GLuint id = 0;
+	glGenTextures(1, &id);
+	RenderDevice::getInstance()->getRenderState().forgetTexture(id);
+
+	return id;
+}
+#endif // _3DS
+
+//=============================================================================
+
+std::string Texture::getResourceName(const std::string& filename,
+	Location location, Format format)
+{
+	std::string name = filename + (location == Location::Ram ? 'r' : 'v');
+
+	if (format != Format::RGBA8)
+	{
+		name += util::to_string((int)format);
+	}
+
+	return name;
+}
+
+//=============================================================================
+
+void Texture::deleteResourceData(ResourceData & data)
+{
 	if (data.pixels)
-		delete[] data.pixels;
+		freePixels(data.pixels, data.location);
+#ifndef _3DS
 	glDeleteTextures(1, &data.id);
 	data.id = 0;
 #endif // _3DS
@@ -87,33 +136,206 @@ void Texture::deleteResourceData(ResourceData & data)
 //=============================================================================
 
 ResourceManager<Texture::ResourceData>
-Texture::s_resourceManager(Texture::deleteResourceData);
+Texture::s_resourceManager(Texture::deleteResourceData, kDefaultLinearCacheBudget);
 
 //=============================================================================
 
-bool Texture::preload(const std::string & filename, Location location)
+MemoryPool Texture::getMemoryPool(Location location)
 {
-	int width = 0;
-	int height = 0;
-	byte* loadedPixels = ImageLoader::LoadFromFile(filename, width, height, PixelFormat::RGBA8);
+	return location == Location::Vram ? MemoryPool::Vram : MemoryPool::Linear;
+}
 
-	if (!loadedPixels || width == 0 || height == 0)
+//=============================================================================
+
+Uint32 Texture::getResourceSize(const ResourceData& data)
+{
+	return TextureConverter::getMemorySize(data.format,
+		util::clamp<int>(util::npot(data.width), MIN_SIZE, MAX_SIZE),
+		util::clamp<int>(util::npot(data.height), MIN_SIZE, MAX_SIZE), data.mipLevels);
+}
+
+//=============================================================================
+
+void Texture::addResource(const std::string& name, const ResourceData& data)
+{
+	s_resourceManager.addResource(name, data, getResourceSize(data),
+		getMemoryPool(data.location), !data.memory);
+}
+
+//=============================================================================
+
+void Texture::setCacheBudget(Location location, Uint32 bytes)
+{
+	s_resourceManager.setBudget(getMemoryPool(location), bytes);
+}
+
+//=============================================================================
+
+Uint32 Texture::getCacheBudget(Location location)
+{
+	return s_resourceManager.getBudget(getMemoryPool(location));
+}
+
+//=============================================================================
+
+Uint32 Texture::getCachedMemory(Location location)
+{
+	return s_resourceManager.getCachedMemory(getMemoryPool(location));
+}
+
+//=============================================================================
+
+const ResourceStats& Texture::getCacheStats()
+{
+	return s_resourceManager.getStats();
+}
+
+//=============================================================================
+
+void Texture::clearCache()
+{
+	s_resourceManager.clearCache();
+}
+
+//=============================================================================
+
+byte* Texture::allocatePixels(Uint32 size, Location location)
+{
+#ifdef _3DS
+	// Make room by dropping released textures, then try again
+	for (int attempt = 0; attempt < 2; ++attempt)
 	{
-		return false;
+		byte* pixels = nullptr;
+
+		if (location == Location::Ram)
+			pixels = (byte*)linearMemAlign(size, 0x80);
+		else
+			pixels = (byte*)vramMemAlign(size, 0x80);
+
+		if (pixels || s_resourceManager.evict(getMemoryPool(location), size) == 0)
+			return pixels;
 	}
 
-	Uint32 pixelsSize = width * height * 4;
+	return nullptr;
+#else
+	return new byte[size];
+#endif // _3DS
+}
 
-	byte* pixels = nullptr;
+//=============================================================================
 
+void Texture::freePixels(byte* pixels, Location location)
+{
 #ifdef _3DS
 	if (location == Location::Ram)
-		pixels = (byte*)linearMemAlign(pixelsSize, 0x80);
+		linearFree(pixels);
 	else
-		pixels = (byte*)vramMemAlign(pixelsSize, 0x80);
+		vramFree(pixels);
 #else
-	pixels = new byte[pixelsSize];
+	delete[] pixels;
 #endif // _3DS
+}
+
+//=============================================================================
+
+bool Texture::loadContainerData(const std::string& filename, Location location,
+	ResourceData& outData)
+{
+	TextureContainer container;
+
+	if (!container.open(filename))
+	{
+		return false;
+	}
+
+	// The 3DS reads the levels one after the other, the PC builds them
+#ifdef _3DS
+	int levels = container.getLevelsCount();
+#else
+	int levels = 1;
+#endif // _3DS
+
+	Uint32 pixelsSize = 0;
+
+	for (int level = 0; level < levels; ++level)
+	{
+		pixelsSize += container.getLevelSize(level);
+	}
+
+	byte* pixels = allocatePixels(pixelsSize, location);
+
+	if (!pixels)
+	{
+		return false;
+	}
+
+	bool ret = true;
+	byte* levelTexels = pixels;
+
+	for (int level = 0; level < levels && ret; ++level)
+	{
+		ret = container.readNativeLevel(level, levelTexels);
+		levelTexels += container.getLevelSize(level);
+	}
+
+	ResourceData data;
+
+	data.width = container.getWidth();
+	data.height = container.getHeight();
+	data.location = location;
+	data.format = container.getFormat();
+	data.mipLevels = container.getLevelsCount();
+	data.pixels = pixels;
+
+#ifndef _3DS
+	data.id = genTexture();
+#endif // _3DS
+
+	if (!ret)
+	{
+		deleteResourceData(data);
+		return false;
+	}
+
+	outData = data;
+
+	return true;
+}
+
+//=============================================================================
+
+bool Texture::preload(const std::string & filename, Location location)
+{
+	if (TextureContainer::isContainer(filename))
+	{
+		ResourceData data;
+
+		if (!loadContainerData(filename, location, data))
+		{
+			return false;
+		}
+
+		s_resourceManager.preloadResource(
+			getResourceName(filename, location, Format::Default), data,
+			getResourceSize(data), getMemoryPool(location));
+
+		return true;
+	}
+
+	int width = 0;
+	int height = 0;
+	byte* loadedPixels = ImageLoader::LoadFromFile(filename, width, height, PixelFormat::RGBA8);
+
+	if (!loadedPixels || width == 0 || height == 0)
+	{
+		return false;
+	}
+
+	int potWidth = util::clamp<int>(util::npot(width), MIN_SIZE, MAX_SIZE);
+	int potHeight = util::clamp<int>(util::npot(height), MIN_SIZE, MAX_SIZE);
+	Uint32 pixelsSize = TextureConverter::getMemorySize(s_defaultFormat, potWidth, potHeight);
+
+	byte* pixels = allocatePixels(pixelsSize, location);
 
 	if (!pixels)
 	{
@@ -121,23 +343,32 @@ bool Texture::preload(const std::string & filename, Location location)
 		return false;
 	}
 
-	memcpy(pixels, loadedPixels, pixelsSize);
+#ifdef _3DS
+	TextureConverter::encode(loadedPixels, width, height, s_defaultFormat,
+		s_ditheringEnabled, true, pixels, potWidth, potHeight);
+#else
+	TextureConverter::encode(loadedPixels, width, height, s_defaultFormat,
+		s_ditheringEnabled, false, pixels, potWidth, potHeight);
+#endif // _3DS
+
 	ImageLoader::FreeImage(loadedPixels);
 
 	ResourceData data;
 	
-	data.width = width;
-	data.height = height;
+	data.width = std::min(width, potWidth);
+	data.height = std::min(height, potHeight);
 	data.location = location;
+	data.format = s_defaultFormat;
 	data.pixels = pixels;
 
 #ifndef _3DS
-	glGenTextures(1, &data.id);
+	data.id = genTexture();
 #endif // _3DS
 
-	std::string resourceName = filename + (location == Location::Ram ? 'r' : 'v');
+	std::string resourceName = getResourceName(filename, location, s_defaultFormat);
 
-	s_resourceManager.preloadResource(resourceName, data);
+	s_resourceManager.preloadResource(resourceName, data,
+		getResourceSize(data), getMemoryPool(location));
 
 	return true;
 }
@@ -146,25 +377,46 @@ bool Texture::preload(const std::string & filename, Location location)
 
 bool Texture::unloadPreloaded(const std::string & filename, Location location)
 {
-	std::string resourceName = filename + (location == Location::Ram ? 'r' : 'v');
-	return s_resourceManager.unloadPreloaded(resourceName);
+	// The default format may have changed since the preload,
+	// so every format the file could have been encoded to is tried
+	static const Format kFormats[] = {
+		Format::RGBA8, Format::RGB5A1, Format::RGB565, Format::RGBA4,
+		Format::L8, Format::A8, Format::ETC1
+	};
+
+	bool ret = false;
+
+	for (auto format : kFormats)
+	{
+		if (s_resourceManager.unloadPreloaded(getResourceName(filename, location, format)))
+		{
+			ret = true;
+		}
+	}
+
+	return ret;
 }
 
 //=============================================================================
 
 Texture::Texture(void)
 	:_location(Location::Ram)
+	, _format(s_defaultFormat)
 	, _width(0)
 	, _height(0)
 	, _potWidth(0)
 	, _potHeight(0)
+	, _mipLevels(1)
 	, _aaEnabled(s_defaultAaEnabled)
 	, _repeated(false)
-	, _paramsUpdated(true)
 	, _pixels(nullptr)
+	, _lastUsedFrame(0)
+	, _residencyManaged(false)
 #ifndef _3DS
 	, _id(0)
 	, _pixelsUpdated(true)
+#else
+	, _mipLevelsDirty(false)
 #endif // _3DS
 {
 }
@@ -206,6 +458,7 @@ Texture::Texture(const byte* pixels, int width, int height,
 //=============================================================================
 
 Texture::Texture(int width, int height, const Color& color, Location location)
+	: Texture()
 {
 	create(width, height, color, location);
 }
@@ -235,6 +488,11 @@ Texture::~Texture(void)
 {
 	unload();
 
+	if (_residencyManaged)
+	{
+		TextureResidency::getInstance()->unmanage(*this);
+	}
+
 	if (s_bindedTexture == this)
 	{
 		s_bindedTexture = nullptr;
@@ -247,16 +505,23 @@ bool Texture::load(const std::string& filename, Location location)
 {
 	unload();
 
-	std::string resourceName = filename + (location == Location::Ram ? 'r' : 'v');
-	ResourceData data;
+	std::string resourceName = getFileResourceName(filename, location);
 
-	if (s_resourceManager.hasResource(filename))
-	{	
-		s_resourceManager.loadResource(resourceName, data);
+	if (loadShared(resourceName))
+	{
+		return true;
+	}
 
-		loadResourceData(data);
+	if (TextureContainer::isContainer(filename))
+	{
+		ResourceData data;
+
+		if (!loadContainerData(filename, location, data))
+		{
+			return false;
+		}
 
-		_resourceName = resourceName;
+		loadFileData(resourceName, data);
 
 		return true;
 	}
@@ -265,17 +530,117 @@ bool Texture::load(const std::string& filename, Location location)
 	int height = 0;
 	byte* pixels = ImageLoader::LoadFromFile(filename, width, height,
 		PixelFormat::RGBA8);
-	bool ret = loadPixels(pixels, width, height, PixelFormat::RGBA8, location);
+	bool ret = loadFilePixels(resourceName, pixels, width, height, location);
 	ImageLoader::FreeImage(pixels);
 
-	if (ret)
+	return ret;
+}
+
+//=============================================================================
+
+std::string Texture::getFileResourceName(const std::string& filename,
+	Location location) const
+{
+	// The format of a container is the one it was built with
+	bool container = TextureContainer::isContainer(filename);
+
+	return getResourceName(filename, location,
+		container ? Format::Default : _format);
+}
+
+//=============================================================================
+
+bool Texture::isShared(const std::string& resourceName)
+{
+	return s_resourceManager.hasResource(resourceName);
+}
+
+//=============================================================================
+
+bool Texture::loadShared(const std::string& resourceName)
+{
+	ResourceData data;
+
+	if (!s_resourceManager.loadResource(resourceName, data))
 	{
-		data = createResourceData();
-		s_resourceManager.addResource(resourceName, data);
-		_resourceName = resourceName;
+		return false;
 	}
 
-	return ret;
+	loadResourceData(data);
+
+	_resourceName = resourceName;
+
+	return true;
+}
+
+//=============================================================================
+
+void Texture::loadFileData(const std::string& resourceName, const ResourceData& data)
+{
+	addResource(resourceName, data);
+
+	loadResourceData(data);
+
+	_resourceName = resourceName;
+
+#ifndef _3DS
+	_pixelsUpdated = true;
+#endif // _3DS
+}
+
+//=============================================================================
+
+bool Texture::loadFilePixels(const std::string& resourceName, const byte* pixels,
+	int width, int height, Location location)
+{
+	if (!loadPixels(pixels, width, height, PixelFormat::RGBA8, location))
+	{
+		return false;
+	}
+
+	addResource(resourceName, createResourceData());
+
+	_resourceName = resourceName;
+
+	return true;
+}
+
+//=============================================================================
+
+bool Texture::loadFileTexels(const std::string& resourceName, const byte* texels,
+	Uint32 size, int width, int height, Format format, int mipLevels,
+	Location location)
+{
+	if (!texels || width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	byte* pixels = allocatePixels(size, location);
+
+	if (!pixels)
+	{
+		return false;
+	}
+
+	std::memcpy(pixels, texels, size);
+
+	ResourceData data;
+
+	data.width = width;
+	data.height = height;
+	data.location = location;
+	data.format = format;
+	data.mipLevels = mipLevels;
+	data.pixels = pixels;
+
+#ifndef _3DS
+	data.id = genTexture();
+#endif // _3DS
+
+	loadFileData(resourceName, data);
+
+	return true;
 }
 
 //=============================================================================
@@ -317,14 +682,21 @@ bool Texture::load(const byte* pixels, int width, int height,
 		return false;
 	}
 
+	// Only pixels loaded from memory can be overwritten in place,
+	// a file texture can be shared or cached
+	if (_resourceName.compare(0, kMemResPrefix.size(), kMemResPrefix) != 0)
+	{
+		unload();
+	}
+
 	bool ret = loadPixels(pixels, width, height, format, location);
 
-	if (ret)
+	if (ret && _resourceName.empty())
 	{
 		auto data = createResourceData();
 		data.memory = true;
 		setMemResourceName();
-		s_resourceManager.addResource(_resourceName, data);
+		addResource(_resourceName, data);
 	}
 
 	return ret;
@@ -332,6 +704,51 @@ bool Texture::load(const byte* pixels, int width, int height,
 
 //=============================================================================
 
+bool Texture::loadTexels(const byte* texels, int width, int height, Format format,
+	Location location)
+{
+	unload();
+
+	if (!texels || width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	int potWidth = util::clamp<int>(util::npot(width), MIN_SIZE, MAX_SIZE);
+	int potHeight = util::clamp<int>(util::npot(height), MIN_SIZE, MAX_SIZE);
+	Uint32 pixelsSize = TextureConverter::getMemorySize(format, potWidth, potHeight);
+
+	_pixels = allocatePixels(pixelsSize, location);
+
+	if (!_pixels)
+	{
+		return false;
+	}
+
+	std::memcpy(_pixels, texels, pixelsSize);
+
+	_location = location;
+	_format = format;
+	_width = std::min(width, potWidth);
+	_height = std::min(height, potHeight);
+	_potWidth = potWidth;
+	_potHeight = potHeight;
+
+#ifndef _3DS
+	_id = genTexture();
+	_pixelsUpdated = true;
+#endif // _3DS
+
+	auto data = createResourceData();
+	data.memory = true;
+	setMemResourceName();
+	addResource(_resourceName, data);
+
+	return true;
+}
+
+//=============================================================================
+
 bool Texture::create(int width, int height, const Color& color, Location location)
 {
 	std::vector<Color> pixels(width * height, color);
@@ -349,13 +766,13 @@ bool Texture::getPixels(std::vector<Color>& outPixels) const
 
 	outPixels.resize(_width * _height);
 
-	for (int y = 0; y < _height; ++y)
-	{
-		for (int x = 0; x < _width; ++x)
-		{
-			outPixels[x + y * _width] = getPixel(x, y);
-		}
-	}
+#ifdef _3DS
+	TextureConverter::decode(_pixels, _potWidth, _potHeight, _format, true,
+		(byte*)&outPixels.front(), _width, _height);
+#else
+	TextureConverter::decode(_pixels, _potWidth, _potHeight, _format, false,
+		(byte*)&outPixels.front(), _width, _height);
+#endif // _3DS
 
 	return true;
 }
@@ -484,19 +901,70 @@ void Texture::setPixel(int x, int y, const Color& color)
 {
 	if (x >= 0 && y >= 0 && x < _width && y < _height)
 	{
-		Uint32 index;
 #ifdef _3DS
-		index = gpuTextureIndex(x, y, _potWidth, _potHeight);
+		TextureConverter::setTexel(_pixels, _potWidth, _format, true, x, y, color);
+		markMipLevelsDirty();
+#else
+		TextureConverter::setTexel(_pixels, _potWidth, _format, false, x, y, color);
+		addDirtyRect(x, y, x + 1, y + 1);
+#endif // _3DS
+	}
+}
+
+//=============================================================================
+
+void Texture::writePixels(const Rect& region, const Color* pixels)
+{
+	int regionX = (int)region.x;
+	int regionY = (int)region.y;
+	int pitch = (int)region.width;
+
+	int left = std::max(0, regionX);
+	int top = std::max(0, regionY);
+	int right = std::min(_width, regionX + pitch);
+	int bottom = std::min(_height, regionY + (int)region.height);
+
+	if (!_pixels || !pixels || left >= right || top >= bottom)
+	{
+		return;
+	}
+
+	const byte* first = (const byte*)(pixels + (left - regionX) + (top - regionY) * pitch);
+
+#ifdef _3DS
+	TextureConverter::encodeRegion(first, pitch, left, top, right - left, bottom - top,
+		_format, s_ditheringEnabled, true, _pixels, _potWidth);
+	markMipLevelsDirty();
+#else
+	TextureConverter::encodeRegion(first, pitch, left, top, right - left, bottom - top,
+		_format, s_ditheringEnabled, false, _pixels, _potWidth);
+	addDirtyRect(left, top, right, bottom);
+#endif // _3DS
+}
+
+//=============================================================================
+
+void Texture::fill(const Rect& region, const Color& color)
+{
+	int left = std::max(0, (int)region.x);
+	int top = std::max(0, (int)region.y);
+	int right = std::min(_width, (int)region.x + (int)region.width);
+	int bottom = std::min(_height, (int)region.y + (int)region.height);
+
+	if (!_pixels || left >= right || top >= bottom)
+	{
+		return;
+	}
+
+#ifdef _3DS
+	TextureConverter::fillRegion(color, left, top, right - left, bottom - top,
+		_format, s_ditheringEnabled, true, _pixels, _potWidth);
+	markMipLevelsDirty();
 #else
-		index = x + y * _potWidth;
-		_pixelsUpdated = true;
+	TextureConverter::fillRegion(color, left, top, right - left, bottom - top,
+		_format, s_ditheringEnabled, false, _pixels, _potWidth);
+	addDirtyRect(left, top, right, bottom);
 #endif // _3DS
-
-		_pixels[index * 4 + 3] = color.r;
-		_pixels[index * 4 + 2] = color.g;
-		_pixels[index * 4 + 1] = color.b;
-		_pixels[index * 4 + 0] = color.a;
-	}
 }
 
 //=============================================================================
@@ -507,18 +975,11 @@ Color Texture::getPixel(int x, int y) const
 
 	if (x >= 0 && y >= 0 && x < _width && y < _height)
 	{
-		Uint32 index;
-
 #ifdef _3DS
-		index = gpuTextureIndex(x, y, _potWidth, _potHeight);
+		color = TextureConverter::getTexel(_pixels, _potWidth, _format, true, x, y);
 #else
-		index = x + y * _potWidth;
+		color = TextureConverter::getTexel(_pixels, _potWidth, _format, false, x, y);
 #endif // _3DS
-
-		color.r = _pixels[index * 4 + 0];
-		color.g = _pixels[index * 4 + 1];
-		color.b = _pixels[index * 4 + 2];
-		color.a = _pixels[index * 4 + 3];
 	}
 
 	return color;
@@ -528,13 +989,62 @@ Color Texture::getPixel(int x, int y) const
 
 void Texture::clear(const Color& color)
 {
-	for (int x = 0; x < _width; ++x)
+	if (!_pixels)
+	{
+		return;
+	}
+
+	if (_format != Format::RGBA8)
+	{
+		// Re-encode the whole texture, ETC1 blocks can't be filled texel by texel
+		std::vector<Color> pixels(_width * _height, color);
+#ifdef _3DS
+		TextureConverter::encode((const byte*)&pixels.front(), _width, _height, _format,
+			s_ditheringEnabled, true, _pixels, _potWidth, _potHeight);
+		markMipLevelsDirty();
+#else
+		TextureConverter::encode((const byte*)&pixels.front(), _width, _height, _format,
+			s_ditheringEnabled, false, _pixels, _potWidth, _potHeight);
+		_pixelsUpdated = true;
+#endif // _3DS
+		return;
+	}
+
+	Uint32 texel;
+	std::memcpy(&texel, (const void*)&color, sizeof(texel));
+
+#ifdef _3DS
+	texel = TextureSwizzle::swapChannels(texel);
+
+	// Whole tiles are contiguous, only the border ones need the index
+	int fullWidth = _width & ~7;
+	int fullHeight = _height & ~7;
+	Uint32* texels = (Uint32*)_pixels;
+
+	for (int ty = 0; ty < fullHeight; ty += 8)
+	{
+		std::fill_n(texels + TextureSwizzle::getTiledIndex(0, ty, _potWidth),
+			fullWidth * 8, texel);
+	}
+
+	for (int y = 0; y < _height; ++y)
 	{
-		for (int y = 0; y < _height; ++y)
+		for (int x = (y < fullHeight ? fullWidth : 0); x < _width; ++x)
 		{
-			setPixel(x, y, color);
+			texels[TextureSwizzle::getTiledIndex(x, y, _potWidth)] = texel;
 		}
 	}
+
+	markMipLevelsDirty();
+#else
+	for (int y = 0; y < _height; ++y)
+	{
+		Uint32* row = (Uint32*)_pixels + y * _potWidth;
+		std::fill(row, row + _width, texel);
+	}
+
+	_pixelsUpdated = true;
+#endif // _3DS
 }
 
 //=============================================================================
@@ -623,7 +1133,6 @@ bool Texture::scaleHq4x(void)
 void Texture::enableAntialiasing(bool enable)
 {
 	_aaEnabled = enable;
-	_paramsUpdated = true;
 }
 
 //=============================================================================
@@ -631,7 +1140,6 @@ void Texture::enableAntialiasing(bool enable)
 void Texture::setRepeated(bool repeated)
 {
 	_repeated = repeated;
-	_paramsUpdated = true;
 }
 
 //=============================================================================
@@ -641,45 +1149,182 @@ bool Texture::changeLocation(Location newLocation)
 #ifdef _3DS
 	if (newLocation != _location)
 	{
-		byte* newPixels = nullptr;
-		Uint32 pixelsSize = _potWidth * _potHeight * 4;
-
-		if (newLocation == Location::Ram &&
-			linearSpaceFree() > pixelsSize)
-		{
-			newPixels = (byte*)linearMemAlign(pixelsSize, 0x80);
-		}
-		else if (vramSpaceFree() > pixelsSize)
+		// The other textures sharing the pixels would keep the old ones
+		if (s_resourceManager.getReferenceCount(_resourceName) > 1)
 		{
-			newPixels = (byte*)vramMemAlign(pixelsSize, 0x80);
+			return false;
 		}
 
+		Uint32 pixelsSize = getMemorySize();
+		byte* newPixels = allocatePixels(pixelsSize, newLocation);
+
 		if (!newPixels)
 		{
 			return false;
 		}
 
 		memcpy(newPixels, _pixels, pixelsSize);
-
-		if (_location == Location::Ram)
-		{
-			linearFree(_pixels);
-		}
-		else
-		{
-			vramFree(_pixels);
-		}
+		freePixels(_pixels, _location);
 
 		_pixels = newPixels;
 		_location = newLocation;
+
+		auto data = createResourceData();
+		data.memory = _resourceName.compare(0, kMemResPrefix.size(), kMemResPrefix) == 0;
+		s_resourceManager.updateResource(_resourceName, data, pixelsSize,
+			getMemoryPool(newLocation));
+	}
+#endif // _3DS
+
+	return true;
+}
+
+//=============================================================================
+
+bool Texture::setFormat(Format format)
+{
+	if (format == _format)
+	{
+		return true;
+	}
+
+	if (!_pixels)
+	{
+		_format = format;
+		return true;
+	}
+
+	std::vector<Color> pixels;
+
+	if (!getPixels(pixels))
+	{
+		return false;
+	}
+
+	int width = _width;
+	int height = _height;
+	int mipLevels = _mipLevels;
+	Location location = _location;
+
+	unload();
+
+	_format = format;
+
+	if (!load((byte*)&pixels.front(), width, height, PixelFormat::RGBA8, location))
+	{
+		return false;
+	}
+
+	return mipLevels == 1 || generateMipmaps(mipLevels);
+}
+
+//=============================================================================
+
+Uint32 Texture::getMemorySize() const
+{
+	return TextureConverter::getMemorySize(_format, _potWidth, _potHeight, _mipLevels);
+}
+
+//=============================================================================
+
+bool Texture::generateMipmaps(int levels)
+{
+	if (!_pixels)
+	{
+		return false;
+	}
+
+	int maxLevels = TextureConverter::getMaxLevels(_potWidth, _potHeight);
+	levels = util::clamp<int>(levels <= 0 ? maxLevels : levels, 1, maxLevels);
+
+	// The other textures sharing the pixels would keep the old ones
+	if (s_resourceManager.getReferenceCount(_resourceName) > 1)
+	{
+		return false;
+	}
+
+#ifdef _3DS
+	std::vector<Color> pixels;
+
+	if (!getPixels(pixels))
+	{
+		return false;
+	}
+
+	Uint32 baseSize = TextureConverter::getMemorySize(_format, _potWidth, _potHeight);
+	Uint32 pixelsSize = TextureConverter::getMemorySize(_format, _potWidth, _potHeight, levels);
+	byte* newPixels = allocatePixels(pixelsSize, _location);
+
+	if (!newPixels)
+	{
+		return false;
 	}
+
+	memcpy(newPixels, _pixels, baseSize);
+	encodeMipLevels(pixels, newPixels, levels);
+
+	freePixels(_pixels, _location);
+	_pixels = newPixels;
+	_mipLevelsDirty = false;
+#else
+	_pixelsUpdated = true;
 #endif // _3DS
 
+	_mipLevels = levels;
+
+	auto data = createResourceData();
+	data.memory = _resourceName.compare(0, kMemResPrefix.size(), kMemResPrefix) == 0;
+	s_resourceManager.updateResource(_resourceName, data, getResourceSize(data),
+		getMemoryPool(_location));
+
 	return true;
 }
 
 //=============================================================================
 
+#ifdef _3DS
+void Texture::encodeMipLevels(std::vector<Color>& pixels, byte* texels, int levels)
+{
+	// Every level is halved from the previous one and tiled after it
+	std::vector<Color> halved;
+	byte* levelTexels = texels + TextureConverter::getMemorySize(_format, _potWidth, _potHeight);
+	int levelWidth = _width;
+	int levelHeight = _height;
+
+	for (int level = 1; level < levels; ++level)
+	{
+		halved.resize(((levelWidth + 1) / 2) * ((levelHeight + 1) / 2));
+		TextureConverter::downsample((const byte*)&pixels.front(), levelWidth, levelHeight,
+			(byte*)&halved.front());
+		pixels.swap(halved);
+
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+
+		int levelPotWidth = _potWidth >> level;
+		int levelPotHeight = _potHeight >> level;
+
+		TextureConverter::encode((const byte*)&pixels.front(), levelWidth, levelHeight,
+			_format, s_ditheringEnabled, true, levelTexels, levelPotWidth, levelPotHeight);
+
+		levelTexels += TextureConverter::getMemorySize(_format, levelPotWidth, levelPotHeight);
+	}
+}
+
+//=============================================================================
+
+void Texture::markMipLevelsDirty()
+{
+	// Built again once at the next bind, whatever the writes until then
+	if (_mipLevels > 1)
+	{
+		_mipLevelsDirty = true;
+	}
+}
+#endif // _3DS
+
+//=============================================================================
+
 void Texture::unload()
 {
 	if (_pixels)
@@ -692,7 +1337,14 @@ void Texture::unload()
 		_height = 0;
 		_potWidth = 0;
 		_potHeight = 0;
+		_mipLevels = 1;
 		_resourceName = "";
+
+#ifndef _3DS
+		_dirtyRects.clear();
+#else
+		_mipLevelsDirty = false;
+#endif // _3DS
 	}
 }
 
@@ -700,52 +1352,52 @@ void Texture::unload()
 
 void Texture::bind(int unit)
 {
-	if (_pixels && _width > 0 && _height > 0 && unit >= 0 && unit < 3)
+	if (_pixels && _width > 0 && _height > 0 && unit >= 0 && unit < RenderState::TEXTURE_UNITS)
 	{
+		_lastUsedFrame = TextureResidency::getFrame();
+
+		auto& state = RenderDevice::getInstance()->getRenderState();
+
 #ifdef _3DS
-		if (s_bindedTexture == nullptr || s_bindedTexture->_pixels != _pixels || _paramsUpdated)
-		{
-			GPU_TEXUNIT tex_unit = GPU_TEXUNIT(1 << unit);
-
-			u32 filter = _aaEnabled ? GPU_LINEAR : GPU_NEAREST;
-			u32 repeat = _repeated ? GPU_REPEAT : GPU_CLAMP_TO_BORDER;
-			u32 params =
-				GPU_TEXTURE_MIN_FILTER(filter) |
-				GPU_TEXTURE_MAG_FILTER(filter) |
-				GPU_TEXTURE_WRAP_S(repeat) |
-				GPU_TEXTURE_WRAP_T(repeat);
-
-			GPU_SetTextureEnable(tex_unit);
-			GPU_SetTexture(tex_unit,
-				(u32*)osConvertVirtToPhys((u32)_pixels),
-				_potWidth, _potHeight,
-				params,
-				GPU_RGBA8);
-
-			_paramsUpdated = false;
-		}
-#else
-		if (s_bindedTexture == nullptr || s_bindedTexture->_pixels != _pixels ||
-			_paramsUpdated || _pixelsUpdated)
+		u32 filter = _aaEnabled ? GPU_LINEAR : GPU_NEAREST;
+		u32 repeat = _repeated ? GPU_REPEAT : GPU_CLAMP_TO_BORDER;
+		u32 params =
+			GPU_TEXTURE_MIN_FILTER(filter) |
+			GPU_TEXTURE_MAG_FILTER(filter) |
+			GPU_TEXTURE_MIP_FILTER(filter) |
+			GPU_TEXTURE_WRAP_S(repeat) |
+			GPU_TEXTURE_WRAP_T(repeat);
+
+		// The PC rebuilds its levels with every upload
+		if (_mipLevelsDirty)
 		{
-			glActiveTexture(GL_TEXTURE0 + unit);
-			glBindTexture(GL_TEXTURE_2D, _id);
+			std::vector<Color> pixels;
 
-			if (_pixelsUpdated)
+			if (getPixels(pixels))
 			{
-				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _potWidth, _potHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, _pixels);
-				_pixelsUpdated = false;
+				encodeMipLevels(pixels, _pixels, _mipLevels);
 			}
 
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _aaEnabled ? GL_LINEAR : GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _aaEnabled ? GL_LINEAR : GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _repeated ? GL_REPEAT : GL_CLAMP_TO_BORDER);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _repeated ? GL_REPEAT : GL_CLAMP_TO_BORDER);
-			GLfloat borderColor[] = { 0.0f, 0.0f, 0.0f, 0.0f };
-			glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+			_mipLevelsDirty = false;
+		}
+
+		state.setTexture(unit, _pixels, _potWidth, _potHeight, params,
+			getGpuFormat(_format), _mipLevels);
+#else
+		state.bindTexture(unit, _id);
 
-			_paramsUpdated = false;
+		if (_pixelsUpdated)
+		{
+			uploadPixels();
+			_pixelsUpdated = false;
+			_dirtyRects.clear();
+		}
+		else if (!_dirtyRects.empty())
+		{
+			uploadDirtyRects();
 		}
+
+		applyParams();
 #endif // _3DS
 
 		s_bindedTexture = this;
@@ -754,6 +1406,25 @@ void Texture::bind(int unit)
 
 //=============================================================================
 
+#ifndef _3DS
+void Texture::applyParams()
+{
+	GLint filter = _aaEnabled ? GL_LINEAR : GL_NEAREST;
+	GLint minFilter = filter;
+
+	if (_mipLevels > 1)
+	{
+		// Trilinear when antialiased
+		minFilter = _aaEnabled ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+	}
+
+	RenderDevice::getInstance()->getRenderState().setTextureParams(_id, minFilter, filter,
+		_repeated ? GL_REPEAT : GL_CLAMP_TO_BORDER);
+}
+#endif // _3DS
+
+//=============================================================================
+
 Texture & Texture::operator=(const Texture & other)
 {
 	unload();
@@ -786,6 +1457,8 @@ void Texture::loadResourceData(const ResourceData & data)
 	_width = data.width;
 	_height = data.height;
 	_location = data.location;
+	_format = data.format;
+	_mipLevels = data.mipLevels;
 	_potWidth = util::clamp<int>(util::npot(data.width), MIN_SIZE, MAX_SIZE);
 	_potHeight = util::clamp<int>(util::npot(data.height), MIN_SIZE, MAX_SIZE);
 }
@@ -809,6 +1482,8 @@ Texture::ResourceData Texture::createResourceData()
 	data.width = _width;
 	data.height = _height;
 	data.location = _location;
+	data.format = _format;
+	data.mipLevels = _mipLevels;
 	data.pixels = _pixels;
 
 	return data;
@@ -816,30 +1491,202 @@ Texture::ResourceData Texture::createResourceData()
 
 //=============================================================================
 
+#ifndef _3DS
+void Texture::uploadPixels()
+{
+	GLint swizzle[] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+
+	switch (_format)
+	{
+	case Format::RGB5A1:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB5_A1, _potWidth, _potHeight, 0,
+			GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, _pixels);
+		break;
+
+	case Format::RGB565:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB565, _potWidth, _potHeight, 0,
+			GL_RGB, GL_UNSIGNED_SHORT_5_6_5, _pixels);
+		break;
+
+	case Format::RGBA4:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA4, _potWidth, _potHeight, 0,
+			GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, _pixels);
+		break;
+
+	case Format::L8:
+	case Format::A8:
+		// The core profile has no luminance or alpha formats, swizzle a red one
+		if (_format == Format::L8)
+		{
+			swizzle[0] = swizzle[1] = swizzle[2] = GL_RED;
+			swizzle[3] = GL_ONE;
+		}
+		else
+		{
+			swizzle[0] = swizzle[1] = swizzle[2] = GL_ONE;
+			swizzle[3] = GL_RED;
+		}
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, _potWidth, _potHeight, 0,
+			GL_RED, GL_UNSIGNED_BYTE, _pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		break;
+
+	case Format::ETC1:
+		// ETC2 decoders read ETC1 blocks as they are,
+		// the GPU can't build mip levels of compressed textures
+		if (GLEW_ARB_ES3_compatibility && _mipLevels == 1)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGB8_ETC2,
+				_potWidth, _potHeight, 0,
+				TextureConverter::getMemorySize(_format, _potWidth, _potHeight), _pixels);
+		}
+		else
+		{
+			std::vector<byte> decoded(_potWidth * _potHeight * 4);
+			TextureConverter::decode(_pixels, _potWidth, _potHeight, _format, false,
+				decoded.data(), _potWidth, _potHeight);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _potWidth, _potHeight, 0,
+				GL_RGBA, GL_UNSIGNED_BYTE, decoded.data());
+		}
+		break;
+
+	default:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _potWidth, _potHeight, 0,
+			GL_RGBA, GL_UNSIGNED_BYTE, _pixels);
+		break;
+	}
+
+	glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, _mipLevels - 1);
+
+	if (_mipLevels > 1)
+	{
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+}
+
+//=============================================================================
+
+void Texture::uploadDirtyRects()
+{
+	GLenum format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+
+	switch (_format)
+	{
+	case Format::RGB5A1:
+		type = GL_UNSIGNED_SHORT_5_5_5_1;
+		break;
+
+	case Format::RGB565:
+		format = GL_RGB;
+		type = GL_UNSIGNED_SHORT_5_6_5;
+		break;
+
+	case Format::RGBA4:
+		type = GL_UNSIGNED_SHORT_4_4_4_4;
+		break;
+
+	case Format::L8:
+	case Format::A8:
+		format = GL_RED;
+		break;
+
+	default:
+		break;
+	}
+
+	Uint32 bytesPerTexel = TextureConverter::getBitsPerPixel(_format) / 8;
+
+	// The regions are read in place from the padded texels
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, _potWidth);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (auto& rect : _dirtyRects)
+	{
+		glTexSubImage2D(GL_TEXTURE_2D, 0, rect.left, rect.top,
+			rect.right - rect.left, rect.bottom - rect.top, format, type,
+			_pixels + (rect.left + rect.top * _potWidth) * bytesPerTexel);
+	}
+
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	if (_mipLevels > 1)
+	{
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+
+	_dirtyRects.clear();
+}
+
+//=============================================================================
+
+void Texture::addDirtyRect(int left, int top, int right, int bottom)
+{
+	// ETC1 textures are uploaded whole, the blocks may be decoded first
+	if (_pixelsUpdated || _format == Format::ETC1)
+	{
+		_pixelsUpdated = true;
+		return;
+	}
+
+	for (auto& rect : _dirtyRects)
+	{
+		if (left <= rect.right && right >= rect.left &&
+			top <= rect.bottom && bottom >= rect.top)
+		{
+			rect.left = std::min(rect.left, left);
+			rect.top = std::min(rect.top, top);
+			rect.right = std::max(rect.right, right);
+			rect.bottom = std::max(rect.bottom, bottom);
+			return;
+		}
+	}
+
+	_dirtyRects.push_back({ left, top, right, bottom });
+
+	// Too many small uploads, upload their bounds instead
+	if (_dirtyRects.size() > kMaxDirtyRects)
+	{
+		DirtyRect bounds = _dirtyRects.front();
+
+		for (auto& rect : _dirtyRects)
+		{
+			bounds.left = std::min(bounds.left, rect.left);
+			bounds.top = std::min(bounds.top, rect.top);
+			bounds.right = std::max(bounds.right, rect.right);
+			bounds.bottom = std::max(bounds.bottom, rect.bottom);
+		}
+
+		_dirtyRects.assign(1, bounds);
+	}
+}
+#endif // _3DS
+
+//=============================================================================
+
 bool Texture::loadPixels(const byte * pixels, int width, int height,
 	PixelFormat format, Location location)
 {
 	int potWidth = util::clamp<int>(util::npot(width), MIN_SIZE, MAX_SIZE);
 	int potHeight = util::clamp<int>(util::npot(height), MIN_SIZE, MAX_SIZE);
 
-	Uint32 pixelsSize = potWidth * potHeight * 4;
+	Uint32 pixelsSize = TextureConverter::getMemorySize(_format, potWidth, potHeight);
 
-	if (width != _width || height != _height || location != _location)
+	// The mip levels of the old pixels are dropped with them
+	bool reused = _pixels && width == _width && height == _height &&
+		location == _location && _mipLevels == 1;
+
+	if (!reused)
 	{
 		unload();
 
-#ifdef _3DS
-		if (location == Location::Ram &&
-			linearSpaceFree() > pixelsSize)
-		{
-			_pixels = (byte*)linearMemAlign(pixelsSize, 0x80);
-		}
-		else if (vramSpaceFree() > pixelsSize)
-		{
-			_pixels = (byte*)vramMemAlign(pixelsSize, 0x80);
-		}
-#else
-		_pixels = new byte[pixelsSize];
+		_pixels = allocatePixels(pixelsSize, location);
+
+#ifndef _3DS
 		_pixelsUpdated = true;
 #endif // _3DS
 
@@ -856,57 +1703,45 @@ bool Texture::loadPixels(const byte * pixels, int width, int height,
 	_potHeight = potHeight;
 
 #ifndef _3DS
-	glGenTextures(1, &_id);
+	// A reused buffer keeps its name, the resource record and
+	// the copies of this texture still refer to it
+	if (!reused)
+	{
+		_id = genTexture();
+	}
 #endif // _3DS
 
-	for (int x = 0; x < potWidth; ++x)
+	// Expand RGB8 to RGBA8 so the conversions only handle 32 bit texels
+	std::vector<Uint32> expanded;
+
+	if (format == PixelFormat::RGB8)
 	{
-		for (int y = 0; y < potHeight; ++y)
+		expanded.resize(width * height);
+
+		for (int i = 0; i < width * height; ++i)
 		{
-			Uint32 dst_index, src_index;
+			Color color(pixels[i * 3 + 0], pixels[i * 3 + 1], pixels[i * 3 + 2]);
+			std::memcpy(&expanded[i], &color, sizeof(Uint32));
+		}
 
-#ifdef _3DS
-			dst_index = gpuTextureIndex(x, y, potWidth, potHeight);
-#else
-			dst_index = x + y * potWidth;
-#endif // _3DS
+		pixels = (const byte*)&expanded.front();
+	}
 
-			if (x < width && y < height)
-			{
-				src_index = x + y * width;
 #ifdef _3DS
-				_pixels[dst_index * 4 + 3] = pixels[src_index * 4 + 0];
-				_pixels[dst_index * 4 + 2] = pixels[src_index * 4 + 1];
-				_pixels[dst_index * 4 + 1] = pixels[src_index * 4 + 2];
-				_pixels[dst_index * 4 + 0] = format == PixelFormat::RGBA8 ?
-					pixels[src_index * 4 + 3] : 0xFF;
+	TextureConverter::encode(pixels, width, height, _format, s_ditheringEnabled,
+		true, _pixels, potWidth, potHeight);
 #else
-				_pixels[dst_index * 4 + 0] = pixels[src_index * 4 + 0];
-				_pixels[dst_index * 4 + 1] = pixels[src_index * 4 + 1];
-				_pixels[dst_index * 4 + 2] = pixels[src_index * 4 + 2];
-				_pixels[dst_index * 4 + 3] = format == PixelFormat::RGBA8 ?
-					pixels[src_index * 4 + 3] : 0xFF;
+	TextureConverter::encode(pixels, width, height, _format, s_ditheringEnabled,
+		false, _pixels, potWidth, potHeight);
 #endif // _3DS
-			}
-			else
-			{
-				((Uint32*)_pixels)[dst_index] = 0;
-			}
-		}
-	}
 
 #ifndef _3DS
-	glBindTexture(GL_TEXTURE_2D, _id);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _potWidth, _potHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, _pixels);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _aaEnabled ? GL_LINEAR : GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _aaEnabled ? GL_LINEAR : GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _repeated ? GL_REPEAT : GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _repeated ? GL_REPEAT : GL_CLAMP_TO_BORDER);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
+	RenderDevice::getInstance()->getRenderState().bindTexture(0, _id);
+	uploadPixels();
+	applyParams();
 
 	_pixelsUpdated = false;
+	_dirtyRects.clear();
 #endif // _3DS
 
 	return true;
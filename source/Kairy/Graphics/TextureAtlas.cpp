@@ -0,0 +1,642 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <Kairy/Graphics/TextureAtlas.h>
+#include <Kairy/System/File.h>
+#include <Kairy/Util/Npot.h>
+#include <Kairy/Util/Clamp.h>
+#include <algorithm>
+#include <sstream>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+struct PackRect
+{
+	int x, y, width, height;
+};
+
+// MaxRects bin packer using the best short side fit heuristic
+// (J. Jylanki, "A Thousand Ways to Pack the Bin").
+class MaxRectsPacker
+{
+public:
+	MaxRectsPacker(int width, int height)
+	{
+		_freeRects.push_back({ 0, 0, width, height });
+	}
+
+	bool insert(int width, int height, PackRect& outRect)
+	{
+		int bestShortSide = INT32_MAX;
+		int bestLongSide = INT32_MAX;
+		bool found = false;
+
+		for (const auto& free : _freeRects)
+		{
+			if (free.width < width || free.height < height)
+				continue;
+
+			int leftoverX = free.width - width;
+			int leftoverY = free.height - height;
+			int shortSide = std::min(leftoverX, leftoverY);
+			int longSide = std::max(leftoverX, leftoverY);
+
+			if (shortSide < bestShortSide ||
+				(shortSide == bestShortSide && longSide < bestLongSide))
+			{
+				outRect = { free.x, free.y, width, height };
+				bestShortSide = shortSide;
+				bestLongSide = longSide;
+				found = true;
+			}
+		}
+
+		if (!found)
+		{
+			return false;
+		}
+
+		std::vector<PackRect> splitRects;
+
+		for (std::size_t i = 0; i < _freeRects.size();)
+		{
+			if (split(_freeRects[i], outRect, splitRects))
+			{
+				_freeRects[i] = _freeRects.back();
+				_freeRects.pop_back();
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		_freeRects.insert(_freeRects.end(), splitRects.begin(), splitRects.end());
+		prune();
+		return true;
+	}
+
+private:
+	static bool contains(const PackRect& a, const PackRect& b)
+	{
+		return b.x >= a.x && b.y >= a.y &&
+			b.x + b.width <= a.x + a.width &&
+			b.y + b.height <= a.y + a.height;
+	}
+
+	static bool split(const PackRect& free, const PackRect& used,
+		std::vector<PackRect>& outRects)
+	{
+		if (used.x >= free.x + free.width || used.x + used.width <= free.x ||
+			used.y >= free.y + free.height || used.y + used.height <= free.y)
+		{
+			return false;
+		}
+
+		if (used.y > free.y)
+		{
+			outRects.push_back({ free.x, free.y, free.width, used.y - free.y });
+		}
+
+		if (used.y + used.height < free.y + free.height)
+		{
+			int top = used.y + used.height;
+			outRects.push_back({ free.x, top, free.width, free.y + free.height - top });
+		}
+
+		if (used.x > free.x)
+		{
+			outRects.push_back({ free.x, free.y, used.x - free.x, free.height });
+		}
+
+		if (used.x + used.width < free.x + free.width)
+		{
+			int left = used.x + used.width;
+			outRects.push_back({ left, free.y, free.x + free.width - left, free.height });
+		}
+
+		return true;
+	}
+
+	void prune()
+	{
+		for (std::size_t i = 0; i < _freeRects.size(); ++i)
+		{
+			for (std::size_t j = i + 1; j < _freeRects.size(); ++j)
+			{
+				if (contains(_freeRects[j], _freeRects[i]))
+				{
+					_freeRects.erase(_freeRects.begin() + i);
+					--i;
+					break;
+				}
+
+				if (contains(_freeRects[i], _freeRects[j]))
+				{
+					_freeRects.erase(_freeRects.begin() + j);
+					--j;
+				}
+			}
+		}
+	}
+
+	std::vector<PackRect> _freeRects;
+};
+
+// Smallest rect holding every non transparent pixel.
+static PackRect trimmedBounds(const Image& image)
+{
+	int left = image.getWidth(), top = image.getHeight();
+	int right = -1, bottom = -1;
+
+	for (int y = 0; y < image.getHeight(); ++y)
+	{
+		for (int x = 0; x < image.getWidth(); ++x)
+		{
+			if (image.getPixel(x, y).a == 0)
+				continue;
+
+			left = std::min(left, x);
+			right = std::max(right, x);
+			top = std::min(top, y);
+			bottom = std::max(bottom, y);
+		}
+	}
+
+	if (right < 0)
+	{
+		// Fully transparent: keep a single pixel
+		return { 0, 0, 1, 1 };
+	}
+
+	return { left, top, right - left + 1, bottom - top + 1 };
+}
+
+static Uint32 textureBytes(int width, int height)
+{
+	return util::clamp<int>(util::npot(width), Texture::MIN_SIZE, Texture::MAX_SIZE) *
+		util::clamp<int>(util::npot(height), Texture::MIN_SIZE, Texture::MAX_SIZE) * 4;
+}
+
+static std::string directoryOf(const std::string& filename)
+{
+	auto slash = filename.find_last_of("/\\");
+	return slash == std::string::npos ? "" : filename.substr(0, slash + 1);
+}
+
+//=============================================================================
+
+TextureAtlas::TextureAtlas(void)
+	: _padding(1)
+	, _trimEnabled(true)
+	, _maxPageSize(Texture::MAX_SIZE)
+{
+}
+
+//=============================================================================
+
+TextureAtlas::TextureAtlas(const std::string& filename, Texture::Location location)
+	: TextureAtlas()
+{
+	load(filename, location);
+}
+
+//=============================================================================
+
+bool TextureAtlas::addImage(const std::string& name, const Image& image)
+{
+	if (image.getWidth() == 0 || image.getHeight() == 0 || hasFrame(name))
+	{
+		return false;
+	}
+
+	for (const auto& pending : _pending)
+	{
+		if (pending.name == name)
+			return false;
+	}
+
+	_pending.push_back({ name, image });
+	return true;
+}
+
+//=============================================================================
+
+bool TextureAtlas::addImage(const std::string& name, const std::string& filename)
+{
+	Image image;
+
+	if (!image.load(filename))
+	{
+		return false;
+	}
+
+	return addImage(name, image);
+}
+
+//=============================================================================
+
+bool TextureAtlas::pack(Texture::Location location)
+{
+	struct Item
+	{
+		const PendingImage* source;
+		PackRect bounds;
+		PackRect placed;
+	};
+
+	std::vector<Item> items;
+	items.reserve(_pending.size());
+
+	for (const auto& pending : _pending)
+	{
+		Item item;
+		item.source = &pending;
+		item.bounds = _trimEnabled ? trimmedBounds(pending.image) :
+			PackRect{ 0, 0, pending.image.getWidth(), pending.image.getHeight() };
+
+		if (item.bounds.width > _maxPageSize || item.bounds.height > _maxPageSize)
+		{
+			return false;
+		}
+
+		items.push_back(item);
+	}
+
+	// Largest first: big images get the best spots, small ones fill the gaps
+	std::sort(items.begin(), items.end(), [](const Item& a, const Item& b)
+	{
+		int sideA = std::max(a.bounds.width, a.bounds.height);
+		int sideB = std::max(b.bounds.width, b.bounds.height);
+
+		if (sideA != sideB)
+			return sideA > sideB;
+
+		return a.bounds.width * a.bounds.height > b.bounds.width * b.bounds.height;
+	});
+
+	// The new images go to new pages, the frames packed before keep their
+	// place so the sprites using them stay valid
+	int firstPage = (int)_pages.size();
+
+	auto rollback = [this, firstPage, &items]()
+	{
+		for (const auto& item : items)
+		{
+			_frames.erase(item.source->name);
+		}
+
+		_pages.resize(firstPage);
+	};
+
+	std::vector<Item*> remaining;
+
+	for (auto& item : items)
+	{
+		remaining.push_back(&item);
+	}
+
+	while (!remaining.empty())
+	{
+		Uint32 area = 0;
+
+		for (auto item : remaining)
+		{
+			area += (item->bounds.width + _padding) * (item->bounds.height + _padding);
+		}
+
+		// Try the power of two page sizes by increasing area and keep the
+		// first one holding everything; otherwise fill a full sized page.
+		std::vector<std::pair<int, int>> sizes;
+
+		for (int w = Texture::MIN_SIZE; w <= _maxPageSize; w *= 2)
+		{
+			for (int h = Texture::MIN_SIZE; h <= _maxPageSize; h *= 2)
+			{
+				if ((Uint32)(w * h) >= area || (w == _maxPageSize && h == _maxPageSize))
+					sizes.push_back(std::make_pair(w, h));
+			}
+		}
+
+		std::stable_sort(sizes.begin(), sizes.end(),
+			[](const std::pair<int, int>& a, const std::pair<int, int>& b)
+		{
+			return a.first * a.second < b.first * b.second;
+		});
+
+		int pageWidth = 0, pageHeight = 0;
+		std::vector<Item*> placed, left;
+
+		for (const auto& size : sizes)
+		{
+			// The padding only separates images, the last row and
+			// column can touch the page borders.
+			MaxRectsPacker packer(size.first + _padding, size.second + _padding);
+			placed.clear();
+			left.clear();
+
+			for (auto item : remaining)
+			{
+				if (packer.insert(item->bounds.width + _padding,
+					item->bounds.height + _padding, item->placed))
+				{
+					placed.push_back(item);
+				}
+				else
+				{
+					left.push_back(item);
+				}
+			}
+
+			pageWidth = size.first;
+			pageHeight = size.second;
+
+			if (left.empty())
+				break;
+		}
+
+		if (placed.empty())
+		{
+			rollback();
+			return false;
+		}
+
+		// Blit the packed images into the page
+		std::vector<Color> pixels(pageWidth * pageHeight, Color::Transparent);
+		int page = (int)_pages.size();
+
+		for (auto item : placed)
+		{
+			const Image& image = item->source->image;
+
+			for (int y = 0; y < item->bounds.height; ++y)
+			{
+				Color* row = &pixels[item->placed.x + (item->placed.y + y) * pageWidth];
+
+				for (int x = 0; x < item->bounds.width; ++x)
+				{
+					row[x] = image.getPixel(item->bounds.x + x, item->bounds.y + y);
+				}
+			}
+
+			Frame frame;
+			frame.page = page;
+			frame.rect = Rect((float)item->placed.x, (float)item->placed.y,
+				(float)item->bounds.width, (float)item->bounds.height);
+			frame.offset = Vec2((float)item->bounds.x, (float)item->bounds.y);
+			frame.sourceSize = Vec2((float)image.getWidth(), (float)image.getHeight());
+			frame.trimmed = item->bounds.width != image.getWidth() ||
+				item->bounds.height != image.getHeight();
+
+			_frames[item->source->name] = frame;
+		}
+
+		std::unique_ptr<Texture> texture(new Texture());
+
+		if (!texture->load((const byte*)&pixels.front(), pageWidth, pageHeight,
+			PixelFormat::RGBA8, location))
+		{
+			rollback();
+			return false;
+		}
+
+		_pages.push_back(std::move(texture));
+		remaining.swap(left);
+	}
+
+	_pending.clear();
+	return true;
+}
+
+//=============================================================================
+
+bool TextureAtlas::load(const std::string& filename, Texture::Location location)
+{
+	std::vector<std::string> lines;
+
+	if (!File::readAllLines(filename, lines))
+	{
+		return false;
+	}
+
+	clear();
+
+	std::string directory = directoryOf(filename);
+
+	for (const auto& line : lines)
+	{
+		std::istringstream stream(line);
+		std::string type;
+		stream >> type;
+
+		if (type == "page")
+		{
+			std::string pageFile;
+			stream >> pageFile;
+
+			std::unique_ptr<Texture> texture(new Texture());
+
+			if (!texture->load(directory + pageFile, location))
+			{
+				clear();
+				return false;
+			}
+
+			_pages.push_back(std::move(texture));
+		}
+		else if (type == "frame")
+		{
+			Frame frame;
+			stream >> frame.page
+				>> frame.rect.x >> frame.rect.y
+				>> frame.rect.width >> frame.rect.height
+				>> frame.offset.x >> frame.offset.y
+				>> frame.sourceSize.x >> frame.sourceSize.y;
+
+			std::string name;
+			std::getline(stream >> std::ws, name);
+
+			if (stream.fail() || name.empty() ||
+				frame.page < 0 || frame.page >= (int)_pages.size())
+			{
+				clear();
+				return false;
+			}
+
+			frame.trimmed = frame.rect.width != frame.sourceSize.x ||
+				frame.rect.height != frame.sourceSize.y;
+
+			_frames[name] = frame;
+		}
+	}
+
+	return true;
+}
+
+//=============================================================================
+
+bool TextureAtlas::save(const std::string& filename) const
+{
+	std::string directory = directoryOf(filename);
+	std::string basename = filename.substr(directory.length());
+	auto dot = basename.find_last_of('.');
+
+	if (dot != std::string::npos)
+	{
+		basename = basename.substr(0, dot);
+	}
+
+	std::vector<std::string> lines;
+
+	for (std::size_t i = 0; i < _pages.size(); ++i)
+	{
+		std::ostringstream pageFile;
+		pageFile << basename << "_" << i << ".png";
+
+		if (!_pages[i]->save(directory + pageFile.str()))
+		{
+			return false;
+		}
+
+		lines.push_back("page " + pageFile.str());
+	}
+
+	for (const auto& pair : _frames)
+	{
+		const Frame& frame = pair.second;
+		std::ostringstream line;
+
+		// The name goes last so it may contain spaces
+		line << "frame " << frame.page << " "
+			<< frame.rect.x << " " << frame.rect.y << " "
+			<< frame.rect.width << " " << frame.rect.height << " "
+			<< frame.offset.x << " " << frame.offset.y << " "
+			<< frame.sourceSize.x << " " << frame.sourceSize.y << " "
+			<< pair.first;
+
+		lines.push_back(line.str());
+	}
+
+	return File::writeAllLines(filename, lines);
+}
+
+//=============================================================================
+
+void TextureAtlas::clear()
+{
+	_pending.clear();
+	_pages.clear();
+	_frames.clear();
+}
+
+//=============================================================================
+
+void TextureAtlas::setMaxPageSize(int size)
+{
+	_maxPageSize = util::clamp<int>(util::npot(size), Texture::MIN_SIZE, Texture::MAX_SIZE);
+}
+
+//=============================================================================
+
+const TextureAtlas::Frame* TextureAtlas::getFrame(const std::string& name) const
+{
+	auto it = _frames.find(name);
+	return it != _frames.end() ? &it->second : nullptr;
+}
+
+//=============================================================================
+
+std::vector<Rect> TextureAtlas::getFrameRects(const std::vector<std::string>& names) const
+{
+	std::vector<Rect> rects;
+	rects.reserve(names.size());
+
+	for (const auto& name : names)
+	{
+		auto frame = getFrame(name);
+
+		if (!frame)
+		{
+			return std::vector<Rect>();
+		}
+
+		rects.push_back(frame->rect);
+	}
+
+	return rects;
+}
+
+//=============================================================================
+
+float TextureAtlas::getEfficiency() const
+{
+	float pagesArea = 0.0f;
+	float usedArea = 0.0f;
+
+	for (const auto& page : _pages)
+	{
+		pagesArea += (float)page->getWidth() * page->getHeight();
+	}
+
+	for (const auto& pair : _frames)
+	{
+		usedArea += pair.second.rect.width * pair.second.rect.height;
+	}
+
+	return pagesArea > 0.0f ? usedArea / pagesArea : 0.0f;
+}
+
+//=============================================================================
+
+Uint32 TextureAtlas::getMemoryUsage() const
+{
+	Uint32 bytes = 0;
+
+	for (const auto& page : _pages)
+	{
+		bytes += page->getRealWidth() * page->getRealHeight() * 4;
+	}
+
+	return bytes;
+}
+
+//=============================================================================
+
+int TextureAtlas::getMemorySaved() const
+{
+	Uint32 standalone = 0;
+
+	for (const auto& pair : _frames)
+	{
+		standalone += textureBytes((int)pair.second.sourceSize.x,
+			(int)pair.second.sourceSize.y);
+	}
+
+	return (int)standalone - (int)getMemoryUsage();
+}
+
+//=============================================================================
+
+NS_KAIRY_END
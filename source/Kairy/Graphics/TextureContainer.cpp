@@ -0,0 +1,364 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <Kairy/Graphics/TextureContainer.h>
+#include <Kairy/Graphics/TextureConverter.h>
+#include <Kairy/System/File.h>
+#include <Kairy/Util/Endian.h>
+#include <Kairy/Util/Npot.h>
+#include <Kairy/Util/Clamp.h>
+#include <Kairy/Ext/miniz.h>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+static const char kMagic[4] = { 'K', 'T', 'E', 'X' };
+static const std::string kExtension = ".ktex";
+static const Uint32 kHeaderSize = 20;
+static const Uint32 kLevelEntrySize = 12;
+static const Uint32 kPayloadAlign = 16;
+
+//=============================================================================
+
+static inline void writeUshortLE(byte* bytes, Uint16 value)
+{
+	bytes[0] = (byte)value;
+	bytes[1] = (byte)(value >> 8);
+}
+
+//=============================================================================
+
+static inline void writeUintLE(byte* bytes, Uint32 value)
+{
+	bytes[0] = (byte)value;
+	bytes[1] = (byte)(value >> 8);
+	bytes[2] = (byte)(value >> 16);
+	bytes[3] = (byte)(value >> 24);
+}
+
+//=============================================================================
+
+bool TextureContainer::save(const std::string& filename, const byte* pixels,
+	int width, int height, Texture::Format format, bool tiled,
+	int levels, Compression compression, bool dither)
+{
+	if (!pixels || width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	int potWidth = util::clamp<int>(util::npot(width), Texture::MIN_SIZE, Texture::MAX_SIZE);
+	int potHeight = util::clamp<int>(util::npot(height), Texture::MIN_SIZE, Texture::MAX_SIZE);
+
+	width = std::min(width, potWidth);
+	height = std::min(height, potHeight);
+
+	// Every level must still be a whole number of tiles
+	int maxLevels = std::min<int>(MAX_LEVELS,
+		TextureConverter::getMaxLevels(potWidth, potHeight));
+
+	levels = util::clamp<int>(levels, 1, maxLevels);
+
+	std::vector<std::vector<byte>> payloads(levels);
+	std::vector<Level> table(levels);
+
+	std::vector<byte> levelPixels(pixels, pixels + width * height * 4);
+	int levelWidth = width;
+	int levelHeight = height;
+
+	for (int level = 0; level < levels; ++level)
+	{
+		int levelPotWidth = potWidth >> level;
+		int levelPotHeight = potHeight >> level;
+
+		if (level > 0)
+		{
+			std::vector<byte> halved(((levelWidth + 1) / 2) * ((levelHeight + 1) / 2) * 4);
+			TextureConverter::downsample(levelPixels.data(), levelWidth, levelHeight, halved.data());
+			levelPixels.swap(halved);
+			levelWidth = (levelWidth + 1) / 2;
+			levelHeight = (levelHeight + 1) / 2;
+		}
+
+		Uint32 rawSize = TextureConverter::getMemorySize(format, levelPotWidth, levelPotHeight);
+		std::vector<byte> texels(rawSize);
+
+		TextureConverter::encode(levelPixels.data(), levelWidth, levelHeight,
+			format, dither, tiled, texels.data(), levelPotWidth, levelPotHeight);
+
+		table[level].rawSize = rawSize;
+		payloads[level].swap(texels);
+
+		if (compression == Compression::Zlib)
+		{
+			mz_ulong packedSize = mz_compressBound(rawSize);
+			std::vector<byte> packed(packedSize);
+
+			if (mz_compress2(packed.data(), &packedSize, payloads[level].data(),
+				rawSize, MZ_BEST_COMPRESSION) == MZ_OK && packedSize < rawSize)
+			{
+				packed.resize(packedSize);
+				payloads[level].swap(packed);
+			}
+		}
+
+		table[level].size = (Uint32)payloads[level].size();
+	}
+
+	// Header and level table, then the payloads aligned to 16 bytes
+	Uint32 offset = kHeaderSize + kLevelEntrySize * levels;
+	std::vector<byte> header(offset, 0);
+
+	std::memcpy(&header[0], kMagic, sizeof(kMagic));
+	writeUshortLE(&header[4], VERSION);
+	header[6] = (byte)format;
+	header[7] = tiled ? 1 : 0;
+	header[8] = (byte)compression;
+	header[9] = (byte)levels;
+	writeUshortLE(&header[12], (Uint16)width);
+	writeUshortLE(&header[14], (Uint16)height);
+	writeUshortLE(&header[16], (Uint16)potWidth);
+	writeUshortLE(&header[18], (Uint16)potHeight);
+
+	for (int level = 0; level < levels; ++level)
+	{
+		offset = (offset + kPayloadAlign - 1) & ~(kPayloadAlign - 1);
+		table[level].offset = offset;
+		offset += table[level].size;
+
+		byte* entry = &header[kHeaderSize + kLevelEntrySize * level];
+		writeUintLE(entry + 0, table[level].offset);
+		writeUintLE(entry + 4, table[level].size);
+		writeUintLE(entry + 8, table[level].rawSize);
+	}
+
+	std::ofstream stream(filename, std::ios::binary);
+
+	if (!stream.is_open())
+	{
+		return false;
+	}
+
+	stream.write((const char*)header.data(), header.size());
+
+	for (int level = 0; level < levels; ++level)
+	{
+		static const char padding[kPayloadAlign] = { 0 };
+		stream.write(padding, table[level].offset - (Uint32)stream.tellp());
+		stream.write((const char*)payloads[level].data(), payloads[level].size());
+	}
+
+	return stream.good();
+}
+
+//=============================================================================
+
+bool TextureContainer::isContainer(const std::string& filename)
+{
+	return File::getExtension(filename) == kExtension;
+}
+
+//=============================================================================
+
+TextureContainer::TextureContainer(void)
+	: _width(0)
+	, _height(0)
+	, _potWidth(0)
+	, _potHeight(0)
+	, _format(Texture::Format::Default)
+	, _tiled(false)
+{
+}
+
+//=============================================================================
+
+TextureContainer::~TextureContainer(void)
+{
+	close();
+}
+
+//=============================================================================
+
+bool TextureContainer::open(const std::string& filename)
+{
+	close();
+
+	_stream.open(filename, std::ios::binary);
+
+	byte header[kHeaderSize];
+
+	if (!_stream.read((char*)header, kHeaderSize) ||
+		std::memcmp(header, kMagic, sizeof(kMagic)) != 0 ||
+		util::bytesToUshortLE(&header[4]) != VERSION ||
+		header[6] > (byte)Texture::Format::ETC1 ||
+		header[9] < 1 || header[9] > MAX_LEVELS)
+	{
+		close();
+		return false;
+	}
+
+	_format = (Texture::Format)header[6];
+	_tiled = (header[7] & 1) != 0;
+	_width = util::bytesToUshortLE(&header[12]);
+	_height = util::bytesToUshortLE(&header[14]);
+	_potWidth = util::bytesToUshortLE(&header[16]);
+	_potHeight = util::bytesToUshortLE(&header[18]);
+
+	// The texture derives its real size from the size, they must agree
+	if (_width == 0 || _height == 0 ||
+		_potWidth != util::clamp<int>(util::npot(_width), Texture::MIN_SIZE, Texture::MAX_SIZE) ||
+		_potHeight != util::clamp<int>(util::npot(_height), Texture::MIN_SIZE, Texture::MAX_SIZE))
+	{
+		close();
+		return false;
+	}
+
+	_levels.resize(header[9]);
+
+	for (std::size_t level = 0; level < _levels.size(); ++level)
+	{
+		byte entry[kLevelEntrySize];
+
+		if (!_stream.read((char*)entry, kLevelEntrySize))
+		{
+			close();
+			return false;
+		}
+
+		_levels[level].offset = util::bytesToUintLE(entry + 0);
+		_levels[level].size = util::bytesToUintLE(entry + 4);
+		_levels[level].rawSize = util::bytesToUintLE(entry + 8);
+
+		if (_levels[level].rawSize != getLevelSize((int)level))
+		{
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//=============================================================================
+
+void TextureContainer::close()
+{
+	if (_stream.is_open())
+	{
+		_stream.close();
+	}
+
+	_stream.clear();
+	_levels.clear();
+	_width = 0;
+	_height = 0;
+	_potWidth = 0;
+	_potHeight = 0;
+}
+
+//=============================================================================
+
+bool TextureContainer::readLevel(int level, byte* outTexels)
+{
+	if (!_stream.is_open() || level < 0 || level >= (int)_levels.size() || !outTexels)
+	{
+		return false;
+	}
+
+	const Level& entry = _levels[level];
+
+	_stream.seekg(entry.offset);
+
+	// Raw levels go straight to the destination
+	if (entry.size == entry.rawSize)
+	{
+		return (bool)_stream.read((char*)outTexels, entry.size);
+	}
+
+	std::vector<byte> packed(entry.size);
+
+	if (!_stream.read((char*)packed.data(), entry.size))
+	{
+		return false;
+	}
+
+	mz_ulong rawSize = entry.rawSize;
+
+	return mz_uncompress(outTexels, &rawSize, packed.data(), entry.size) == MZ_OK &&
+		rawSize == entry.rawSize;
+}
+
+//=============================================================================
+
+bool TextureContainer::readNativeLevel(int level, byte* outTexels)
+{
+#ifdef _3DS
+	bool tiled = true;
+#else
+	bool tiled = false;
+#endif // _3DS
+
+	if (_tiled == tiled)
+	{
+		return readLevel(level, outTexels);
+	}
+
+	int potWidth = _potWidth >> level;
+	int potHeight = _potHeight >> level;
+	std::vector<byte> texels(getLevelSize(level));
+
+	if (!readLevel(level, texels.data()))
+	{
+		return false;
+	}
+
+	// ETC1 blocks only move, a second encode would lose quality
+	if (_format == Texture::Format::ETC1)
+	{
+		TextureConverter::swapEtc1Layout(texels.data(), potWidth, potHeight,
+			_tiled, outTexels);
+
+		return true;
+	}
+
+	std::vector<byte> decoded(potWidth * potHeight * 4);
+
+	TextureConverter::decode(texels.data(), potWidth, potHeight,
+		_format, _tiled, decoded.data(), potWidth, potHeight);
+	TextureConverter::encode(decoded.data(), potWidth, potHeight,
+		_format, false, tiled, outTexels, potWidth, potHeight);
+
+	return true;
+}
+
+//=============================================================================
+
+Uint32 TextureContainer::getLevelSize(int level) const
+{
+	return TextureConverter::getMemorySize(_format, _potWidth >> level, _potHeight >> level);
+}
+
+//=============================================================================
+
+NS_KAIRY_END
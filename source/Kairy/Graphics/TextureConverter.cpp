@@ -0,0 +1,885 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <Kairy/Graphics/TextureConverter.h>
+#include <Kairy/Graphics/TextureSwizzle.h>
+#include <Kairy/Util/Clamp.h>
+#include <climits>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+// ETC1 intensity modifiers, the selectors pick +a, +b, -a or -b
+static const int kEtc1Modifiers[8][2] =
+{
+	{ 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 },
+	{ 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+};
+
+// Ordered dithering thresholds
+static const int kBayer4x4[4][4] =
+{
+	{ 0, 8, 2, 10 },
+	{ 12, 4, 14, 6 },
+	{ 3, 11, 1, 9 },
+	{ 15, 7, 13, 5 }
+};
+
+//=============================================================================
+
+static inline Uint32 quantize(int value, int bits, int threshold)
+{
+	int levels = (1 << bits) - 1;
+
+	if (threshold >= 0)
+	{
+		// Shift by -1/2 to +1/2 of a quantization step
+		value += ((threshold * 2 - 15) * 255) / (levels * 32);
+		value = util::clamp<int>(value, 0, 255);
+	}
+
+	return (value * levels + 127) / 255;
+}
+
+//=============================================================================
+
+static inline byte expand(Uint32 value, int bits)
+{
+	int levels = (1 << bits) - 1;
+	return (byte)((value * 255 + levels / 2) / levels);
+}
+
+//=============================================================================
+
+static inline Uint32 packTexel(const Color& color, Texture::Format format, int threshold)
+{
+	switch (format)
+	{
+	case Texture::Format::RGB5A1:
+		return quantize(color.r, 5, threshold) << 11 |
+			quantize(color.g, 5, threshold) << 6 |
+			quantize(color.b, 5, threshold) << 1 |
+			(color.a >= 128 ? 1 : 0);
+
+	case Texture::Format::RGB565:
+		return quantize(color.r, 5, threshold) << 11 |
+			quantize(color.g, 6, threshold) << 5 |
+			quantize(color.b, 5, threshold);
+
+	case Texture::Format::RGBA4:
+		return quantize(color.r, 4, threshold) << 12 |
+			quantize(color.g, 4, threshold) << 8 |
+			quantize(color.b, 4, threshold) << 4 |
+			quantize(color.a, 4, threshold);
+
+	case Texture::Format::L8:
+		return (color.r * 77 + color.g * 150 + color.b * 29) >> 8;
+
+	case Texture::Format::A8:
+		return color.a;
+
+	default:
+		return 0;
+	}
+}
+
+//=============================================================================
+
+static inline Color unpackTexel(Uint32 value, Texture::Format format)
+{
+	switch (format)
+	{
+	case Texture::Format::RGB5A1:
+		return Color(expand(value >> 11 & 0x1F, 5), expand(value >> 6 & 0x1F, 5),
+			expand(value >> 1 & 0x1F, 5), (value & 1) ? 255 : 0);
+
+	case Texture::Format::RGB565:
+		return Color(expand(value >> 11 & 0x1F, 5), expand(value >> 5 & 0x3F, 6),
+			expand(value & 0x1F, 5));
+
+	case Texture::Format::RGBA4:
+		return Color(expand(value >> 12 & 0xF, 4), expand(value >> 8 & 0xF, 4),
+			expand(value >> 4 & 0xF, 4), expand(value & 0xF, 4));
+
+	case Texture::Format::L8:
+		return Color((byte)value, (byte)value, (byte)value);
+
+	case Texture::Format::A8:
+		return Color(255, 255, 255, (byte)value);
+
+	default:
+		return Color::Transparent;
+	}
+}
+
+//=============================================================================
+
+static inline Uint32 texelIndex(int x, int y, int potWidth, bool tiled)
+{
+	return tiled ? TextureSwizzle::getTiledIndex(x, y, potWidth) : x + y * potWidth;
+}
+
+//=============================================================================
+
+static inline Uint32 etc1BlockIndex(int blockX, int blockY, int potWidth, bool tiled)
+{
+	// A 8x8 tile holds 2x2 blocks in Z order
+	if (tiled)
+	{
+		return ((((blockY >> 1) * (potWidth >> 3) + (blockX >> 1)) << 2) +
+			(blockX & 1) + ((blockY & 1) << 1));
+	}
+
+	return blockX + blockY * (potWidth >> 2);
+}
+
+//=============================================================================
+
+static inline Uint64 readEtc1Block(const byte* texels, Uint32 index, bool tiled)
+{
+	const byte* bytes = texels + index * 8;
+	Uint64 block = 0;
+
+	for (int i = 0; i < 8; ++i)
+	{
+		block |= (Uint64)bytes[i] << (tiled ? i * 8 : 56 - i * 8);
+	}
+
+	return block;
+}
+
+//=============================================================================
+
+static inline void writeEtc1Block(byte* texels, Uint32 index, bool tiled, Uint64 block)
+{
+	byte* bytes = texels + index * 8;
+
+	for (int i = 0; i < 8; ++i)
+	{
+		bytes[i] = (byte)(block >> (tiled ? i * 8 : 56 - i * 8));
+	}
+}
+
+//=============================================================================
+
+// Finds the modifier table and the selectors of a sub-block for a base color.
+// Selectors are stored by pixel (y * 4 + x), the return value is the error.
+static int fitEtc1Subblock(const Color* block, bool flip, int subblock,
+	const int* base, int& outTable, int* outSelectors)
+{
+	int positions[8];
+
+	for (int i = 0; i < 8; ++i)
+	{
+		int x = flip ? (i & 3) : subblock * 2 + (i & 1);
+		int y = flip ? subblock * 2 + (i >> 2) : (i >> 1);
+		positions[i] = y * 4 + x;
+	}
+
+	int bestError = INT_MAX;
+
+	for (int table = 0; table < 8; ++table)
+	{
+		int error = 0;
+		int selectors[8];
+
+		for (int i = 0; i < 8 && error < bestError; ++i)
+		{
+			const Color& color = block[positions[i]];
+			int best = INT_MAX;
+
+			for (int selector = 0; selector < 4; ++selector)
+			{
+				int modifier = kEtc1Modifiers[table][selector & 1];
+
+				if (selector & 2)
+				{
+					modifier = -modifier;
+				}
+
+				int dr = util::clamp<int>(base[0] + modifier, 0, 255) - color.r;
+				int dg = util::clamp<int>(base[1] + modifier, 0, 255) - color.g;
+				int db = util::clamp<int>(base[2] + modifier, 0, 255) - color.b;
+				int distance = dr * dr + dg * dg + db * db;
+
+				if (distance < best)
+				{
+					best = distance;
+					selectors[i] = selector;
+				}
+			}
+
+			error += best;
+		}
+
+		if (error < bestError)
+		{
+			bestError = error;
+			outTable = table;
+
+			for (int i = 0; i < 8; ++i)
+			{
+				outSelectors[positions[i]] = selectors[i];
+			}
+		}
+	}
+
+	return bestError;
+}
+
+//=============================================================================
+
+// Writes the texels of a region of an ETC1 texture, the blocks partially
+// covered are decoded first to keep the texels outside the region.
+template <typename PixelFunc>
+static void writeEtc1Region(byte* texels, int potWidth, bool tiled,
+	int x, int y, int width, int height, PixelFunc pixelAt)
+{
+	Color block[16];
+
+	for (int blockY = y >> 2; blockY <= (y + height - 1) >> 2; ++blockY)
+	{
+		for (int blockX = x >> 2; blockX <= (x + width - 1) >> 2; ++blockX)
+		{
+			Uint32 index = etc1BlockIndex(blockX, blockY, potWidth, tiled);
+			int left = blockX * 4;
+			int top = blockY * 4;
+
+			if (left < x || top < y || left + 4 > x + width || top + 4 > y + height)
+			{
+				TextureConverter::decodeEtc1Block(readEtc1Block(texels, index, tiled), block);
+			}
+
+			for (int i = 0; i < 16; ++i)
+			{
+				int texelX = left + (i & 3);
+				int texelY = top + (i >> 2);
+
+				if (texelX >= x && texelY >= y && texelX < x + width && texelY < y + height)
+				{
+					block[i] = pixelAt(texelX - x, texelY - y);
+				}
+			}
+
+			writeEtc1Block(texels, index, tiled, TextureConverter::encodeEtc1Block(block));
+		}
+	}
+}
+
+//=============================================================================
+
+Uint32 TextureConverter::getBitsPerPixel(Texture::Format format)
+{
+	switch (format)
+	{
+	case Texture::Format::RGBA8:
+		return 32;
+	case Texture::Format::RGB5A1:
+	case Texture::Format::RGB565:
+	case Texture::Format::RGBA4:
+		return 16;
+	case Texture::Format::L8:
+	case Texture::Format::A8:
+		return 8;
+	case Texture::Format::ETC1:
+		return 4;
+	}
+
+	return 32;
+}
+
+//=============================================================================
+
+Uint32 TextureConverter::getMemorySize(Texture::Format format, int potWidth, int potHeight,
+	int levels)
+{
+	Uint32 size = 0;
+
+	for (int level = 0; level < levels; ++level)
+	{
+		size += (potWidth >> level) * (potHeight >> level) * getBitsPerPixel(format) / 8;
+	}
+
+	return size;
+}
+
+//=============================================================================
+
+int TextureConverter::getMaxLevels(int potWidth, int potHeight)
+{
+	int levels = 1;
+
+	while ((potWidth >> levels) >= Texture::MIN_SIZE &&
+		(potHeight >> levels) >= Texture::MIN_SIZE)
+	{
+		++levels;
+	}
+
+	return levels;
+}
+
+//=============================================================================
+
+void TextureConverter::downsample(const byte* pixels, int width, int height, byte* outPixels)
+{
+	int outWidth = std::max(1, (width + 1) / 2);
+	int outHeight = std::max(1, (height + 1) / 2);
+
+	const Uint32* src = (const Uint32*)pixels;
+	Uint32* dst = (Uint32*)outPixels;
+
+	for (int y = 0; y < outHeight; ++y)
+	{
+		const Uint32* row0 = src + std::min(y * 2, height - 1) * width;
+		const Uint32* row1 = src + std::min(y * 2 + 1, height - 1) * width;
+
+		for (int x = 0; x < outWidth; ++x)
+		{
+			int x0 = std::min(x * 2, width - 1);
+			int x1 = std::min(x * 2 + 1, width - 1);
+
+			Uint32 a = row0[x0], b = row0[x1], c = row1[x0], d = row1[x1];
+
+			// Two channels per 16 bits lane, four texels sum up to 10 bits
+			Uint32 even = (a & 0x00FF00FF) + (b & 0x00FF00FF) +
+				(c & 0x00FF00FF) + (d & 0x00FF00FF) + 0x00020002;
+			Uint32 odd = (a >> 8 & 0x00FF00FF) + (b >> 8 & 0x00FF00FF) +
+				(c >> 8 & 0x00FF00FF) + (d >> 8 & 0x00FF00FF) + 0x00020002;
+
+			dst[x + y * outWidth] = (even >> 2 & 0x00FF00FF) | (odd << 6 & 0xFF00FF00);
+		}
+	}
+}
+
+//=============================================================================
+
+void TextureConverter::encode(const byte* pixels, int width, int height,
+	Texture::Format format, bool dither, bool tiled,
+	byte* outTexels, int potWidth, int potHeight)
+{
+	if (format == Texture::Format::RGBA8)
+	{
+		if (tiled)
+			TextureSwizzle::tile(pixels, width, height, (Uint32*)outTexels, potWidth, potHeight);
+		else
+			TextureSwizzle::pad(pixels, width, height, (Uint32*)outTexels, potWidth, potHeight);
+
+		return;
+	}
+
+	if (format == Texture::Format::ETC1)
+	{
+		Color block[16];
+
+		for (int blockY = 0; blockY < potHeight / 4; ++blockY)
+		{
+			for (int blockX = 0; blockX < potWidth / 4; ++blockX)
+			{
+				for (int i = 0; i < 16; ++i)
+				{
+					int x = blockX * 4 + (i & 3);
+					int y = blockY * 4 + (i >> 2);
+
+					// Repeat the border so the padding doesn't bleed
+					const byte* pixel = pixels +
+						(std::min(x, width - 1) + std::min(y, height - 1) * width) * 4;
+					block[i] = Color(pixel[0], pixel[1], pixel[2], pixel[3]);
+				}
+
+				writeEtc1Block(outTexels, etc1BlockIndex(blockX, blockY, potWidth, tiled),
+					tiled, encodeEtc1Block(block));
+			}
+		}
+
+		return;
+	}
+
+	bool wide = getBitsPerPixel(format) == 16;
+
+	for (int y = 0; y < potHeight; ++y)
+	{
+		for (int x = 0; x < potWidth; ++x)
+		{
+			Uint32 value = 0;
+
+			if (x < width && y < height)
+			{
+				const byte* pixel = pixels + (x + y * width) * 4;
+				value = packTexel(Color(pixel[0], pixel[1], pixel[2], pixel[3]), format,
+					dither ? kBayer4x4[y & 3][x & 3] : -1);
+			}
+
+			Uint32 index = texelIndex(x, y, potWidth, tiled);
+
+			if (wide)
+				((Uint16*)outTexels)[index] = (Uint16)value;
+			else
+				outTexels[index] = (byte)value;
+		}
+	}
+}
+
+//=============================================================================
+
+void TextureConverter::decode(const byte* texels, int potWidth, int potHeight,
+	Texture::Format format, bool tiled,
+	byte* outPixels, int width, int height)
+{
+	width = std::min(width, potWidth);
+	height = std::min(height, potHeight);
+
+	if (format == Texture::Format::RGBA8)
+	{
+		if (tiled)
+			TextureSwizzle::untile((const Uint32*)texels, potWidth, potHeight, outPixels, width, height);
+		else
+			TextureSwizzle::unpad((const Uint32*)texels, potWidth, potHeight, outPixels, width, height);
+
+		return;
+	}
+
+	if (format == Texture::Format::ETC1)
+	{
+		Color block[16];
+
+		for (int blockY = 0; blockY < (height + 3) / 4; ++blockY)
+		{
+			for (int blockX = 0; blockX < (width + 3) / 4; ++blockX)
+			{
+				decodeEtc1Block(readEtc1Block(texels,
+					etc1BlockIndex(blockX, blockY, potWidth, tiled), tiled), block);
+
+				for (int i = 0; i < 16; ++i)
+				{
+					int x = blockX * 4 + (i & 3);
+					int y = blockY * 4 + (i >> 2);
+
+					if (x < width && y < height)
+					{
+						std::memcpy(outPixels + (x + y * width) * 4, (const void*)&block[i], 4);
+					}
+				}
+			}
+		}
+
+		return;
+	}
+
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			Color color = getTexel(texels, potWidth, format, tiled, x, y);
+			std::memcpy(outPixels + (x + y * width) * 4, (const void*)&color, 4);
+		}
+	}
+}
+
+//=============================================================================
+
+void TextureConverter::encodeRegion(const byte* pixels, int pitch,
+	int x, int y, int width, int height,
+	Texture::Format format, bool dither, bool tiled, byte* outTexels, int potWidth)
+{
+	if (width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	if (format == Texture::Format::ETC1)
+	{
+		writeEtc1Region(outTexels, potWidth, tiled, x, y, width, height,
+			[&](int px, int py)
+		{
+			const byte* pixel = pixels + (px + py * pitch) * 4;
+			return Color(pixel[0], pixel[1], pixel[2], pixel[3]);
+		});
+
+		return;
+	}
+
+	for (int row = 0; row < height; ++row)
+	{
+		const byte* pixel = pixels + row * pitch * 4;
+		int texelY = y + row;
+
+		if (format == Texture::Format::RGBA8 && !tiled)
+		{
+			std::memcpy(outTexels + (x + texelY * potWidth) * 4, pixel, width * 4);
+			continue;
+		}
+
+		for (int texelX = x; texelX < x + width; ++texelX, pixel += 4)
+		{
+			Uint32 index = texelIndex(texelX, texelY, potWidth, tiled);
+
+			switch (format)
+			{
+			case Texture::Format::RGBA8:
+			{
+				Uint32 texel;
+				std::memcpy(&texel, pixel, sizeof(texel));
+				((Uint32*)outTexels)[index] = TextureSwizzle::swapChannels(texel);
+				break;
+			}
+
+			case Texture::Format::L8:
+			case Texture::Format::A8:
+				outTexels[index] = (byte)packTexel(Color(pixel[0], pixel[1], pixel[2], pixel[3]),
+					format, -1);
+				break;
+
+			default:
+				((Uint16*)outTexels)[index] = (Uint16)packTexel(
+					Color(pixel[0], pixel[1], pixel[2], pixel[3]), format,
+					dither ? kBayer4x4[texelY & 3][texelX & 3] : -1);
+				break;
+			}
+		}
+	}
+}
+
+//=============================================================================
+
+void TextureConverter::fillRegion(const Color& color, int x, int y, int width, int height,
+	Texture::Format format, bool dither, bool tiled, byte* outTexels, int potWidth)
+{
+	if (width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	if (format == Texture::Format::ETC1)
+	{
+		writeEtc1Region(outTexels, potWidth, tiled, x, y, width, height,
+			[&](int, int) { return color; });
+		return;
+	}
+
+	// A texel for every dithering threshold, the fill only copies them
+	Uint32 texels[4][4];
+
+	for (int i = 0; i < 16; ++i)
+	{
+		int ty = i >> 2;
+		int tx = i & 3;
+
+		if (format == Texture::Format::RGBA8)
+		{
+			std::memcpy(&texels[ty][tx], (const void*)&color, sizeof(Uint32));
+
+			if (tiled)
+			{
+				texels[ty][tx] = TextureSwizzle::swapChannels(texels[ty][tx]);
+			}
+		}
+		else
+		{
+			texels[ty][tx] = packTexel(color, format, dither ? kBayer4x4[ty][tx] : -1);
+		}
+	}
+
+	int bits = getBitsPerPixel(format);
+
+	for (int texelY = y; texelY < y + height; ++texelY)
+	{
+		const Uint32* row = texels[texelY & 3];
+
+		if (!tiled && bits == 32)
+		{
+			Uint32* dst = (Uint32*)outTexels + x + texelY * potWidth;
+			std::fill(dst, dst + width, row[0]);
+			continue;
+		}
+
+		for (int texelX = x; texelX < x + width; ++texelX)
+		{
+			Uint32 index = texelIndex(texelX, texelY, potWidth, tiled);
+
+			if (bits == 32)
+				((Uint32*)outTexels)[index] = row[texelX & 3];
+			else if (bits == 16)
+				((Uint16*)outTexels)[index] = (Uint16)row[texelX & 3];
+			else
+				outTexels[index] = (byte)row[texelX & 3];
+		}
+	}
+}
+
+//=============================================================================
+
+void TextureConverter::swapEtc1Layout(const byte* texels, int potWidth, int potHeight,
+	bool tiled, byte* outTexels)
+{
+	for (int blockY = 0; blockY < potHeight / 4; ++blockY)
+	{
+		for (int blockX = 0; blockX < potWidth / 4; ++blockX)
+		{
+			Uint64 block = readEtc1Block(texels,
+				etc1BlockIndex(blockX, blockY, potWidth, tiled), tiled);
+
+			writeEtc1Block(outTexels,
+				etc1BlockIndex(blockX, blockY, potWidth, !tiled), !tiled, block);
+		}
+	}
+}
+
+//=============================================================================
+
+Color TextureConverter::getTexel(const byte* texels, int potWidth,
+	Texture::Format format, bool tiled, int x, int y)
+{
+	switch (format)
+	{
+	case Texture::Format::RGBA8:
+	{
+		Uint32 texel = ((const Uint32*)texels)[texelIndex(x, y, potWidth, tiled)];
+		Color color;
+
+		if (tiled)
+		{
+			texel = TextureSwizzle::swapChannels(texel);
+		}
+
+		std::memcpy((void*)&color, &texel, sizeof(texel));
+		return color;
+	}
+
+	case Texture::Format::ETC1:
+	{
+		Color block[16];
+		decodeEtc1Block(readEtc1Block(texels,
+			etc1BlockIndex(x >> 2, y >> 2, potWidth, tiled), tiled), block);
+		return block[(x & 3) + (y & 3) * 4];
+	}
+
+	case Texture::Format::L8:
+	case Texture::Format::A8:
+		return unpackTexel(texels[texelIndex(x, y, potWidth, tiled)], format);
+
+	default:
+		return unpackTexel(((const Uint16*)texels)[texelIndex(x, y, potWidth, tiled)], format);
+	}
+}
+
+//=============================================================================
+
+void TextureConverter::setTexel(byte* texels, int potWidth,
+	Texture::Format format, bool tiled, int x, int y, const Color& color)
+{
+	switch (format)
+	{
+	case Texture::Format::RGBA8:
+	{
+		Uint32 texel;
+		std::memcpy(&texel, (const void*)&color, sizeof(texel));
+
+		if (tiled)
+		{
+			texel = TextureSwizzle::swapChannels(texel);
+		}
+
+		((Uint32*)texels)[texelIndex(x, y, potWidth, tiled)] = texel;
+		break;
+	}
+
+	case Texture::Format::ETC1:
+	{
+		Uint32 index = etc1BlockIndex(x >> 2, y >> 2, potWidth, tiled);
+		Color block[16];
+
+		decodeEtc1Block(readEtc1Block(texels, index, tiled), block);
+		block[(x & 3) + (y & 3) * 4] = color;
+		writeEtc1Block(texels, index, tiled, encodeEtc1Block(block));
+		break;
+	}
+
+	case Texture::Format::L8:
+	case Texture::Format::A8:
+		texels[texelIndex(x, y, potWidth, tiled)] = (byte)packTexel(color, format, -1);
+		break;
+
+	default:
+		((Uint16*)texels)[texelIndex(x, y, potWidth, tiled)] = (Uint16)packTexel(color, format, -1);
+		break;
+	}
+}
+
+//=============================================================================
+
+Uint64 TextureConverter::encodeEtc1Block(const Color* block)
+{
+	Uint64 bestBlock = 0;
+	int bestError = INT_MAX;
+
+	for (int flip = 0; flip < 2; ++flip)
+	{
+		int sums[2][3] = { { 0, 0, 0 }, { 0, 0, 0 } };
+
+		for (int i = 0; i < 16; ++i)
+		{
+			int x = i & 3;
+			int y = i >> 2;
+			int subblock = flip ? (y >> 1) : (x >> 1);
+
+			sums[subblock][0] += block[i].r;
+			sums[subblock][1] += block[i].g;
+			sums[subblock][2] += block[i].b;
+		}
+
+		// Try both the individual (4 bits) and differential (5 bits) modes
+		for (int differential = 0; differential < 2; ++differential)
+		{
+			int codes[2][3];
+			int bases[2][3];
+
+			for (int c = 0; c < 3; ++c)
+			{
+				if (differential)
+				{
+					codes[0][c] = (sums[0][c] * 31 + 8 * 127) / (8 * 255);
+					codes[1][c] = (sums[1][c] * 31 + 8 * 127) / (8 * 255);
+					codes[1][c] = util::clamp<int>(codes[1][c], codes[0][c] - 4, codes[0][c] + 3);
+					codes[1][c] = util::clamp<int>(codes[1][c], 0, 31);
+					bases[0][c] = (codes[0][c] << 3) | (codes[0][c] >> 2);
+					bases[1][c] = (codes[1][c] << 3) | (codes[1][c] >> 2);
+				}
+				else
+				{
+					codes[0][c] = (sums[0][c] * 15 + 8 * 127) / (8 * 255);
+					codes[1][c] = (sums[1][c] * 15 + 8 * 127) / (8 * 255);
+					bases[0][c] = codes[0][c] * 17;
+					bases[1][c] = codes[1][c] * 17;
+				}
+			}
+
+			int tables[2];
+			int selectors[16];
+			int error = fitEtc1Subblock(block, flip != 0, 0, bases[0], tables[0], selectors);
+
+			if (error >= bestError)
+				continue;
+
+			error += fitEtc1Subblock(block, flip != 0, 1, bases[1], tables[1], selectors);
+
+			if (error >= bestError)
+				continue;
+
+			Uint32 high = tables[0] << 5 | tables[1] << 2 | differential << 1 | flip;
+
+			if (differential)
+			{
+				high |= codes[0][0] << 27 | ((codes[1][0] - codes[0][0]) & 7) << 24 |
+					codes[0][1] << 19 | ((codes[1][1] - codes[0][1]) & 7) << 16 |
+					codes[0][2] << 11 | ((codes[1][2] - codes[0][2]) & 7) << 8;
+			}
+			else
+			{
+				high |= codes[0][0] << 28 | codes[1][0] << 24 |
+					codes[0][1] << 20 | codes[1][1] << 16 |
+					codes[0][2] << 12 | codes[1][2] << 8;
+			}
+
+			// Selector bits are stored column by column, msb and lsb apart
+			Uint32 low = 0;
+
+			for (int i = 0; i < 16; ++i)
+			{
+				int bit = (i & 3) * 4 + (i >> 2);
+				low |= (selectors[i] >> 1) << (16 + bit) | (selectors[i] & 1) << bit;
+			}
+
+			bestBlock = (Uint64)high << 32 | low;
+			bestError = error;
+		}
+	}
+
+	return bestBlock;
+}
+
+//=============================================================================
+
+void TextureConverter::decodeEtc1Block(Uint64 block, Color* outBlock)
+{
+	Uint32 high = (Uint32)(block >> 32);
+	Uint32 low = (Uint32)block;
+	bool flip = (high & 1) != 0;
+	int bases[2][3];
+
+	if (high & 2)
+	{
+		static const int kShifts[3] = { 27, 19, 11 };
+
+		for (int c = 0; c < 3; ++c)
+		{
+			int code = high >> kShifts[c] & 0x1F;
+			int delta = (int)(high >> (kShifts[c] - 3) & 7);
+
+			if (delta >= 4)
+			{
+				delta -= 8;
+			}
+
+			int other = (code + delta) & 0x1F;
+
+			bases[0][c] = (code << 3) | (code >> 2);
+			bases[1][c] = (other << 3) | (other >> 2);
+		}
+	}
+	else
+	{
+		static const int kShifts[3] = { 28, 20, 12 };
+
+		for (int c = 0; c < 3; ++c)
+		{
+			bases[0][c] = (high >> kShifts[c] & 0xF) * 17;
+			bases[1][c] = (high >> (kShifts[c] - 4) & 0xF) * 17;
+		}
+	}
+
+	int tables[2] = { (int)(high >> 5 & 7), (int)(high >> 2 & 7) };
+
+	for (int i = 0; i < 16; ++i)
+	{
+		int x = i & 3;
+		int y = i >> 2;
+		int bit = x * 4 + y;
+		int subblock = flip ? (y >> 1) : (x >> 1);
+		int modifier = kEtc1Modifiers[tables[subblock]][low >> bit & 1];
+
+		if (low >> (16 + bit) & 1)
+		{
+			modifier = -modifier;
+		}
+
+		outBlock[i] = Color(
+			(byte)util::clamp<int>(bases[subblock][0] + modifier, 0, 255),
+			(byte)util::clamp<int>(bases[subblock][1] + modifier, 0, 255),
+			(byte)util::clamp<int>(bases[subblock][2] + modifier, 0, 255));
+	}
+}
+
+//=============================================================================
+
+NS_KAIRY_END
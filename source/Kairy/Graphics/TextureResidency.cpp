@@ -0,0 +1,195 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <Kairy/Graphics/TextureResidency.h>
+#include <algorithm>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+static std::unique_ptr<TextureResidency> s_sharedTextureResidency = nullptr;
+
+// The framebuffers share the 6 MB of VRAM
+static const Uint32 kDefaultVramBudget = 2 * 1024 * 1024;
+
+Uint32 TextureResidency::s_frame = 1;
+
+//=============================================================================
+
+TextureResidency* TextureResidency::getInstance()
+{
+	if (!s_sharedTextureResidency)
+	{
+		s_sharedTextureResidency.reset(new TextureResidency());
+	}
+
+	return s_sharedTextureResidency.get();
+}
+
+//=============================================================================
+
+TextureResidency::TextureResidency(void)
+	: _vramBudget(kDefaultVramBudget)
+	, _coldFrames(120)
+	, _maxMovesPerFrame(2)
+	, _promotions(0)
+	, _demotions(0)
+{
+}
+
+//=============================================================================
+
+void TextureResidency::manage(Texture& texture)
+{
+	if (!texture._residencyManaged)
+	{
+		texture._residencyManaged = true;
+		_textures.push_back(&texture);
+	}
+}
+
+//=============================================================================
+
+void TextureResidency::unmanage(Texture& texture)
+{
+	if (texture._residencyManaged)
+	{
+		texture._residencyManaged = false;
+		_textures.erase(std::remove(_textures.begin(), _textures.end(), &texture),
+			_textures.end());
+	}
+}
+
+//=============================================================================
+
+Uint32 TextureResidency::getVramUsage() const
+{
+	Uint32 usage = 0;
+
+	for (auto texture : _textures)
+	{
+		if (texture->_pixels && texture->_location == Texture::Location::Vram)
+		{
+			usage += texture->getMemorySize();
+		}
+	}
+
+	return usage;
+}
+
+//=============================================================================
+
+void TextureResidency::update()
+{
+	Uint32 frame = s_frame++;
+
+#ifdef _3DS
+	if (_textures.empty())
+	{
+		return;
+	}
+
+	// Least recently used first
+	std::vector<Texture*> textures;
+
+	for (auto texture : _textures)
+	{
+		if (texture->_pixels)
+		{
+			textures.push_back(texture);
+		}
+	}
+
+	std::sort(textures.begin(), textures.end(), [](Texture* a, Texture* b)
+	{
+		return a->_lastUsedFrame < b->_lastUsedFrame;
+	});
+
+	Uint32 usage = getVramUsage();
+	int moves = 0;
+
+	for (auto texture : textures)
+	{
+		if (moves >= _maxMovesPerFrame)
+		{
+			break;
+		}
+
+		if (texture->_location != Texture::Location::Vram)
+		{
+			continue;
+		}
+
+		// The textures of this frame stay, else they would come back
+		bool cold = frame - texture->_lastUsedFrame > _coldFrames;
+		bool overBudget = usage > _vramBudget && texture->_lastUsedFrame < frame;
+
+		if (!cold && !overBudget)
+		{
+			break;
+		}
+
+		Uint32 size = texture->getMemorySize();
+
+		if (texture->changeLocation(Texture::Location::Ram))
+		{
+			usage -= size;
+			++_demotions;
+			++moves;
+		}
+	}
+
+	// Most recently used first
+	for (auto it = textures.rbegin(); it != textures.rend() && moves < _maxMovesPerFrame; ++it)
+	{
+		Texture* texture = *it;
+
+		if (texture->_lastUsedFrame < frame)
+		{
+			break;
+		}
+
+		if (texture->_location == Texture::Location::Vram)
+		{
+			continue;
+		}
+
+		Uint32 size = texture->getMemorySize();
+
+		if (usage + size <= _vramBudget &&
+			texture->changeLocation(Texture::Location::Vram))
+		{
+			usage += size;
+			++_promotions;
+			++moves;
+		}
+	}
+#else
+	(void)frame;
+#endif // _3DS
+}
+
+//=============================================================================
+
+NS_KAIRY_END
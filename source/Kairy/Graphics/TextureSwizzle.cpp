@@ -0,0 +1,297 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <Kairy/Graphics/TextureSwizzle.h>
+#include <algorithm>
+#include <cstring>
+
+#if defined(KAIRY_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(KAIRY_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+const byte TextureSwizzle::s_mortonX[8] = { 0, 1, 4, 5, 16, 17, 20, 21 };
+const byte TextureSwizzle::s_mortonY[8] = { 0, 2, 8, 10, 32, 34, 40, 42 };
+
+//=============================================================================
+
+#if defined(KAIRY_SIMD_SSE2)
+static inline __m128i swapChannels4(__m128i v)
+{
+	// Swap the bytes of each half word, then the half words of each word
+	v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+	return _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+}
+#elif defined(KAIRY_SIMD_NEON)
+static inline uint32x4_t swapChannels4(uint32x4_t v)
+{
+	return vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(v)));
+}
+#endif
+
+//=============================================================================
+
+// In a tile two consecutive rows interleave by pairs of texels:
+// rows y and y + 1 fill 16 texels at s_mortonY[y], as four runs of
+// four (x 0-1, x 2-3, x 4-5, x 6-7 of both rows).
+static void tileBlock(const Uint32* src, int stride, Uint32* tile)
+{
+	static const int kRowPairs[4] = { 0, 8, 32, 40 };
+
+	for (int pair = 0; pair < 4; ++pair)
+	{
+		const Uint32* row0 = src + pair * 2 * stride;
+		const Uint32* row1 = row0 + stride;
+		Uint32* dst = tile + kRowPairs[pair];
+
+#if defined(KAIRY_SIMD_SSE2)
+		__m128i a0 = swapChannels4(_mm_loadu_si128((const __m128i*)row0));
+		__m128i a1 = swapChannels4(_mm_loadu_si128((const __m128i*)(row0 + 4)));
+		__m128i b0 = swapChannels4(_mm_loadu_si128((const __m128i*)row1));
+		__m128i b1 = swapChannels4(_mm_loadu_si128((const __m128i*)(row1 + 4)));
+
+		_mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi64(a0, b0));
+		_mm_storeu_si128((__m128i*)(dst + 4), _mm_unpackhi_epi64(a0, b0));
+		_mm_storeu_si128((__m128i*)(dst + 16), _mm_unpacklo_epi64(a1, b1));
+		_mm_storeu_si128((__m128i*)(dst + 20), _mm_unpackhi_epi64(a1, b1));
+#elif defined(KAIRY_SIMD_NEON)
+		uint32x4_t a0 = swapChannels4(vld1q_u32(row0));
+		uint32x4_t a1 = swapChannels4(vld1q_u32(row0 + 4));
+		uint32x4_t b0 = swapChannels4(vld1q_u32(row1));
+		uint32x4_t b1 = swapChannels4(vld1q_u32(row1 + 4));
+
+		vst1q_u32(dst, vcombine_u32(vget_low_u32(a0), vget_low_u32(b0)));
+		vst1q_u32(dst + 4, vcombine_u32(vget_high_u32(a0), vget_high_u32(b0)));
+		vst1q_u32(dst + 16, vcombine_u32(vget_low_u32(a1), vget_low_u32(b1)));
+		vst1q_u32(dst + 20, vcombine_u32(vget_high_u32(a1), vget_high_u32(b1)));
+#else
+		for (int run = 0; run < 4; ++run)
+		{
+			// Runs start at x = 0, 2, 4, 6 and land at 0, 4, 16, 20
+			int x = run * 2;
+			Uint32* out = dst + ((run & 1) << 2) + ((run & 2) << 3);
+
+			out[0] = TextureSwizzle::swapChannels(row0[x]);
+			out[1] = TextureSwizzle::swapChannels(row0[x + 1]);
+			out[2] = TextureSwizzle::swapChannels(row1[x]);
+			out[3] = TextureSwizzle::swapChannels(row1[x + 1]);
+		}
+#endif
+	}
+}
+
+//=============================================================================
+
+static void untileBlock(const Uint32* tile, Uint32* dst, int stride)
+{
+	static const int kRowPairs[4] = { 0, 8, 32, 40 };
+
+	for (int pair = 0; pair < 4; ++pair)
+	{
+		const Uint32* src = tile + kRowPairs[pair];
+		Uint32* row0 = dst + pair * 2 * stride;
+		Uint32* row1 = row0 + stride;
+
+#if defined(KAIRY_SIMD_SSE2)
+		__m128i t0 = swapChannels4(_mm_loadu_si128((const __m128i*)src));
+		__m128i t1 = swapChannels4(_mm_loadu_si128((const __m128i*)(src + 4)));
+		__m128i t2 = swapChannels4(_mm_loadu_si128((const __m128i*)(src + 16)));
+		__m128i t3 = swapChannels4(_mm_loadu_si128((const __m128i*)(src + 20)));
+
+		_mm_storeu_si128((__m128i*)row0, _mm_unpacklo_epi64(t0, t1));
+		_mm_storeu_si128((__m128i*)row1, _mm_unpackhi_epi64(t0, t1));
+		_mm_storeu_si128((__m128i*)(row0 + 4), _mm_unpacklo_epi64(t2, t3));
+		_mm_storeu_si128((__m128i*)(row1 + 4), _mm_unpackhi_epi64(t2, t3));
+#elif defined(KAIRY_SIMD_NEON)
+		uint32x4_t t0 = swapChannels4(vld1q_u32(src));
+		uint32x4_t t1 = swapChannels4(vld1q_u32(src + 4));
+		uint32x4_t t2 = swapChannels4(vld1q_u32(src + 16));
+		uint32x4_t t3 = swapChannels4(vld1q_u32(src + 20));
+
+		vst1q_u32(row0, vcombine_u32(vget_low_u32(t0), vget_low_u32(t1)));
+		vst1q_u32(row1, vcombine_u32(vget_high_u32(t0), vget_high_u32(t1)));
+		vst1q_u32(row0 + 4, vcombine_u32(vget_low_u32(t2), vget_low_u32(t3)));
+		vst1q_u32(row1 + 4, vcombine_u32(vget_high_u32(t2), vget_high_u32(t3)));
+#else
+		for (int run = 0; run < 4; ++run)
+		{
+			int x = run * 2;
+			const Uint32* in = src + ((run & 1) << 2) + ((run & 2) << 3);
+
+			row0[x] = TextureSwizzle::swapChannels(in[0]);
+			row0[x + 1] = TextureSwizzle::swapChannels(in[1]);
+			row1[x] = TextureSwizzle::swapChannels(in[2]);
+			row1[x + 1] = TextureSwizzle::swapChannels(in[3]);
+		}
+#endif
+	}
+}
+
+//=============================================================================
+
+void TextureSwizzle::swapChannels(const Uint32* texels, Uint32* outTexels, Uint32 count)
+{
+	Uint32 i = 0;
+
+#if defined(KAIRY_SIMD_SSE2)
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_si128((__m128i*)(outTexels + i),
+			swapChannels4(_mm_loadu_si128((const __m128i*)(texels + i))));
+	}
+#elif defined(KAIRY_SIMD_NEON)
+	for (; i + 4 <= count; i += 4)
+	{
+		vst1q_u32(outTexels + i, swapChannels4(vld1q_u32(texels + i)));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		outTexels[i] = swapChannels(texels[i]);
+	}
+}
+
+//=============================================================================
+
+void TextureSwizzle::tile(const byte* pixels, int width, int height,
+	Uint32* outTexels, int potWidth, int potHeight)
+{
+	const Uint32* src = (const Uint32*)pixels;
+	int tilesX = potWidth >> 3;
+	int tilesY = potHeight >> 3;
+
+	for (int ty = 0; ty < tilesY; ++ty)
+	{
+		int y0 = ty << 3;
+
+		for (int tx = 0; tx < tilesX; ++tx)
+		{
+			int x0 = tx << 3;
+			Uint32* tile = outTexels + ((ty * tilesX + tx) << 6);
+
+			if (x0 + 8 <= width && y0 + 8 <= height)
+			{
+				tileBlock(src + x0 + y0 * width, width, tile);
+			}
+			else if (x0 >= width || y0 >= height)
+			{
+				std::memset(tile, 0, 64 * sizeof(Uint32));
+			}
+			else
+			{
+				// Tile crossing the right or bottom border of the pixels
+				for (int y = 0; y < 8; ++y)
+				{
+					for (int x = 0; x < 8; ++x)
+					{
+						tile[s_mortonX[x] + s_mortonY[y]] =
+							(x0 + x < width && y0 + y < height) ?
+							swapChannels(src[x0 + x + (y0 + y) * width]) : 0;
+					}
+				}
+			}
+		}
+	}
+}
+
+//=============================================================================
+
+void TextureSwizzle::untile(const Uint32* texels, int potWidth, int potHeight,
+	byte* outPixels, int width, int height)
+{
+	Uint32* dst = (Uint32*)outPixels;
+	int tilesX = potWidth >> 3;
+	int tilesY = std::min(potHeight, height + 7) >> 3;
+
+	for (int ty = 0; ty < tilesY; ++ty)
+	{
+		int y0 = ty << 3;
+
+		for (int tx = 0; tx < tilesX && (tx << 3) < width; ++tx)
+		{
+			int x0 = tx << 3;
+			const Uint32* tile = texels + ((ty * tilesX + tx) << 6);
+
+			if (x0 + 8 <= width && y0 + 8 <= height)
+			{
+				untileBlock(tile, dst + x0 + y0 * width, width);
+			}
+			else
+			{
+				int right = std::min(8, width - x0);
+				int bottom = std::min(8, height - y0);
+
+				for (int y = 0; y < bottom; ++y)
+				{
+					for (int x = 0; x < right; ++x)
+					{
+						dst[x0 + x + (y0 + y) * width] =
+							swapChannels(tile[s_mortonX[x] + s_mortonY[y]]);
+					}
+				}
+			}
+		}
+	}
+}
+
+//=============================================================================
+
+void TextureSwizzle::pad(const byte* pixels, int width, int height,
+	Uint32* outTexels, int potWidth, int potHeight)
+{
+	int copyWidth = std::min(width, potWidth);
+	int copyHeight = std::min(height, potHeight);
+
+	for (int y = 0; y < copyHeight; ++y)
+	{
+		Uint32* row = outTexels + y * potWidth;
+		std::memcpy(row, pixels + y * width * 4, copyWidth * sizeof(Uint32));
+		std::memset(row + copyWidth, 0, (potWidth - copyWidth) * sizeof(Uint32));
+	}
+
+	std::memset(outTexels + copyHeight * potWidth, 0,
+		(potHeight - copyHeight) * potWidth * sizeof(Uint32));
+}
+
+//=============================================================================
+
+void TextureSwizzle::unpad(const Uint32* texels, int potWidth, int potHeight,
+	byte* outPixels, int width, int height)
+{
+	for (int y = 0; y < height && y < potHeight; ++y)
+	{
+		std::memcpy(outPixels + y * width * 4, texels + y * potWidth,
+			std::min(width, potWidth) * sizeof(Uint32));
+	}
+}
+
+//=============================================================================
+
+NS_KAIRY_END
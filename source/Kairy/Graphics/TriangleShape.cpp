@@ -26,9 +26,7 @@
 #include <Kairy/Graphics/ShaderProgram.h>
 #include <Kairy/Graphics/RenderDevice.h>
 
-#ifdef _3DS
-#include "../3DS/VertexPool.h"
-#endif // _3DS
+#include "VertexPool.h"
 
 NS_KAIRY_BEGIN
 
@@ -38,24 +36,6 @@ TriangleShape::TriangleShape(void)
 	: OutlinedShape()
 {
 	setOutlineColor(Color::Transparent);
-
-#ifndef _3DS
-	glGenVertexArrays(1, &_vao);
-	glGenBuffers(1, &_vbo);
-
-	glBindVertexArray(_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 27, nullptr, GL_DYNAMIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 9, 0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 9, (GLvoid*)(sizeof(float) * 3));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 9, (GLvoid*)(sizeof(float) * 7));
-	glEnableVertexAttribArray(2);
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-#endif // _3DS
 }
 
 //=============================================================================
@@ -111,7 +91,10 @@ void TriangleShape::draw()
 	
 	if (_color.a > 0)
 	{
-		ShaderProgram::setUniform(UNIFORM_MODELVIEW_NAME, getCombinedTransform());
+		// Shapes are drawn right away, after everything batched before
+		_device->flush();
+		ShaderProgram::setUniform(UniformHandle::Modelview, getCombinedTransform());
+		_device->setBlendMode(_blendMode);
 
 #ifdef _3DS
 
@@ -128,13 +111,7 @@ void TriangleShape::draw()
 
 		//=========================================================================
 
-		GPU_SetTexEnv(0,
-			GPU_TEVSOURCES(GPU_CONSTANT, GPU_CONSTANT, GPU_CONSTANT),
-			GPU_TEVSOURCES(GPU_CONSTANT, GPU_CONSTANT, GPU_CONSTANT),
-			GPU_TEVOPERANDS(0, 0, 0),
-			GPU_TEVOPERANDS(0, 0, 0),
-			GPU_REPLACE, GPU_REPLACE,
-			_color.r | _color.g << 8 | _color.b << 16 | _color.a << 24);
+		_device->getRenderState().setColorCombiner(_color);
 
 		u32 bufferOffsets[] = { 0x00 };
 		u64 bufferPermutations[] = { 0x10 };
@@ -155,25 +132,27 @@ void TriangleShape::draw()
 		GPU_DrawArray(GPU_TRIANGLE_STRIP, 0, 3);
 
 #else
+		auto pool = VertexPool::getInstance();
+		auto vertices = pool->pushVertices<VertexPositionColorTexture>(3);
+
 		Vec4 c = _color.toVector();
 
-		float vertices[] =
+		vertices[0].position = Vec3(_vertices[0].x, _vertices[0].y, -0.5f);
+		vertices[1].position = Vec3(_vertices[1].x, _vertices[1].y, -0.5f);
+		vertices[2].position = Vec3(_vertices[2].x, _vertices[2].y, -0.5f);
+
+		for (int i = 0; i < 3; ++i)
 		{
-			_vertices[0].x, _vertices[0].y, -0.5f, c.x, c.y, c.z, c.w, 0, 0,
-			_vertices[1].x, _vertices[1].y, -0.5f, c.x, c.y, c.z, c.w, 0, 0,
-			_vertices[2].x, _vertices[2].y, -0.5f, c.x, c.y, c.z, c.w, 0, 0
-		};
+			vertices[i].color = c;
+			vertices[i].texcoord = Vec2::Zero;
+		}
 
-		glUniform1i(ShaderProgram::getCurrentProgram()->
-			getUniformLocation("textureEnabled"), false);
+		GLint first = pool->commit();
 
-		glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * 27, vertices);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		_device->getRenderState().setColorCombiner(_color);
 
-		glBindVertexArray(_vao);
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 3);
-		glBindVertexArray(0);
+		pool->bindVertexArray();
+		glDrawArrays(GL_TRIANGLE_STRIP, first, 3);
 #endif // _3DS
 	}
 
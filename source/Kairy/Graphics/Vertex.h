@@ -48,6 +48,13 @@ struct VertexPositionTextureColor
 	Vec4 color;
 };
 
+struct VertexPositionColorTexture
+{
+	Vec3 position;
+	Vec4 color;
+	Vec2 texcoord;
+};
+
 NS_KAIRY_END
 
 #endif // KAIRY_GRAPHICS_VERTEX_H_INCLUDED
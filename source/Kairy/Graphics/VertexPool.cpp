@@ -0,0 +1,427 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include "VertexPool.h"
+#include <Kairy/Graphics/RenderDevice.h>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+static VertexPool* s_sharedVertexPool = nullptr;
+
+//=============================================================================
+
+VertexPool* VertexPool::getInstance()
+{
+    if(!s_sharedVertexPool)
+    {
+        s_sharedVertexPool = new VertexPool();
+    }
+
+    return s_sharedVertexPool;
+}
+
+//=============================================================================
+
+VertexPool::VertexPool()
+    : _capacity(0)
+    , _head(0)
+    , _frameBytes(0)
+    , _inFlightBytes(0)
+    , _lastFrameBytes(0)
+    , _highWaterMark(0)
+    , _overflows(0)
+#ifdef _3DS
+    , _vertices(nullptr)
+#else
+    , _buffer(0)
+    , _vao(0)
+    , _mappedOffset(0)
+    , _mappedSize(0)
+    , _mapped(false)
+#endif // _3DS
+{
+#ifndef _3DS
+    _frame.sync = 0;
+#endif // _3DS
+    _frame.bytes = 0;
+}
+
+//=============================================================================
+
+VertexPool::~VertexPool()
+{
+    destroy();
+}
+
+//=============================================================================
+
+bool VertexPool::init(Uint32 capacity)
+{
+    if(_capacity != 0)
+    {
+        return true;
+    }
+
+#ifdef _3DS
+    _vertices = linearAlloc(capacity);
+
+    if(!_vertices)
+    {
+        return false;
+    }
+#else
+    glGenBuffers(1, &_buffer);
+    glGenVertexArrays(1, &_vao);
+
+    if(_buffer == 0 || _vao == 0)
+    {
+        destroy();
+        return false;
+    }
+
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+    glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexPositionColorTexture), 0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(VertexPositionColorTexture), (GLvoid*)(sizeof(float) * 3));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VertexPositionColorTexture), (GLvoid*)(sizeof(float) * 7));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif // _3DS
+
+    _capacity = capacity;
+    _head = 0;
+    _frameBytes = 0;
+    _inFlightBytes = 0;
+    _frame.bytes = 0;
+
+    return true;
+}
+
+//=============================================================================
+
+void VertexPool::destroy()
+{
+#ifndef _3DS
+    commit();
+#endif // _3DS
+
+    while(waitOldestFrame())
+    {
+    }
+
+#ifdef _3DS
+    for(void* block : _frame.overflowBlocks)
+    {
+        linearFree(block);
+    }
+
+    _frame.overflowBlocks.clear();
+
+    if(_vertices)
+    {
+        linearFree(_vertices);
+        _vertices = nullptr;
+    }
+#else
+    if(_vao != 0)
+    {
+        glDeleteVertexArrays(1, &_vao);
+        _vao = 0;
+    }
+
+    if(_buffer != 0)
+    {
+        glDeleteBuffers(1, &_buffer);
+        _buffer = 0;
+    }
+#endif // _3DS
+
+    _capacity = 0;
+}
+
+//=============================================================================
+
+void VertexPool::beginFrame()
+{
+    retireFrames();
+
+    // Never get more than MAX_FRAMES_IN_FLIGHT frames ahead of the gpu
+    while(_fences.size() >= MAX_FRAMES_IN_FLIGHT && waitOldestFrame())
+    {
+    }
+
+    _frameBytes = 0;
+}
+
+//=============================================================================
+
+void VertexPool::endFrame()
+{
+#ifdef _3DS
+    bool used = _frame.bytes > 0 || !_frame.overflowBlocks.empty();
+#else
+    commit();
+
+    bool used = _frame.bytes > 0;
+
+    if(used)
+    {
+        _frame.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+#endif // _3DS
+
+    if(used)
+    {
+        _inFlightBytes += _frame.bytes;
+        _fences.push_back(_frame);
+    }
+
+    _lastFrameBytes = _frameBytes;
+    _highWaterMark = std::max(_highWaterMark, _frameBytes);
+
+    _frame = Fence();
+    _frame.bytes = 0;
+#ifndef _3DS
+    _frame.sync = 0;
+#endif // _3DS
+    _frameBytes = 0;
+}
+
+//=============================================================================
+
+void VertexPool::retireFrames()
+{
+    while(!_fences.empty())
+    {
+#ifndef _3DS
+        GLenum status = glClientWaitSync(_fences.front().sync, 0, 0);
+
+        if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+#endif // _3DS
+
+        releaseOldestFrame();
+    }
+}
+
+//=============================================================================
+
+bool VertexPool::waitOldestFrame()
+{
+    if(_fences.empty())
+    {
+        return false;
+    }
+
+#ifndef _3DS
+    // Wait a millisecond at a time so the driver can't spin forever
+    GLenum status = GL_TIMEOUT_EXPIRED;
+
+    while(status == GL_TIMEOUT_EXPIRED)
+    {
+        status = glClientWaitSync(_fences.front().sync,
+            GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+#endif // _3DS
+
+    // On the 3DS the gpu is waited for at the end of every frame,
+    // so a fenced frame has always been completed
+    releaseOldestFrame();
+
+    return true;
+}
+
+//=============================================================================
+
+void VertexPool::releaseOldestFrame()
+{
+    Fence& fence = _fences.front();
+
+#ifdef _3DS
+    for(void* block : fence.overflowBlocks)
+    {
+        linearFree(block);
+    }
+#else
+    glDeleteSync(fence.sync);
+#endif // _3DS
+
+    _inFlightBytes -= fence.bytes;
+    _fences.erase(_fences.begin());
+}
+
+//=============================================================================
+
+void* VertexPool::pushVertices(Uint32 size, Uint32 count)
+{
+    if(_capacity == 0 || size == 0)
+    {
+        return nullptr;
+    }
+
+#ifndef _3DS
+    commit();
+#endif // _3DS
+
+    Uint32 bytes = size * count;
+    Uint32 offset = 0;
+
+    for(;;)
+    {
+        Uint32 free = _capacity - _inFlightBytes - _frame.bytes;
+
+#ifdef _3DS
+        // Keep the attribute buffers aligned for the gpu
+        Uint32 padding = (16 - _head % 16) % 16;
+#else
+        // Keep the offset a multiple of the vertex size so that it can be
+        // used as the first vertex of a draw call
+        Uint32 padding = (size - _head % size) % size;
+#endif // _3DS
+
+        if(_head + padding + bytes <= _capacity && padding + bytes <= free)
+        {
+            offset = _head + padding;
+            _head = offset + bytes;
+            _frame.bytes += padding + bytes;
+            _frameBytes += padding + bytes;
+            break;
+        }
+
+        // Wrap to the start of the ring, skipping its tail
+        Uint32 skip = _capacity - _head;
+
+        if(skip + bytes <= free)
+        {
+            offset = 0;
+            _head = bytes;
+            _frame.bytes += skip + bytes;
+            _frameBytes += skip + bytes;
+            break;
+        }
+
+        if(!waitOldestFrame())
+        {
+            // The current frame alone doesn't fit in the ring
+            _overflows++;
+            return pushOverflow(size, count);
+        }
+    }
+
+#ifdef _3DS
+    return ((byte*)_vertices) + offset;
+#else
+    RenderDevice::getInstance()->getRenderState().bindArrayBuffer(_buffer);
+    void* vertices = glMapBufferRange(GL_ARRAY_BUFFER, offset, bytes,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+    _mapped = vertices != nullptr;
+    _mappedOffset = offset;
+    _mappedSize = size;
+
+    return vertices;
+#endif // _3DS
+}
+
+//=============================================================================
+
+void* VertexPool::pushOverflow(Uint32 size, Uint32 count)
+{
+    Uint32 bytes = size * count;
+
+#ifdef _3DS
+    _frameBytes += bytes;
+
+    // Keep the vertices in a separate block released with the frame,
+    // the ring can't move while the gpu may still be reading it
+    void* block = linearAlloc(bytes);
+
+    if(block)
+    {
+        _frame.overflowBlocks.push_back(block);
+    }
+
+    return block;
+#else
+    // Orphan the storage of the ring, the draws already issued keep
+    // reading the old one
+    RenderDevice::getInstance()->getRenderState().bindArrayBuffer(_buffer);
+    glBufferData(GL_ARRAY_BUFFER, _capacity, nullptr, GL_STREAM_DRAW);
+
+    for(Fence& fence : _fences)
+    {
+        glDeleteSync(fence.sync);
+    }
+
+    _fences.clear();
+    _inFlightBytes = 0;
+    _frame.bytes = 0;
+    _head = 0;
+
+    if(bytes > _capacity)
+    {
+        return nullptr;
+    }
+
+    return pushVertices(size, count);
+#endif // _3DS
+}
+
+//=============================================================================
+
+#ifndef _3DS
+GLint VertexPool::commit()
+{
+    if(!_mapped)
+    {
+        return 0;
+    }
+
+    RenderDevice::getInstance()->getRenderState().bindArrayBuffer(_buffer);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+
+    _mapped = false;
+
+    return GLint(_mappedOffset / _mappedSize);
+}
+
+//=============================================================================
+
+void VertexPool::bindVertexArray()
+{
+    RenderDevice::getInstance()->getRenderState().bindVertexArray(_vao);
+}
+#endif // _3DS
+
+//=============================================================================
+
+NS_KAIRY_END
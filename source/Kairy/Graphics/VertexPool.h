@@ -0,0 +1,178 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef KAIRY_GRAPHICS_VERTEX_POOL_H_INCLUDED
+#define KAIRY_GRAPHICS_VERTEX_POOL_H_INCLUDED
+
+#include "Vertex.h"
+
+NS_KAIRY_BEGIN
+
+/**
+ * @class VertexPool
+ * @brief A fixed size ring buffer holding the vertices streamed to the gpu.
+ * Every frame allocates after the previous ones and is protected by a fence,
+ * the space used by a frame is reused only when the gpu is done with it.
+ * The buffer never moves, so the pointers handed out stay valid until the
+ * frame they belong to is retired.
+ * On the PC the ring is a single vertex buffer, the pushed vertices are
+ * written through a mapped range and must be committed before drawing.
+ */
+class VertexPool
+{
+public:
+
+    enum
+    {
+        DEFAULT_CAPACITY = 0x80000,
+        MAX_FRAMES_IN_FLIGHT = 3
+    };
+
+    static VertexPool* getInstance();
+
+    /**
+     * @brief Allocate the ring buffer.
+     * @param capacity The size of the ring buffer in bytes.
+     * @return false if an error occurred.
+     */
+    bool init(Uint32 capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Release the ring buffer, waiting for the gpu to be done with it.
+     */
+    void destroy();
+
+    /**
+     * @brief Start allocating the vertices of a new frame.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Protect the vertices of the current frame with a fence.
+     * Call it after the frame has been submitted to the gpu.
+     */
+    void endFrame();
+
+    /**
+     * @brief Release the space of the frames the gpu is done with.
+     * On the 3DS call it after waiting for the gpu, every submitted frame
+     * is considered complete.
+     */
+    void retireFrames();
+
+    /**
+     * @brief Allocate the space for some vertices in the current frame.
+     * @param size The size of a vertex in bytes.
+     * @param count The number of vertices.
+     * @return A pointer where to write the vertices.
+     */
+    void* pushVertices(Uint32 size, Uint32 count);
+
+	template<typename T>
+	T* pushVertices(Uint32 count) {
+		return static_cast<T*>(pushVertices(sizeof(T), count));
+	}
+
+#ifndef _3DS
+    /**
+     * @brief Unmap the last pushed vertices so that they can be drawn.
+     * @return The index of the first pushed vertex in the ring buffer.
+     */
+    GLint commit();
+
+    /**
+     * @brief Bind the vertex array reading the ring buffer with the
+     * layout of VertexPositionColorTexture.
+     */
+    void bindVertexArray();
+
+    inline GLuint getBuffer() const { return _buffer; }
+#endif // _3DS
+
+    inline Uint32 getCapacity() const { return _capacity; }
+
+    /**
+     * @brief Get the bytes allocated so far in the current frame.
+     */
+    inline Uint32 getFrameUsage() const { return _frameBytes; }
+
+    /**
+     * @brief Get the bytes allocated by the last completed frame.
+     */
+    inline Uint32 getLastFrameUsage() const { return _lastFrameBytes; }
+
+    /**
+     * @brief Get the highest number of bytes allocated by a single frame.
+     */
+    inline Uint32 getHighWaterMark() const { return _highWaterMark; }
+
+    /**
+     * @brief Get how many allocations didn't fit in the ring buffer.
+     */
+    inline Uint32 getOverflows() const { return _overflows; }
+
+    virtual ~VertexPool();
+
+private:
+
+    struct Fence
+    {
+        Uint32 bytes;
+#ifdef _3DS
+        std::vector<void*> overflowBlocks;
+#else
+        GLsync sync;
+#endif // _3DS
+    };
+
+    VertexPool();
+    VertexPool(const VertexPool&) = delete;
+
+    bool waitOldestFrame();
+    void releaseOldestFrame();
+    void* pushOverflow(Uint32 size, Uint32 count);
+
+    Uint32 _capacity;               ///< The size of the ring buffer
+    Uint32 _head;                   ///< The offset of the next allocation
+    Uint32 _frameBytes;             ///< The bytes allocated by the current frame
+    Uint32 _inFlightBytes;          ///< The bytes allocated by the fenced frames
+    Uint32 _lastFrameBytes;         ///< The bytes allocated by the last frame
+    Uint32 _highWaterMark;          ///< The most bytes allocated by a frame
+    Uint32 _overflows;              ///< The allocations that didn't fit
+    std::vector<Fence> _fences;     ///< The frames the gpu may still be reading, oldest first
+    Fence _frame;                   ///< The current frame
+#ifdef _3DS
+    void* _vertices;                ///< The ring buffer
+#else
+    GLuint _buffer;                 ///< The ring vertex buffer
+    GLuint _vao;                    ///< The vertex array reading the ring buffer
+    Uint32 _mappedOffset;           ///< The offset of the mapped range
+    Uint32 _mappedSize;             ///< The vertex size of the mapped range
+    bool _mapped;                   ///< Whether a range is mapped
+#endif // _3DS
+};
+
+NS_KAIRY_END
+
+#endif // KAIRY_GRAPHICS_VERTEX_POOL_H_INCLUDED
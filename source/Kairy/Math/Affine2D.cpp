@@ -0,0 +1,198 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <Kairy/Math/Affine2D.h>
+
+#if defined(KAIRY_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(KAIRY_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+NS_KAIRY_BEGIN
+
+const Affine2D Affine2D::Identity;
+
+//=============================================================================
+
+void Affine2D::transformPoints(const Vec2* points, Vec2* results, Uint32 count) const
+{
+	static_assert(sizeof(Vec2) == sizeof(float) * 2,
+		"Vec2 must be two packed floats");
+
+	Uint32 i = 0;
+
+#if defined(KAIRY_SIMD_SSE2)
+	// Two points for every vector: x0 y0 x1 y1
+	__m128 linear = _mm_loadu_ps(_m);
+	__m128 col0 = _mm_movelh_ps(linear, linear);
+	__m128 col1 = _mm_movehl_ps(linear, linear);
+	__m128 translation = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(_m + 4));
+	translation = _mm_movelh_ps(translation, translation);
+
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128 p = _mm_loadu_ps(&points[i].x);
+		__m128 xs = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+		__m128 ys = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+
+		__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, xs),
+			_mm_mul_ps(col1, ys)), translation);
+
+		_mm_storeu_ps(&results[i].x, r);
+	}
+#elif defined(KAIRY_SIMD_NEON)
+	// Four points for every pair of vectors, split in x and y
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4x2_t p = vld2q_f32(&points[i].x);
+		float32x4x2_t r;
+
+		r.val[0] = vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(_m[4]),
+			p.val[0], _m[0]), p.val[1], _m[2]);
+		r.val[1] = vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(_m[5]),
+			p.val[0], _m[1]), p.val[1], _m[3]);
+
+		vst2q_f32(&results[i].x, r);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		results[i] = transformVec2(points[i]);
+	}
+}
+
+//=============================================================================
+
+Rect Affine2D::transformRect(const Rect& rect) const
+{
+	Vec2 corners[4];
+
+	corners[0] = Vec2(rect.getLeft(), rect.getTop());
+	corners[1] = Vec2(rect.getLeft(), rect.getBottom());
+	corners[2] = Vec2(rect.getRight(), rect.getTop());
+	corners[3] = Vec2(rect.getRight(), rect.getBottom());
+
+	transformPoints(corners, corners, 4);
+
+	float left = corners[0].x;
+	float right = corners[0].x;
+	float top = corners[0].y;
+	float bottom = corners[0].y;
+
+	for (auto& corner : corners)
+	{
+		left = std::min(left, corner.x);
+		right = std::max(right, corner.x);
+		top = std::min(top, corner.y);
+		bottom = std::max(bottom, corner.y);
+	}
+
+	return Rect(left, top, right - left, bottom - top);
+}
+
+//=============================================================================
+
+Affine2D Affine2D::getInverse() const
+{
+	float det = _m[0] * _m[3] - _m[2] * _m[1];
+
+	if (det == 0.0f)
+	{
+		return Affine2D();
+	}
+
+	float invDet = 1.0f / det;
+
+	float a = _m[3] * invDet;
+	float b = -_m[2] * invDet;
+	float c = -_m[1] * invDet;
+	float d = _m[0] * invDet;
+
+	return Affine2D(a, b, c, d,
+		-(a * _m[4] + b * _m[5]),
+		-(c * _m[4] + d * _m[5]));
+}
+
+//=============================================================================
+
+Affine2D& Affine2D::combine(const Affine2D& other)
+{
+#if defined(KAIRY_SIMD_SSE2)
+	__m128 linear = _mm_loadu_ps(_m);
+	__m128 col0 = _mm_movelh_ps(linear, linear);  // a c a c
+	__m128 col1 = _mm_movehl_ps(linear, linear);  // b d b d
+
+	__m128 otherLinear = _mm_loadu_ps(other._m);
+	__m128 otherX = _mm_shuffle_ps(otherLinear, otherLinear, _MM_SHUFFLE(2, 2, 0, 0));
+	__m128 otherY = _mm_shuffle_ps(otherLinear, otherLinear, _MM_SHUFFLE(3, 3, 1, 1));
+
+	__m128 zero = _mm_setzero_ps();
+	__m128 translation = _mm_loadl_pi(zero, (const __m64*)(_m + 4));
+	__m128 otherTranslation = _mm_loadl_pi(zero, (const __m64*)(other._m + 4));
+	__m128 otherTx = _mm_shuffle_ps(otherTranslation, otherTranslation, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 otherTy = _mm_shuffle_ps(otherTranslation, otherTranslation, _MM_SHUFFLE(1, 1, 1, 1));
+
+	linear = _mm_add_ps(_mm_mul_ps(col0, otherX), _mm_mul_ps(col1, otherY));
+	translation = _mm_add_ps(translation,
+		_mm_add_ps(_mm_mul_ps(col0, otherTx), _mm_mul_ps(col1, otherTy)));
+
+	_mm_storeu_ps(_m, linear);
+	_mm_storel_pi((__m64*)(_m + 4), translation);
+#elif defined(KAIRY_SIMD_NEON)
+	float32x2_t col0 = vld1_f32(_m);
+	float32x2_t col1 = vld1_f32(_m + 2);
+	float32x2_t col2 = vld1_f32(_m + 4);
+
+	float32x2_t otherCol0 = vld1_f32(other._m);
+	float32x2_t otherCol1 = vld1_f32(other._m + 2);
+	float32x2_t otherCol2 = vld1_f32(other._m + 4);
+
+	vst1_f32(_m, vmla_lane_f32(vmul_lane_f32(col0, otherCol0, 0), col1, otherCol0, 1));
+	vst1_f32(_m + 2, vmla_lane_f32(vmul_lane_f32(col0, otherCol1, 0), col1, otherCol1, 1));
+	vst1_f32(_m + 4, vadd_f32(col2,
+		vmla_lane_f32(vmul_lane_f32(col0, otherCol2, 0), col1, otherCol2, 1)));
+#else
+	float a = _m[0] * other._m[0] + _m[2] * other._m[1];
+	float c = _m[1] * other._m[0] + _m[3] * other._m[1];
+	float b = _m[0] * other._m[2] + _m[2] * other._m[3];
+	float d = _m[1] * other._m[2] + _m[3] * other._m[3];
+	float tx = _m[0] * other._m[4] + _m[2] * other._m[5] + _m[4];
+	float ty = _m[1] * other._m[4] + _m[3] * other._m[5] + _m[5];
+
+	_m[0] = a;
+	_m[1] = c;
+	_m[2] = b;
+	_m[3] = d;
+	_m[4] = tx;
+	_m[5] = ty;
+#endif
+
+	return *this;
+}
+
+//=============================================================================
+
+NS_KAIRY_END
@@ -82,7 +82,7 @@ Transform Transform::createOrthographic(float left, float right, float bottom,
 
 //=============================================================================
 
-Rect Transform::transformRect(const Rect & rect)
+Rect Transform::transformRect(const Rect & rect) const
 {
 	Vec2 corners[4];
 
@@ -35,12 +35,14 @@ Scene::Scene(void)
 	_color = Color::Transparent;
 	_colorBot = Color::Transparent;
 	_addCounterBot = 0;
+	_spatialIndexEnabled = false;
 }
 
 //=============================================================================
 
 Scene::~Scene(void)
 {
+	clearChildrenBot();
 }
 
 //=============================================================================
@@ -55,7 +57,11 @@ void Scene::removeChild(Node * child)
 		{
 			if (_childrenBot[i].get() == child)
 			{
+				auto node = _childrenBot[i];
+
+				unindexChild(child);
 				_childrenBot.erase(_childrenBot.begin() + i);
+				node->setParent(nullptr);
 				break;
 			}
 		}
@@ -66,8 +72,8 @@ void Scene::removeChild(Node * child)
 
 void Scene::sortByZOrderBot()
 {
-	std::sort(_childrenBot.begin(), _childrenBot.end(),
-		[](std::shared_ptr<Node>& a, std::shared_ptr<Node>& b)
+	std::stable_sort(_childrenBot.begin(), _childrenBot.end(),
+		[](const std::shared_ptr<Node>& a, const std::shared_ptr<Node>& b)
 	{
 		return a->getZOrder() < b->getZOrder();
 	});
@@ -75,13 +81,28 @@ void Scene::sortByZOrderBot()
 
 //=============================================================================
 
-Node * Scene::getChildByName(const std::string & name) const
+void Scene::sortChildren()
 {
-	for (auto& child : _children)
+	// The children of both screens mark the same flag
+	if (_childrenOrderDirty)
 	{
-		if (child->getName() == name)
-			return child.get();
+		sortByZOrder();
+		sortByZOrderBot();
+		_childrenOrderDirty = false;
 	}
+}
+
+//=============================================================================
+
+Node * Scene::getChildByName(const std::string & name) const
+{
+	Node* node = Node::getChildByName(name);
+	auto range = _childrenByName.equal_range(name);
+
+	// Node only scans the top screen for the namesakes and the unnamed nodes
+	if (node || (!name.empty() && (range.first == range.second ||
+		std::next(range.first) == range.second)))
+		return node;
 
 	for (auto& child : _childrenBot)
 	{
@@ -96,11 +117,12 @@ Node * Scene::getChildByName(const std::string & name) const
 
 Node * Scene::getChildByTag(int tag) const
 {
-	for (auto& child : _children)
-	{
-		if (child->getTag() == tag)
-			return child.get();
-	}
+	Node* node = Node::getChildByTag(tag);
+	auto range = _childrenByTag.equal_range(tag);
+
+	if (node || (tag != -1 && (range.first == range.second ||
+		std::next(range.first) == range.second)))
+		return node;
 
 	for (auto& child : _childrenBot)
 	{
@@ -117,11 +139,12 @@ void Scene::clearChildrenBot()
 {
 	for (auto& child : _childrenBot)
 	{
-		child->_parent = nullptr;
+		child->setParent(nullptr);
 	}
 
 	_childrenBot.clear();
 	_addCounterBot = 0;
+	reindexChildren();
 }
 
 //=============================================================================
@@ -133,39 +156,107 @@ Uint32 Scene::getChildrenCountBot() const
 
 //=============================================================================
 
-void Scene::removeChildByTag(int tag)
+void Scene::removeChildrenIf(const std::function<bool(Node*)>& predicate)
 {
-	Node::removeChildByTag(tag);
+	compactChildren(_children, predicate);
+	compactChildren(_childrenBot, predicate);
+	reindexChildren();
+}
+
+//=============================================================================
 
-	std::vector<Uint32> toRemove;
+void Scene::reindexChildren()
+{
+	Node::reindexChildren();
 
-	for (Uint32 i = 0; i < _childrenBot.size(); ++i)
+	for (auto& child : _childrenBot)
 	{
-		if (_childrenBot[i]->getTag() == tag)
-			toRemove.push_back(i);
+		indexChild(child.get());
 	}
+}
+
+//=============================================================================
+
+void Scene::setSpatialIndexEnabled(bool enabled, float cellSize)
+{
+	_spatialIndexEnabled = enabled;
+	_spatialIndex.setCellSize(cellSize);
+	_spatialIndexBot.setCellSize(cellSize);
 
-	for (auto& index : toRemove)
+	if (!enabled)
 	{
-		_childrenBot.erase(_childrenBot.begin() + index);
+		_spatialIndex.clear();
+		_spatialIndexBot.clear();
 	}
 }
 
 //=============================================================================
 
-void Scene::removeChildByName(const std::string & name)
+SpatialIndex* Scene::updateSpatialIndex(Screen screen)
 {
-	std::vector<Uint32> toRemove;
+	if (!_spatialIndexEnabled)
+		return nullptr;
 
-	for (Uint32 i = 0; i < _childrenBot.size(); ++i)
+	updateTransform();
+	sortChildren();
+
+	if (screen == Screen::Top)
 	{
-		if (_childrenBot[i]->getName() == name)
-			toRemove.push_back(i);
+		_spatialIndex.update(_children);
+		return &_spatialIndex;
 	}
+	else
+	{
+		_spatialIndexBot.update(_childrenBot);
+		return &_spatialIndexBot;
+	}
+}
+
+//=============================================================================
+
+void Scene::queryNodes(const Rect& rect, Screen screen, std::vector<Node*>& result)
+{
+	auto index = updateSpatialIndex(screen);
 
-	for (auto& index : toRemove)
+	if (index)
 	{
-		_childrenBot.erase(_childrenBot.begin() + index);
+		index->queryRect(rect, result);
+		return;
+	}
+
+	result.clear();
+
+	for (auto& child : (screen == Screen::Top) ? _children : _childrenBot)
+	{
+		if (child->getBoundingBox().intersects(rect))
+			result.push_back(child.get());
+	}
+}
+
+//=============================================================================
+
+void Scene::queryNodes(const Vec2& center, float radius, Screen screen,
+	std::vector<Node*>& result)
+{
+	auto index = updateSpatialIndex(screen);
+
+	if (index)
+	{
+		index->queryRadius(center, radius, result);
+		return;
+	}
+
+	result.clear();
+
+	for (auto& child : (screen == Screen::Top) ? _children : _childrenBot)
+	{
+		// Distance from the center to the nearest point of the box
+		Rect box = child->getBoundingBox();
+		float dx = center.x - std::max(box.x, std::min(center.x, box.x + box.width));
+		float dy = center.y - std::max(box.y, std::min(center.y, box.y + box.height));
+
+		if (dx * dx + dy * dy <= radius * radius)
+			result.push_back(child.get());
 	}
 }
 
@@ -210,12 +301,9 @@ void Scene::addChild(const std::shared_ptr<Node>& child, int zOrder)
 {
 	if (child)
 	{
-		_children.push_back(child);
-		_children.back()->_parent = this;
-		_children.back()->_scene = this;
-		_children.back()->_zOrder = zOrder;
-
-		sortByZOrder();
+		child->_scene = this;
+		child->_zOrder = zOrder;
+		attachChild(_children, child);
 	}
 }
 
@@ -225,13 +313,10 @@ void Scene::addChild(const std::shared_ptr<Node>& child, int zOrder, int tag)
 {
 	if (child)
 	{
-		_children.push_back(child);
-		_children.back()->_parent = this;
-		_children.back()->_scene = this;
-		_children.back()->_zOrder = zOrder;
-		_children.back()->_tag = tag;
-
-		sortByZOrder();
+		child->_scene = this;
+		child->_zOrder = zOrder;
+		child->_tag = tag;
+		attachChild(_children, child);
 	}
 }
 
@@ -241,14 +326,23 @@ void Scene::addChild(const std::shared_ptr<Node>& child, int zOrder, const std::
 {
 	if (child)
 	{
-		_children.push_back(child);
-		_children.back()->_parent = this;
-		_children.back()->_scene = this;
-		_children.back()->_zOrder = zOrder;
-		_children.back()->_name = name;
+		child->_scene = this;
+		child->_zOrder = zOrder;
+		child->_name = name;
+		attachChild(_children, child);
+	}
+}
 
-		sortByZOrder();
+//=============================================================================
+
+void Scene::addChildren(const std::vector<std::shared_ptr<Node>>& children)
+{
+	for (auto& child : children)
+	{
+		child->_scene = this;
 	}
+
+	attachChildren(_children, children, _addCounter);
 }
 
 //=============================================================================
@@ -264,12 +358,9 @@ void Scene::addChildBot(const std::shared_ptr<Node>& child, int zOrder)
 {
 	if (child)
 	{
-		_childrenBot.push_back(child);
-		_childrenBot.back()->_parent = this;
-		_childrenBot.back()->_scene = this;
-		_childrenBot.back()->_zOrder = zOrder;
-
-		sortByZOrderBot();
+		child->_scene = this;
+		child->_zOrder = zOrder;
+		attachChild(_childrenBot, child);
 	}
 }
 
@@ -279,13 +370,10 @@ void Scene::addChildBot(const std::shared_ptr<Node>& child, int zOrder, int tag)
 {
 	if (child)
 	{
-		_childrenBot.push_back(child);
-		_childrenBot.back()->_parent = this;
-		_childrenBot.back()->_scene = this;
-		_childrenBot.back()->_zOrder = zOrder;
-		_childrenBot.back()->_tag = tag;
-
-		sortByZOrderBot();
+		child->_scene = this;
+		child->_zOrder = zOrder;
+		child->_tag = tag;
+		attachChild(_childrenBot, child);
 	}
 }
 
@@ -295,14 +383,23 @@ void Scene::addChildBot(const std::shared_ptr<Node>& child, int zOrder, const st
 {
 	if (child)
 	{
-		_childrenBot.push_back(child);
-		_childrenBot.back()->_parent = this;
-		_childrenBot.back()->_scene = this;
-		_childrenBot.back()->_zOrder = zOrder;
-		_childrenBot.back()->_name = name;
+		child->_scene = this;
+		child->_zOrder = zOrder;
+		child->_name = name;
+		attachChild(_childrenBot, child);
+	}
+}
 
-		sortByZOrderBot();
+//=============================================================================
+
+void Scene::addChildrenBot(const std::vector<std::shared_ptr<Node>>& children)
+{
+	for (auto& child : children)
+	{
+		child->_scene = this;
 	}
+
+	attachChildren(_childrenBot, children, _addCounterBot);
 }
 
 //=============================================================================
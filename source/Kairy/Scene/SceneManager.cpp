@@ -146,6 +146,42 @@ void SceneManager::update(float dt)
 
 //=============================================================================
 
+void SceneManager::beginCulling(const Vec2& screenSize)
+{
+	if (_cullingEnabled)
+	{
+		Node::beginCulling(Rect(Vec2::Zero, screenSize));
+	}
+}
+
+//=============================================================================
+
+void SceneManager::visitChildren(Scene* scene, Screen screen)
+{
+	auto& children = (screen == Screen::Top) ? scene->_children : scene->_childrenBot;
+	auto index = _cullingEnabled ? scene->updateSpatialIndex(screen) : nullptr;
+
+	if (!index)
+	{
+		for (auto& child : children)
+		{
+			child->visit();
+		}
+
+		return;
+	}
+
+	// The children away from the screen aren't visited at all
+	index->queryVisible(Rect(Vec2::Zero, scene->getScreenSize(screen)), _visibleNodes);
+
+	for (auto node : _visibleNodes)
+	{
+		node->visit();
+	}
+}
+
+//=============================================================================
+
 void SceneManager::draw()
 {
 	auto scene = getCurrentScene();
@@ -156,17 +192,16 @@ void SceneManager::draw()
 		auto prevScreen = device->getTargetScreen();		
 		
 		scene->updateTransform();
+		scene->sortChildren();
+		Node::resetCullingStats();
 
 		/*if (scene->getChildrenCount() > 0)
 		{*/
 			device->setTargetScreen(Screen::Top);
 			device->clear(scene->getColor());
 			device->startFrame();
-
-			for (auto& child : scene->getChildren())
-			{
-				child->draw();
-			}
+			beginCulling(scene->getTopScreenSize());
+			visitChildren(scene, Screen::Top);
 
 			device->endFrame();
 		//}
@@ -176,15 +211,13 @@ void SceneManager::draw()
 			device->setTargetScreen(Screen::Bottom);
 			device->clear(scene->getColorBot());
 			device->startFrame();
-
-			for (auto& child : scene->getChildrenBot())
-			{
-				child->draw();
-			}
+			beginCulling(scene->getBotScreenSize());
+			visitChildren(scene, Screen::Bottom);
 
 			device->endFrame();
 		//}
 
+		Node::endCulling();
 		device->setTargetScreen(prevScreen);
 
 		scene->draw();
@@ -219,9 +252,24 @@ void SceneManager::onTouchDown(Vec2 position, float dt)
 	{
 		scene->onTouchDown(position, dt);
 
-		for (auto& child : scene->_childrenBot)
+		auto index = scene->updateSpatialIndex(Screen::Bottom);
+
+		if (index)
 		{
-			child->onTouchDown(position, dt);
+			// Only the children under the touch can take it
+			index->queryPoint(position, _touchedNodes);
+
+			for (auto node : _touchedNodes)
+			{
+				node->onTouchDown(position, dt);
+			}
+		}
+		else
+		{
+			for (auto& child : scene->_childrenBot)
+			{
+				child->onTouchDown(position, dt);
+			}
 		}
 	}
 }
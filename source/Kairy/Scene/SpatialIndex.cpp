@@ -0,0 +1,384 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <Kairy/Scene/SpatialIndex.h>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+// Entries covering more cells are kept in a list tested one by one
+static const int kMaxEntryCells = 16;
+
+//=============================================================================
+
+static Rect mergeRects(const Rect& a, const Rect& b)
+{
+	float left = std::min(a.x, b.x);
+	float top = std::min(a.y, b.y);
+	float right = std::max(a.x + a.width, b.x + b.width);
+	float bottom = std::max(a.y + a.height, b.y + b.height);
+
+	return Rect(left, top, right - left, bottom - top);
+}
+
+//=============================================================================
+
+SpatialIndex::SpatialIndex(float cellSize)
+	: _cellSize(cellSize)
+	, _queryMark(0)
+{
+}
+
+//=============================================================================
+
+void SpatialIndex::setCellSize(float cellSize)
+{
+	if (cellSize > 0.0f && cellSize != _cellSize)
+	{
+		_cellSize = cellSize;
+		clear();
+	}
+}
+
+//=============================================================================
+
+void SpatialIndex::clear()
+{
+	_entries.clear();
+	_cells.clear();
+	_large.clear();
+	_unculled.clear();
+}
+
+//=============================================================================
+
+Uint64 SpatialIndex::cellKey(int x, int y)
+{
+	return ((Uint64)(Uint32)x << 32) | (Uint32)y;
+}
+
+//=============================================================================
+
+void SpatialIndex::update(const std::vector<std::shared_ptr<Node>>& nodes)
+{
+	bool changed = nodes.size() != _entries.size();
+
+	for (Uint32 i = 0; i < nodes.size() && !changed; ++i)
+	{
+		changed = _entries[i].node != nodes[i].get();
+	}
+
+	// Added, removed or sorted nodes move every index after them
+	if (changed)
+	{
+		clear();
+		_entries.resize(nodes.size());
+
+		for (Uint32 i = 0; i < nodes.size(); ++i)
+		{
+			_entries[i].node = nodes[i].get();
+			_entries[i].placed = false;
+			_entries[i].mark = 0;
+		}
+	}
+
+	_unculled.clear();
+
+	for (Uint32 i = 0; i < _entries.size(); ++i)
+	{
+		Entry& entry = _entries[i];
+		Node* node = entry.node;
+
+		node->updateTransform();
+
+		if (!entry.placed || entry.stamp != node->_boundsStamp)
+		{
+			entry.box = node->getBoundingBox();
+			entry.bounds = entry.box;
+
+			if (node->_hasSubtreeBounds)
+			{
+				entry.bounds = mergeRects(entry.bounds,
+					node->getCombinedTransform().transformRect(node->_subtreeBounds));
+			}
+
+			entry.stamp = node->_boundsStamp;
+			place(i);
+		}
+
+		// Same rules as Node::visit(), the others are always visited
+		entry.unculled = !node->_hasSubtreeBounds &&
+			!(node->_cullable && node->_cullingEnabled && node->_children.empty());
+
+		if (entry.unculled)
+		{
+			_unculled.push_back(i);
+		}
+	}
+}
+
+//=============================================================================
+
+void SpatialIndex::place(Uint32 index)
+{
+	Entry& entry = _entries[index];
+
+	if (entry.placed)
+	{
+		unplace(index);
+	}
+
+	const Rect& bounds = entry.bounds;
+
+	entry.cellLeft = (int)std::floor(bounds.x / _cellSize);
+	entry.cellTop = (int)std::floor(bounds.y / _cellSize);
+	entry.cellRight = (int)std::floor((bounds.x + bounds.width) / _cellSize);
+	entry.cellBottom = (int)std::floor((bounds.y + bounds.height) / _cellSize);
+
+	int cells = (entry.cellRight - entry.cellLeft + 1) * (entry.cellBottom - entry.cellTop + 1);
+	entry.large = cells > kMaxEntryCells || cells <= 0;
+	entry.placed = true;
+
+	if (entry.large)
+	{
+		_large.push_back(index);
+		return;
+	}
+
+	for (int y = entry.cellTop; y <= entry.cellBottom; ++y)
+	{
+		for (int x = entry.cellLeft; x <= entry.cellRight; ++x)
+		{
+			_cells[cellKey(x, y)].push_back(index);
+		}
+	}
+}
+
+//=============================================================================
+
+void SpatialIndex::unplace(Uint32 index)
+{
+	Entry& entry = _entries[index];
+
+	auto removeFrom = [index](std::vector<Uint32>& indices)
+	{
+		auto it = std::find(indices.begin(), indices.end(), index);
+
+		if (it != indices.end())
+		{
+			*it = indices.back();
+			indices.pop_back();
+		}
+	};
+
+	if (entry.large)
+	{
+		removeFrom(_large);
+	}
+	else
+	{
+		for (int y = entry.cellTop; y <= entry.cellBottom; ++y)
+		{
+			for (int x = entry.cellLeft; x <= entry.cellRight; ++x)
+			{
+				auto it = _cells.find(cellKey(x, y));
+
+				if (it != _cells.end())
+				{
+					removeFrom(it->second);
+				}
+			}
+		}
+	}
+
+	entry.placed = false;
+}
+
+//=============================================================================
+
+template <typename Func>
+void SpatialIndex::forEachCandidate(const Rect& rect, Func func) const
+{
+	// A new mark skips the entries already met in an other cell
+	if (++_queryMark == 0)
+	{
+		for (auto& entry : _entries)
+		{
+			entry.mark = 0;
+		}
+
+		_queryMark = 1;
+	}
+
+	auto visit = [&](Uint32 index)
+	{
+		const Entry& entry = _entries[index];
+
+		if (entry.mark != _queryMark)
+		{
+			entry.mark = _queryMark;
+			func(index, entry);
+		}
+	};
+
+	for (auto index : _large)
+	{
+		visit(index);
+	}
+
+	int left = (int)std::floor(rect.x / _cellSize);
+	int top = (int)std::floor(rect.y / _cellSize);
+	int right = (int)std::floor((rect.x + rect.width) / _cellSize);
+	int bottom = (int)std::floor((rect.y + rect.height) / _cellSize);
+
+	// A query wider than the grid walks the cells instead of the rect
+	if ((Uint64)(right - left + 1) * (Uint64)(bottom - top + 1) > _cells.size())
+	{
+		for (auto& cell : _cells)
+		{
+			int x = (int)(Uint32)(cell.first >> 32);
+			int y = (int)(Uint32)cell.first;
+
+			if (x >= left && x <= right && y >= top && y <= bottom)
+			{
+				for (auto index : cell.second)
+				{
+					visit(index);
+				}
+			}
+		}
+
+		return;
+	}
+
+	for (int y = top; y <= bottom; ++y)
+	{
+		for (int x = left; x <= right; ++x)
+		{
+			auto it = _cells.find(cellKey(x, y));
+
+			if (it != _cells.end())
+			{
+				for (auto index : it->second)
+				{
+					visit(index);
+				}
+			}
+		}
+	}
+}
+
+//=============================================================================
+
+void SpatialIndex::sortResult(std::vector<Uint32>& indices, std::vector<Node*>& result) const
+{
+	std::sort(indices.begin(), indices.end());
+
+	result.clear();
+	result.reserve(indices.size());
+
+	for (auto index : indices)
+	{
+		result.push_back(_entries[index].node);
+	}
+}
+
+//=============================================================================
+
+void SpatialIndex::queryRect(const Rect& rect, std::vector<Node*>& result) const
+{
+	_found.clear();
+
+	forEachCandidate(rect, [&](Uint32 index, const Entry& entry)
+	{
+		if (entry.box.intersects(rect))
+			_found.push_back(index);
+	});
+
+	sortResult(_found, result);
+}
+
+//=============================================================================
+
+void SpatialIndex::queryPoint(const Vec2& point, std::vector<Node*>& result) const
+{
+	_found.clear();
+
+	forEachCandidate(Rect(point, Vec2::Zero), [&](Uint32 index, const Entry& entry)
+	{
+		if (entry.box.containsPoint(point))
+			_found.push_back(index);
+	});
+
+	sortResult(_found, result);
+}
+
+//=============================================================================
+
+void SpatialIndex::queryRadius(const Vec2& center, float radius, std::vector<Node*>& result) const
+{
+	_found.clear();
+
+	Rect rect(center.x - radius, center.y - radius, radius * 2.0f, radius * 2.0f);
+
+	forEachCandidate(rect, [&](Uint32 index, const Entry& entry)
+	{
+		// Distance from the center to the nearest point of the box
+		const Rect& box = entry.box;
+		float dx = center.x - std::max(box.x, std::min(center.x, box.x + box.width));
+		float dy = center.y - std::max(box.y, std::min(center.y, box.y + box.height));
+
+		if (dx * dx + dy * dy <= radius * radius)
+			_found.push_back(index);
+	});
+
+	sortResult(_found, result);
+}
+
+//=============================================================================
+
+void SpatialIndex::queryVisible(const Rect& view, std::vector<Node*>& result) const
+{
+	_found.clear();
+
+	forEachCandidate(view, [&](Uint32 index, const Entry& entry)
+	{
+		if (entry.unculled || entry.bounds.intersects(view))
+			_found.push_back(index);
+	});
+
+	// The candidates are marked, the others are added once
+	for (auto index : _unculled)
+	{
+		if (_entries[index].mark != _queryMark)
+			_found.push_back(index);
+	}
+
+	sortResult(_found, result);
+}
+
+//=============================================================================
+
+NS_KAIRY_END
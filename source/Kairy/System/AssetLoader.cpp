@@ -0,0 +1,461 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <Kairy/System/AssetLoader.h>
+#include <Kairy/System/StopWatch.h>
+#include <Kairy/Graphics/Font.h>
+#include <Kairy/Graphics/Image.h>
+#include <Kairy/Graphics/ImageLoader.h>
+#include <Kairy/Graphics/TextureContainer.h>
+#include <Kairy/Audio/SoundData.h>
+#include <Kairy/Tmx/TmxMap.h>
+#include <Kairy/Util/ReadFile.h>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+static std::unique_ptr<AssetLoader> s_sharedAssetLoader = nullptr;
+
+// Image decoders recurse and keep big locals, the default stack is too small
+static const Uint32 kWorkerStackSize = 64 * 1024;
+
+//=============================================================================
+
+AssetLoader* AssetLoader::getInstance()
+{
+	if (!s_sharedAssetLoader)
+	{
+		s_sharedAssetLoader.reset(new AssetLoader());
+	}
+
+	return s_sharedAssetLoader.get();
+}
+
+//=============================================================================
+
+AssetLoader::AssetLoader(void)
+	: _running(false)
+#ifdef _3DS
+	, _workersCount(1)
+#else
+	, _workersCount(2)
+#endif // _3DS
+	, _uploadBudget(Time::milliseconds(4))
+	, _queuedCount(0)
+	, _doneCount(0)
+{
+}
+
+//=============================================================================
+
+AssetLoader::~AssetLoader()
+{
+	stopWorkers();
+}
+
+//=============================================================================
+
+AssetLoader::RequestPtr AssetLoader::enqueue(const Task& task,
+	const Finisher& finisher, const Callback& callback)
+{
+	auto job = std::make_shared<Job>();
+
+	job->task = task;
+	job->finisher = finisher;
+	job->callback = callback;
+	job->request = std::make_shared<Request>();
+	job->succeeded = false;
+
+	if (_queuedCount == _doneCount)
+	{
+		_queuedCount = 0;
+		_doneCount = 0;
+	}
+
+	++_queuedCount;
+
+	if (!_running)
+	{
+		startWorkers();
+	}
+
+	{
+		Lock lock(_mutex);
+		_pending.push_back(job);
+	}
+
+	_pendingSignal.post();
+
+	return job->request;
+}
+
+//=============================================================================
+
+AssetLoader::RequestPtr AssetLoader::loadTexture(const std::shared_ptr<Texture>& texture,
+	const std::string& filename, const Callback& callback, Texture::Location location)
+{
+	// A container is read as it is, images are decoded to RGBA8
+	struct Decoded
+	{
+		Decoded(void)
+			: pixels(nullptr)
+			, width(0)
+			, height(0)
+			, format(Texture::Format::Default)
+			, mipLevels(1)
+		{}
+
+		~Decoded()
+		{
+			ImageLoader::FreeImage(pixels);
+		}
+
+		byte* pixels;
+		std::vector<byte> texels;
+		int width;
+		int height;
+		Texture::Format format;
+		int mipLevels;
+	};
+
+	auto decoded = std::make_shared<Decoded>();
+	bool container = TextureContainer::isContainer(filename);
+
+	// Shared and cached under the same name as Texture::load(filename)
+	std::string resourceName = texture->getFileResourceName(filename, location);
+
+	// The file is already loaded, the finisher only takes a reference
+	Task task = nullptr;
+
+	if (!Texture::isShared(resourceName))
+	{
+		task = [decoded, filename, container]()
+		{
+			if (container)
+			{
+				TextureContainer file;
+
+				if (!file.open(filename))
+				{
+					return false;
+				}
+
+				// The 3DS reads the levels one after the other, the PC builds them
+#ifdef _3DS
+				int levels = file.getLevelsCount();
+#else
+				int levels = 1;
+#endif // _3DS
+
+				Uint32 size = 0;
+
+				for (int level = 0; level < levels; ++level)
+				{
+					size += file.getLevelSize(level);
+				}
+
+				decoded->texels.resize(size);
+				decoded->width = file.getWidth();
+				decoded->height = file.getHeight();
+				decoded->format = file.getFormat();
+				decoded->mipLevels = file.getLevelsCount();
+
+				byte* levelTexels = decoded->texels.data();
+
+				for (int level = 0; level < levels; ++level)
+				{
+					if (!file.readNativeLevel(level, levelTexels))
+					{
+						return false;
+					}
+
+					levelTexels += file.getLevelSize(level);
+				}
+
+				return true;
+			}
+
+			decoded->pixels = ImageLoader::LoadFromFile(filename,
+				decoded->width, decoded->height, PixelFormat::RGBA8);
+
+			return decoded->pixels != nullptr;
+		};
+	}
+
+	auto finisher = [decoded, texture, filename, resourceName, location, container]()
+	{
+		texture->unload();
+
+		// Loaded meanwhile by another request or by Texture::load()
+		if (texture->loadShared(resourceName))
+		{
+			return true;
+		}
+
+		if (container && !decoded->texels.empty())
+		{
+			return texture->loadFileTexels(resourceName, decoded->texels.data(),
+				(Uint32)decoded->texels.size(), decoded->width, decoded->height,
+				decoded->format, decoded->mipLevels, location);
+		}
+
+		if (decoded->pixels)
+		{
+			return texture->loadFilePixels(resourceName, decoded->pixels,
+				decoded->width, decoded->height, location);
+		}
+
+		// The shared texture was released before the finisher ran
+		return texture->load(filename, location);
+	};
+
+	return enqueue(task, finisher, callback);
+}
+
+//=============================================================================
+
+AssetLoader::RequestPtr AssetLoader::loadFont(const std::shared_ptr<Font>& font,
+	const std::string& filename, float size, const Callback& callback,
+	Texture::Location location)
+{
+	auto pages = std::make_shared<std::vector<Image>>();
+
+	// The old pages are textures, release them here and not on the worker
+	font->unload();
+
+	auto task = [font, filename, size, pages]()
+	{
+		std::vector<byte> fontData;
+
+		if (!util::ReadAllBytes(filename, fontData))
+		{
+			return false;
+		}
+
+		return font->bakeTtf(fontData.data(), size, *pages);
+	};
+
+	auto finisher = [font, pages, location]()
+	{
+		font->loadPages(*pages, location);
+		return true;
+	};
+
+	return enqueue(task, finisher, callback);
+}
+
+//=============================================================================
+
+AssetLoader::RequestPtr AssetLoader::loadSound(const std::shared_ptr<SoundData>& sound,
+	const std::string& filename, const Callback& callback)
+{
+	return enqueue([sound, filename]() { return sound->load(filename); },
+		nullptr, callback);
+}
+
+//=============================================================================
+
+AssetLoader::RequestPtr AssetLoader::loadTmxMap(const std::shared_ptr<TmxMap>& map,
+	const std::string& filename, const Callback& callback)
+{
+	return enqueue([map, filename]() { return map->load(filename); },
+		nullptr, callback);
+}
+
+//=============================================================================
+
+void AssetLoader::update()
+{
+	StopWatch watch;
+	watch.start();
+
+	// At least one finisher per frame, so a slow one can't stall the queue
+	do
+	{
+		JobPtr job;
+
+		{
+			Lock lock(_mutex);
+
+			if (_completed.empty())
+			{
+				break;
+			}
+
+			job = _completed.front();
+			_completed.pop_front();
+		}
+
+		finish(job);
+	}
+	while (watch.getElapsedTime() < _uploadBudget);
+}
+
+//=============================================================================
+
+void AssetLoader::waitAll()
+{
+	while (getPendingCount() > 0)
+	{
+		JobPtr job;
+
+		{
+			Lock lock(_mutex);
+
+			if (!_completed.empty())
+			{
+				job = _completed.front();
+				_completed.pop_front();
+			}
+		}
+
+		if (job)
+		{
+			finish(job);
+		}
+		else
+		{
+			Thread::sleep(Time::milliseconds(1));
+		}
+	}
+}
+
+//=============================================================================
+
+int AssetLoader::getPendingCount() const
+{
+	return _queuedCount - _doneCount;
+}
+
+//=============================================================================
+
+float AssetLoader::getProgress() const
+{
+	if (_queuedCount == 0)
+	{
+		return 1.0f;
+	}
+
+	return (float)_doneCount / (float)_queuedCount;
+}
+
+//=============================================================================
+
+void AssetLoader::startWorkers()
+{
+	_running = true;
+
+	for (int i = 0; i < _workersCount; ++i)
+	{
+		std::unique_ptr<Thread> worker(new Thread([this](void*)
+		{
+			workerLoop();
+		}, kWorkerStackSize));
+
+		worker->start(nullptr, Thread::Priority::Low);
+		_workers.push_back(std::move(worker));
+	}
+}
+
+//=============================================================================
+
+void AssetLoader::stopWorkers()
+{
+	_running = false;
+
+	// Wake the idle workers so they see the loader stopping
+	if (!_workers.empty())
+	{
+		_pendingSignal.post((int)_workers.size());
+	}
+
+	for (auto& worker : _workers)
+	{
+		worker->join();
+	}
+
+	_workers.clear();
+}
+
+//=============================================================================
+
+void AssetLoader::workerLoop()
+{
+	while (true)
+	{
+		// Sleeps until a job is queued, an idle loader costs no wake-ups
+		_pendingSignal.wait();
+
+		if (!_running)
+		{
+			break;
+		}
+
+		JobPtr job;
+
+		{
+			Lock lock(_mutex);
+
+			if (!_pending.empty())
+			{
+				job = _pending.front();
+				_pending.pop_front();
+			}
+		}
+
+		if (!job)
+		{
+			continue;
+		}
+
+		job->succeeded = !job->task || job->task();
+
+		Lock lock(_mutex);
+		_completed.push_back(job);
+	}
+}
+
+//=============================================================================
+
+void AssetLoader::finish(const JobPtr& job)
+{
+	if (job->succeeded && job->finisher)
+	{
+		job->succeeded = job->finisher();
+	}
+
+	job->request->_done = true;
+	job->request->_loaded = job->succeeded;
+
+	++_doneCount;
+
+	if (job->callback)
+	{
+		job->callback(job->succeeded);
+	}
+}
+
+//=============================================================================
+
+NS_KAIRY_END
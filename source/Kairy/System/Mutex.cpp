@@ -0,0 +1,70 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2015 Nanni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <Kairy/System/Mutex.h>
+
+NS_KAIRY_BEGIN
+
+//=============================================================================
+
+Mutex::Mutex(void)
+{
+#ifdef _3DS
+	svcCreateMutex(&_handle, false);
+#endif // _3DS
+}
+
+//=============================================================================
+
+Mutex::~Mutex()
+{
+#ifdef _3DS
+	svcCloseHandle(_handle);
+#endif // _3DS
+}
+
+//=============================================================================
+
+void Mutex::lock()
+{
+#ifdef _3DS
+	svcWaitSynchronization(_handle, U64_MAX);
+#else
+	_mutex.lock();
+#endif // _3DS
+}
+
+//=============================================================================
+
+void Mutex::unlock()
+{
+#ifdef _3DS
+	svcReleaseMutex(_handle);
+#else
+	_mutex.unlock();
+#endif // _3DS
+}
+
+//=============================================================================
+
+NS_KAIRY_END
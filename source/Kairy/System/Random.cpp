@@ -144,4 +144,17 @@ bool Random::nextBoolean() const
 
 //=============================================================================
 
+void Random::fill(float* values, Uint32 count, float min, float max) const
+{
+	// 24 random bits are exactly representable by a float
+	const float scale = (max - min) / 16777216.0f;
+
+	for (Uint32 i = 0; i < count; ++i)
+	{
+		values[i] = float(sfmt_genrand_uint32(&_sfmt) >> 8) * scale + min;
+	}
+}
+
+//=============================================================================
+
 NS_KAIRY_END
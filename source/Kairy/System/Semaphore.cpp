@@ -22,61 +22,62 @@
  *
  *****************************************************************************/
 
-#include "VertexPool.h"
+#include <Kairy/System/Semaphore.h>
 
 NS_KAIRY_BEGIN
 
 //=============================================================================
 
-static VertexPool* s_sharedVertexPool = nullptr;
-
-//=============================================================================
-
-VertexPool* VertexPool::getInstance()
-{
-    if(!s_sharedVertexPool)
-    {
-        s_sharedVertexPool = new VertexPool();
-    }
-
-    return s_sharedVertexPool;
-}
-
-//=============================================================================
-
-VertexPool::VertexPool()
+Semaphore::Semaphore(void)
+#ifndef _3DS
+	: _count(0)
+#endif // _3DS
 {
-    _vertices = linearAlloc(START_SIZE);
-    _size = START_SIZE;
-    _index = 0;
+#ifdef _3DS
+	svcCreateSemaphore(&_handle, 0, 0x7FFFFFFF);
+#endif // _3DS
 }
 
 //=============================================================================
 
-VertexPool::~VertexPool()
+Semaphore::~Semaphore()
 {
-    linearFree(_vertices);
+#ifdef _3DS
+	svcCloseHandle(_handle);
+#endif // _3DS
 }
 
 //=============================================================================
 
-void VertexPool::clear()
+void Semaphore::post(int count)
 {
-    _index = 0;
+#ifdef _3DS
+	s32 previous;
+	svcReleaseSemaphore(&previous, _handle, count);
+#else
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_count += count;
+	}
+
+	if (count == 1)
+		_condition.notify_one();
+	else
+		_condition.notify_all();
+#endif // _3DS
 }
 
 //=============================================================================
 
-void* VertexPool::pushVertices(Uint32 size, Uint32 count)
+void Semaphore::wait()
 {
-    Uint32 required_bytes = count * size;
-    if(_index + required_bytes >= _size)
-    {
-        _size += 1024;
-        _vertices = linearRealloc(_vertices, _size);
-    }
-    _index += required_bytes;
-    return ((byte*)_vertices) + _index;
+#ifdef _3DS
+	svcWaitSynchronization(_handle, U64_MAX);
+#else
+	std::unique_lock<std::mutex> lock(_mutex);
+	_condition.wait(lock, [this] { return _count > 0; });
+	_count--;
+#endif // _3DS
 }
 
 //=============================================================================
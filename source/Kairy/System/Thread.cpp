@@ -15,7 +15,8 @@ Thread::Thread(void)
 	_core = CpuCore::Default;
 
 #ifdef _3DS
-	_stack = (u32*)memalign(32, sizeof(u32) * STACK_SIZE);
+	_stackSize = STACK_SIZE;
+	_stack = (u32*)memalign(32, _stackSize);
 	_handle = 0;
 #endif // _3DS
 }
@@ -30,6 +31,22 @@ Thread::Thread(const Callback & callback)
 
 //=============================================================================
 
+Thread::Thread(const Callback & callback, Uint32 stackSize)
+	: Thread()
+{
+	_callback = callback;
+
+#ifdef _3DS
+	free(_stack);
+	_stackSize = (stackSize + 7) & ~7;
+	_stack = (u32*)memalign(32, _stackSize);
+#else
+	(void)stackSize;
+#endif // _3DS
+}
+
+//=============================================================================
+
 Thread::~Thread()
 {
 	join();
@@ -53,7 +70,7 @@ bool Thread::start(void* userdata, Priority priority, CpuCore core)
 	_core = core;
 
 	svcCreateThread(&_handle, &Thread::svcThreadFunc,
-		(u32)this, &_stack[STACK_SIZE/sizeof(u32)], (int)priority, (int)core);
+		(u32)this, &_stack[_stackSize/sizeof(u32)], (int)priority, (int)core);
 #else
 	_thread = std::thread(_callback, userdata);
 #endif // _3DS
@@ -85,6 +102,7 @@ void Thread::join()
 	{
 		svcWaitSynchronization(_handle, U64_MAX);
 		svcCloseHandle(_handle);
+		_handle = 0;
 	}
 #else
 	if (_thread.joinable())
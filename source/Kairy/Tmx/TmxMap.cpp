@@ -37,6 +37,8 @@ TmxMap::TmxMap(void)
     ,_tileHeight(0)
     ,_bgColor(Color::Transparent)
     ,_orientation(Orientation::Isometric)
+    ,_staggerAxis(StaggerAxis::Y)
+    ,_staggerIndex(StaggerIndex::Odd)
 {
 }
 
@@ -194,6 +196,8 @@ bool TmxMap::load(void* p, const std::string& path)
     _tileWidth = 0;
     _tileHeight = 0;
     _orientation = Orientation::Orthogonal;
+    _staggerAxis = StaggerAxis::Y;
+    _staggerIndex = StaggerIndex::Odd;
     _bgColor = Color::Transparent;
     _path = "";
 
@@ -238,6 +242,26 @@ bool TmxMap::load(void* p, const std::string& path)
         }
     }
 
+    if(element->Attribute("staggeraxis"))
+    {
+        std::string axisStr = element->Attribute("staggeraxis");
+
+        if(axisStr == "x")
+        {
+            _staggerAxis = StaggerAxis::X;
+        }
+    }
+
+    if(element->Attribute("staggerindex"))
+    {
+        std::string indexStr = element->Attribute("staggerindex");
+
+        if(indexStr == "even")
+        {
+            _staggerIndex = StaggerIndex::Even;
+        }
+    }
+
     auto childElement = element->FirstChildElement();
 
     int layerIndex = 0;
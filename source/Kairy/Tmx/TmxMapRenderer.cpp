@@ -24,6 +24,7 @@
 
 #include <Kairy/Tmx/TmxMapRenderer.h>
 #include <Kairy/Graphics/RenderDevice.h>
+#include <Kairy/Graphics/TextureResidency.h>
 
 NS_KAIRY_BEGIN
 
@@ -59,6 +60,14 @@ TmxMapRenderer::TmxMapRenderer(void)
 	, _tileHeight(0)
 	, _loaded(false)
 	, _type(TmxMap::Orientation::Orthogonal)
+	, _staggerAxis(TmxMap::StaggerAxis::Y)
+	, _staggerIndex(TmxMap::StaggerIndex::Odd)
+	, _chunksX(0)
+	, _chunksY(0)
+	, _tilesOverhangX(0)
+	, _tilesOverhangY(0)
+	, _animationStamp(0)
+	, _streaming(false)
 {
 	setCamera(Rect(0.0f, 0.0f, TOP_SCREEN_WIDTH, TOP_SCREEN_HEIGHT));
 }
@@ -99,61 +108,105 @@ void TmxMapRenderer::draw(int layerIndex)
 
 	updateTransform();
 
-	if (_color.a > 0 && _type == TmxMap::Orientation::Orthogonal)
+	if (_color.a > 0)
 	{
-		int startX = int(_camera.x) / _tileWidth;
-		int startY = int(_camera.y) / _tileHeight;
-		int offsX = int(_camera.x) % _tileWidth;
-		int offsY = int(_camera.y) % _tileHeight;
-		int width = int(_camera.width) / _tileWidth + 1 + (offsX ? 1 : 0);
-		int height = int(_camera.height) / _tileHeight + 1 + (offsY ? 1 : 0);
-
 		Layer& layer = _layers[layerIndex];
+		Color color(_color, layer.opacity);
 
-		if (_type == TmxMap::Orientation::Orthogonal)
-		{
-			for (int x = 0; x < width; ++x)
-			{
-				for (int y = 0; y < height; ++y)
-				{
-					int ix = x + startX;
-					int iy = y + startY;
+		// Snap the camera to whole pixels to avoid seams between the tiles
+		Rect camera(std::floor(_camera.x), std::floor(_camera.y),
+			_camera.width, _camera.height);
 
-					if (ix < 0 || iy < 0 || ix >= _mapWidth || iy >= _mapHeight)
-						continue;
+		// Tiles bigger than the map tiles overhang into the next cells,
+		// down for orthogonal maps and up for the other orientations
+		Rect area(camera.x - _tilesOverhangX, camera.y,
+			camera.width + _tilesOverhangX, camera.height + _tilesOverhangY);
 
-					Tile& tile = layer.tiles[ix + iy * _mapWidth];
+		if (_type == TmxMap::Orientation::Orthogonal)
+		{
+			area.y -= _tilesOverhangY;
+		}
 
-					if (tile.id < 0 || tile.tilesetIndex < 0 ||
-						tile.tilesetIndex >= (int)_tilesets.size())
-					{
-						continue;
-					}
+		// Find the chunks under the camera, the corners of the
+		// isometric chunks not on screen are culled by their bounds
+		Vec2 corners[4] =
+		{
+			pixelToChunkSpace(area.getLeft(), area.getTop()),
+			pixelToChunkSpace(area.getRight(), area.getTop()),
+			pixelToChunkSpace(area.getLeft(), area.getBottom()),
+			pixelToChunkSpace(area.getRight(), area.getBottom())
+		};
 
-					auto& tileset = _tilesets[tile.tilesetIndex];
+		float minU = corners[0].x, maxU = corners[0].x;
+		float minV = corners[0].y, maxV = corners[0].y;
 
-					short id = getTileAnimId(tile);
+		for (auto& corner : corners)
+		{
+			minU = std::min(minU, corner.x);
+			maxU = std::max(maxU, corner.x);
+			minV = std::min(minV, corner.y);
+			maxV = std::max(maxV, corner.y);
+		}
 
-					int srcX = (id % (tileset->columns - tileset->margin * 2 + tileset->spacing)) * tileset->tileWidth;
-					int srcY = (id / (tileset->columns - tileset->margin * 2 + tileset->spacing)) * tileset->tileHeight;
+		int endU = int(std::floor(maxU)) + 2;
+		int endV = int(std::floor(maxV)) + 2;
 
-					float screenX = float(x * _tileWidth);
-					float screenY = float(y * _tileHeight);
+		if (endU >= 0 && endV >= 0)
+		{
+			int startX = std::max(0, int(std::floor(minU)) - 2) / CHUNK_SIZE;
+			int startY = std::max(0, int(std::floor(minV)) - 2) / CHUNK_SIZE;
+			int endX = std::min(_chunksX - 1, endU / CHUNK_SIZE);
+			int endY = std::min(_chunksY - 1, endV / CHUNK_SIZE);
+
+			// The chunks are built in map space, the camera is applied
+			// by the modelview
+			Affine2D modelview = getCombinedTransform() *
+				Affine2D::createTranslation(-camera.x, -camera.y);
+
+			// Every chunk is drawn as a few streams of quads,
+			// everything submitted before must be drawn first
+			_device->flush();
+			_device->setBlendMode(_blendMode);
+
+			// Drawing the chunks row by row keeps the tiles back to front
+			for (int chunkY = startY; chunkY <= endY; ++chunkY)
+			{
+				for (int chunkX = startX; chunkX <= endX; ++chunkX)
+				{
+					int index = chunkX + chunkY * _chunksX;
 
-					auto& sprite = tileset->sprite;
+					if (!_chunksBounds[index].intersects(camera))
+					{
+						continue;
+					}
 
-					sprite.setColor(_color);
-					sprite.setOpacity(layer.opacity);
-					sprite.setTextureRect(Rect((float)srcX, (float)srcY,
-						(float)tileset->tileWidth, (float)tileset->tileHeight));
-					sprite.setPosition(screenX, screenY);
+					Chunk& chunk = layer.chunks[index];
 
-					sprite.updateTransform();
-					sprite.setTransform(getCombinedTransform() * sprite.getTransform());
+					if (chunk.dirty)
+					{
+						buildChunk(layer, chunkX, chunkY, color);
+					}
+					else
+					{
+						if (chunk.color != color)
+						{
+							updateChunkColor(chunk, color);
+						}
+
+						if (chunk.animationStamp != _animationStamp)
+						{
+							updateChunkAnimations(chunk);
+						}
+					}
 
-					sprite.draw();
+					drawChunk(chunk, modelview);
 				}
 			}
+
+			if (_streaming)
+			{
+				prefetchChunks(layer, startX, startY, endX, endY, color);
+			}
 		}
 	} /* _color.a > 0 */
 
@@ -186,6 +239,9 @@ void TmxMapRenderer::update(float dt)
 					animation.currentFrame = 0;
 				}
 				animation.animTime = 0.0f;
+
+				// The visible chunks update their texture coordinates
+				_animationStamp++;
 			}
 		}
 	}
@@ -193,6 +249,28 @@ void TmxMapRenderer::update(float dt)
 
 //=============================================================================
 
+void TmxMapRenderer::setStreamingEnabled(bool enabled)
+{
+	if (enabled == _streaming)
+	{
+		return;
+	}
+
+	_streaming = enabled;
+
+	auto residency = TextureResidency::getInstance();
+
+	for (auto& tileset : _tilesets)
+	{
+		if (_streaming)
+			residency->manage(tileset->sprite.getTexture());
+		else
+			residency->unmanage(tileset->sprite.getTexture());
+	}
+}
+
+//=============================================================================
+
 int TmxMapRenderer::getTileId(int layer, int x, int y) const
 {
 	if (layer < 0 || layer >= (int)_layers.size() ||
@@ -216,7 +294,19 @@ void TmxMapRenderer::setTileId(int layer, int x, int y, int id)
 		return;
 	}
 
-	_layers[layer].tiles[x + y * _mapWidth].id = id;
+	Layer& tilesLayer = _layers[layer];
+	Tile& tile = tilesLayer.tiles[x + y * _mapWidth];
+
+	if (tile.id != id)
+	{
+		tile.id = id;
+
+		// Only the chunk containing the tile has to be built again
+		int u, v;
+		toChunkSpace(x, y, u, v);
+
+		tilesLayer.chunks[(u / CHUNK_SIZE) + (v / CHUNK_SIZE) * _chunksX].dirty = true;
+	}
 }
 
 //=============================================================================
@@ -236,6 +326,310 @@ short TmxMapRenderer::getTileAnimId(const Tile& tile)
 
 //=============================================================================
 
+int TmxMapRenderer::getMapWidthInPixels() const
+{
+	switch (_type)
+	{
+	case TmxMap::Orientation::Isometric:
+		return (_mapWidth + _mapHeight) * _tileWidth / 2;
+
+	case TmxMap::Orientation::Staggered:
+		if (_staggerAxis == TmxMap::StaggerAxis::X)
+			return (_mapWidth + 1) * _tileWidth / 2;
+		else
+			return _mapWidth * _tileWidth + _tileWidth / 2;
+
+	default:
+		return _mapWidth * _tileWidth;
+	}
+}
+
+//=============================================================================
+
+int TmxMapRenderer::getMapHeightInPixels() const
+{
+	switch (_type)
+	{
+	case TmxMap::Orientation::Isometric:
+		return (_mapWidth + _mapHeight) * _tileHeight / 2;
+
+	case TmxMap::Orientation::Staggered:
+		if (_staggerAxis == TmxMap::StaggerAxis::X)
+			return _mapHeight * _tileHeight + _tileHeight / 2;
+		else
+			return (_mapHeight + 1) * _tileHeight / 2;
+
+	default:
+		return _mapHeight * _tileHeight;
+	}
+}
+
+//=============================================================================
+
+Vec2 TmxMapRenderer::getTilePosition(int x, int y) const
+{
+	float halfWidth = _tileWidth * 0.5f;
+	float halfHeight = _tileHeight * 0.5f;
+
+	switch (_type)
+	{
+	case TmxMap::Orientation::Isometric:
+		return Vec2((x - y + _mapHeight - 1) * halfWidth, (x + y) * halfHeight);
+
+	case TmxMap::Orientation::Staggered:
+		if (_staggerAxis == TmxMap::StaggerAxis::X)
+		{
+			return Vec2(x * halfWidth,
+				y * _tileHeight + (isStaggered(x) ? halfHeight : 0.0f));
+		}
+		else
+		{
+			return Vec2(x * _tileWidth + (isStaggered(y) ? halfWidth : 0.0f),
+				y * halfHeight);
+		}
+
+	default:
+		return Vec2(float(x * _tileWidth), float(y * _tileHeight));
+	}
+}
+
+//=============================================================================
+
+bool TmxMapRenderer::isStaggered(int index) const
+{
+	if (_staggerIndex == TmxMap::StaggerIndex::Odd)
+		return (index & 1) != 0;
+	else
+		return (index & 1) == 0;
+}
+
+//=============================================================================
+
+void TmxMapRenderer::toChunkSpace(int x, int y, int& u, int& v) const
+{
+	if (_type != TmxMap::Orientation::Staggered)
+	{
+		u = x;
+		v = y;
+		return;
+	}
+
+	// The staggered index along the axis is counted in half tiles,
+	// it has the same parity as the other index so that u and v are
+	// the coordinates of the equivalent isometric cell
+	int even = (_staggerIndex == TmxMap::StaggerIndex::Even) ? 1 : 0;
+
+	if (_staggerAxis == TmxMap::StaggerAxis::X)
+	{
+		int b = 2 * y + (isStaggered(x) ? 1 : 0) - even;
+		u = (x + b) / 2;
+		v = (b - x) / 2 + _mapWidth;
+	}
+	else
+	{
+		int a = 2 * x + (isStaggered(y) ? 1 : 0) - even;
+		u = (y + a) / 2;
+		v = (y - a) / 2 + _mapWidth;
+	}
+}
+
+//=============================================================================
+
+bool TmxMapRenderer::fromChunkSpace(int u, int v, int& x, int& y) const
+{
+	if (_type != TmxMap::Orientation::Staggered)
+	{
+		x = u;
+		y = v;
+	}
+	else
+	{
+		int even = (_staggerIndex == TmxMap::StaggerIndex::Even) ? 1 : 0;
+
+		if (_staggerAxis == TmxMap::StaggerAxis::X)
+		{
+			x = u - (v - _mapWidth);
+			int b = u + (v - _mapWidth);
+			y = (b - (isStaggered(x) ? 1 : 0) + even) / 2;
+		}
+		else
+		{
+			y = u + (v - _mapWidth);
+			int a = u - (v - _mapWidth);
+			x = (a - (isStaggered(y) ? 1 : 0) + even) / 2;
+		}
+	}
+
+	return x >= 0 && y >= 0 && x < _mapWidth && y < _mapHeight;
+}
+
+//=============================================================================
+
+Vec2 TmxMapRenderer::pixelToChunkSpace(float x, float y) const
+{
+	float tileX = x / _tileWidth;
+	float tileY = y / _tileHeight;
+
+	switch (_type)
+	{
+	case TmxMap::Orientation::Isometric:
+		tileX -= _mapHeight * 0.5f;
+		return Vec2(tileY + tileX, tileY - tileX);
+
+	case TmxMap::Orientation::Staggered:
+	{
+		float even = (_staggerIndex == TmxMap::StaggerIndex::Even) ? 0.5f : 0.0f;
+
+		if (_staggerAxis == TmxMap::StaggerAxis::X)
+			tileY -= even;
+		else
+			tileX -= even;
+
+		return Vec2(tileY + tileX, tileY - tileX + _mapWidth);
+	}
+
+	default:
+		return Vec2(tileX, tileY);
+	}
+}
+
+//=============================================================================
+
+Rect TmxMapRenderer::getTileTexCoords(Tileset& tileset, short id)
+{
+	int columns = tileset.columns - tileset.margin * 2 + tileset.spacing;
+
+	int srcX = (id % columns) * tileset.tileWidth;
+	int srcY = (id / columns) * tileset.tileHeight;
+
+	return SpriteBatch::getTexCoords(tileset.sprite.getTexture(),
+		Rect((float)srcX, (float)srcY,
+			(float)tileset.tileWidth, (float)tileset.tileHeight));
+}
+
+//=============================================================================
+
+void TmxMapRenderer::buildChunk(Layer& layer, int chunkX, int chunkY, const Color& color)
+{
+	Chunk& chunk = layer.chunks[chunkX + chunkY * _chunksX];
+
+	chunk.vertices.clear();
+	chunk.runs.clear();
+	chunk.animatedTiles.clear();
+
+	Vec4 vertexColor = color.toVector();
+
+	int startU = chunkX * CHUNK_SIZE;
+	int startV = chunkY * CHUNK_SIZE;
+
+	for (int v = startV; v < startV + CHUNK_SIZE; ++v)
+	{
+		for (int u = startU; u < startU + CHUNK_SIZE; ++u)
+		{
+			int x, y;
+
+			if (!fromChunkSpace(u, v, x, y))
+			{
+				continue;
+			}
+
+			const Tile& tile = layer.tiles[x + y * _mapWidth];
+
+			if (tile.id < 0 || tile.tilesetIndex < 0 ||
+				tile.tilesetIndex >= (int)_tilesets.size())
+			{
+				continue;
+			}
+
+			Tileset& tileset = *_tilesets[tile.tilesetIndex];
+
+			Uint32 quad = Uint32(chunk.vertices.size() / SpriteBatch::VERTICES_PER_QUAD);
+
+			if (chunk.runs.empty() || chunk.runs.back().tilesetIndex != tile.tilesetIndex)
+			{
+				chunk.runs.push_back({ quad, 0, tile.tilesetIndex });
+			}
+
+			chunk.runs.back().quads++;
+
+			if (tileset.animations.find(tile.id) != tileset.animations.end())
+			{
+				chunk.animatedTiles.push_back({ quad, tile.id, tile.tilesetIndex });
+			}
+
+			// Orthogonal tiles hang from the top left corner of the cell,
+			// the other orientations stand on the bottom of the cell
+			Vec2 position = getTilePosition(x, y);
+
+			if (_type != TmxMap::Orientation::Orthogonal)
+			{
+				position.y += _tileHeight - tileset.tileHeight;
+			}
+
+			float right = position.x + tileset.tileWidth;
+			float bottom = position.y + tileset.tileHeight;
+
+			chunk.vertices.resize(chunk.vertices.size() + SpriteBatch::VERTICES_PER_QUAD);
+
+			SpriteBatch::setQuad(&chunk.vertices[quad * SpriteBatch::VERTICES_PER_QUAD],
+				position, Vec2(right, position.y),
+				Vec2(position.x, bottom), Vec2(right, bottom),
+				getTileTexCoords(tileset, getTileAnimId(tile)),
+				vertexColor);
+		}
+	}
+
+	chunk.color = color;
+	chunk.animationStamp = _animationStamp;
+	chunk.dirty = false;
+}
+
+//=============================================================================
+
+void TmxMapRenderer::drawChunk(Chunk& chunk, const Affine2D& modelview)
+{
+	SpriteBatch* batch = _device->getSpriteBatch();
+
+	for (auto& run : chunk.runs)
+	{
+		batch->drawQuads(_tilesets[run.tilesetIndex]->sprite.getTexture(),
+			&chunk.vertices[run.firstQuad * SpriteBatch::VERTICES_PER_QUAD],
+			run.quads, modelview);
+	}
+}
+
+//=============================================================================
+
+void TmxMapRenderer::updateChunkColor(Chunk& chunk, const Color& color)
+{
+	Vec4 vertexColor = color.toVector();
+
+	for (auto& vertex : chunk.vertices)
+	{
+		vertex.color = vertexColor;
+	}
+
+	chunk.color = color;
+}
+
+//=============================================================================
+
+void TmxMapRenderer::updateChunkAnimations(Chunk& chunk)
+{
+	for (auto& animatedTile : chunk.animatedTiles)
+	{
+		Tile tile = { animatedTile.id, animatedTile.tilesetIndex };
+
+		SpriteBatch::setQuadTexCoords(
+			&chunk.vertices[animatedTile.quad * SpriteBatch::VERTICES_PER_QUAD],
+			getTileTexCoords(*_tilesets[tile.tilesetIndex], getTileAnimId(tile)));
+	}
+
+	chunk.animationStamp = _animationStamp;
+}
+
+//=============================================================================
+
 bool TmxMapRenderer::setMap(const TmxMap& map, Texture::Location location)
 {
 	_loaded = false;
@@ -243,8 +637,13 @@ bool TmxMapRenderer::setMap(const TmxMap& map, Texture::Location location)
 	_mapHeight = 0;
 	_tileWidth = 0;
 	_tileHeight = 0;
+	_chunksX = 0;
+	_chunksY = 0;
+	_tilesOverhangX = 0;
+	_tilesOverhangY = 0;
 	_layers.clear();
 	_tilesets.clear();
+	_chunksBounds.clear();
 
 	if (map.getWidth() == 0 || map.getHeight() == 0 ||
 		map.getTileWidth() == 0 || map.getTileHeight() == 0 ||
@@ -257,6 +656,9 @@ bool TmxMapRenderer::setMap(const TmxMap& map, Texture::Location location)
 	_mapHeight = map.getHeight();
 	_tileWidth = map.getTileWidth();
 	_tileHeight = map.getTileHeight();
+	_type = map.getOrientation();
+	_staggerAxis = map.getStaggerAxis();
+	_staggerIndex = map.getStaggerIndex();
 
 	// Loading tilesets
 	_tilesets.resize(map.getTilesets().size());
@@ -285,12 +687,23 @@ bool TmxMapRenderer::setMap(const TmxMap& map, Texture::Location location)
 			return false;
 		}
 
+		if (_streaming)
+		{
+			TextureResidency::getInstance()->manage(_tilesets[t]->sprite.getTexture());
+		}
+
 		_tilesets[t]->tileWidth = tileset->getTileWidth();
 		_tilesets[t]->tileHeight = tileset->getTileHeight();
 		_tilesets[t]->margin = tileset->getMargin();
 		_tilesets[t]->spacing = tileset->getSpacing();
 		_tilesets[t]->columns = _tilesets[t]->sprite.getTextureWidth() / _tilesets[t]->tileWidth;
 
+		if (_tilesets[t]->tileWidth > _tileWidth)
+			_tilesOverhangX = std::max<Uint16>(_tilesOverhangX, _tilesets[t]->tileWidth - _tileWidth);
+
+		if (_tilesets[t]->tileHeight > _tileHeight)
+			_tilesOverhangY = std::max<Uint16>(_tilesOverhangY, _tilesets[t]->tileHeight - _tileHeight);
+
 		for (auto& tile : tileset->getTiles())
 		{
 			if (tile.getAnimation().getFrames().size() > 0)
@@ -316,7 +729,65 @@ bool TmxMapRenderer::setMap(const TmxMap& map, Texture::Location location)
 		}
 	}
 
-	// Loading layers
+	// Chunk space extents and the bounds of every chunk in map space
+	int maxU = 0;
+	int maxV = 0;
+
+	for (int y = 0; y < _mapHeight; ++y)
+	{
+		for (int x = 0; x < _mapWidth; ++x)
+		{
+			int u, v;
+			toChunkSpace(x, y, u, v);
+
+			maxU = std::max(maxU, u);
+			maxV = std::max(maxV, v);
+		}
+	}
+
+	_chunksX = maxU / CHUNK_SIZE + 1;
+	_chunksY = maxV / CHUNK_SIZE + 1;
+	_chunksBounds.assign(_chunksX * _chunksY, Rect(0.0f, 0.0f, 0.0f, 0.0f));
+
+	for (int y = 0; y < _mapHeight; ++y)
+	{
+		for (int x = 0; x < _mapWidth; ++x)
+		{
+			int u, v;
+			toChunkSpace(x, y, u, v);
+
+			Rect& bounds = _chunksBounds[(u / CHUNK_SIZE) + (v / CHUNK_SIZE) * _chunksX];
+
+			Rect cell(getTilePosition(x, y), Vec2(
+				float(_tileWidth + _tilesOverhangX),
+				float(_tileHeight + _tilesOverhangY)));
+
+			if (_type != TmxMap::Orientation::Orthogonal)
+			{
+				cell.y -= _tilesOverhangY;
+			}
+
+			if (bounds.width <= 0.0f)
+			{
+				bounds = cell;
+			}
+			else
+			{
+				float left = std::min(bounds.getLeft(), cell.getLeft());
+				float top = std::min(bounds.getTop(), cell.getTop());
+				float right = std::max(bounds.getRight(), cell.getRight());
+				float bottom = std::max(bounds.getBottom(), cell.getBottom());
+
+				bounds.set(left, top, right - left, bottom - top);
+			}
+		}
+	}
+
+	// Loading layers, the chunks are built when they are drawn
+	Chunk chunk;
+	chunk.animationStamp = 0;
+	chunk.dirty = true;
+
 	_layers.resize(map.getLayers().size());
 
 	for (Uint32 l = 0; l < _layers.size(); ++l)
@@ -324,6 +795,7 @@ bool TmxMapRenderer::setMap(const TmxMap& map, Texture::Location location)
 		auto layer = map.getLayer(l);
 		_layers[l].opacity = byte(layer->getOpacity() * (float)Color::OPAQUE);
 		_layers[l].tiles.resize(layer->getTiles().size());
+		_layers[l].chunks.assign(_chunksX * _chunksY, chunk);
 
 		for (Uint32 t = 0; t < _layers[l].tiles.size(); ++t)
 		{
@@ -336,7 +808,6 @@ bool TmxMapRenderer::setMap(const TmxMap& map, Texture::Location location)
 		(float)getMapWidthInPixels(),
 		(float)getMapHeightInPixels()));
 
-	_type = map.getOrientation();
 	_loaded = true;
 
 	return true;
@@ -344,4 +815,42 @@ bool TmxMapRenderer::setMap(const TmxMap& map, Texture::Location location)
 
 //=============================================================================
 
+void TmxMapRenderer::prefetchChunks(Layer& layer, int startX, int startY,
+	int endX, int endY, const Color& color)
+{
+	auto residency = TextureResidency::getInstance();
+
+	int ringStartX = std::max(0, startX - 1);
+	int ringStartY = std::max(0, startY - 1);
+	int ringEndX = std::min(_chunksX - 1, endX + 1);
+	int ringEndY = std::min(_chunksY - 1, endY + 1);
+
+	for (int chunkY = ringStartY; chunkY <= ringEndY; ++chunkY)
+	{
+		for (int chunkX = ringStartX; chunkX <= ringEndX; ++chunkX)
+		{
+			if (chunkX >= startX && chunkX <= endX &&
+				chunkY >= startY && chunkY <= endY)
+			{
+				continue;
+			}
+
+			// Building the chunk ahead of the camera tells its tilesets
+			Chunk& chunk = layer.chunks[chunkX + chunkY * _chunksX];
+
+			if (chunk.dirty)
+			{
+				buildChunk(layer, chunkX, chunkY, color);
+			}
+
+			for (auto& run : chunk.runs)
+			{
+				residency->prefetch(_tilesets[run.tilesetIndex]->sprite.getTexture());
+			}
+		}
+	}
+}
+
+//=============================================================================
+
 NS_KAIRY_END